@@ -0,0 +1,196 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <sstream>
+#include <fstream>
+
+#include "../src/scanner/ModularScanner.h"
+#include "../src/scanner/TokenBufferScanner.h"
+#include "../src/scanner/input_stream/PreprocessedFileInputStream.h"
+#include "../src/parser/Parser.h"
+#include "../src/parser/IncrementalParser.h"
+#include "../src/parser/ParallelParser.h"
+#include "../src/parser/TableDrivenParser.h"
+#include "../src/intermediate_representation/AstArena.h"
+
+using namespace std;
+using namespace aux::scanner;
+using namespace aux::scanner::input_stream;
+using namespace aux::parser;
+using namespace aux::ir::ast;
+
+string readFile(const string &path) {
+    ifstream file{path};
+    stringstream result;
+    result << file.rdbuf();
+    return result.str();
+}
+
+string bigLuaProgram() {
+    return readFile("../test/resources/test_cases/BigLuaProgram.lua");
+}
+
+/**
+ * Module of many independent functions, similar in shape to large generated Lua modules
+ */
+string syntheticCorpus(size_t functions = 2000) {
+    string result;
+    for (size_t i = 0; i < functions; ++i) {
+        auto id = to_string(i);
+        result += "local function f" + id + "(a, b)\n"
+                  "    local t = {x = a, y = b, [" + id + "] = 's' .. " + id + ", {1, 2, 3}}\n"
+                  "    for k = 1, #t do\n"
+                  "        if t[k] and a > b then\n"
+                  "            t.x = t.x + k * 2 ^ 3 // 4\n"
+                  "        elseif not b then\n"
+                  "            print(string.format('%d', k), b)\n"
+                  "        else\n"
+                  "            t[k] = function(x) return x % 2 == 0 end\n"
+                  "        end\n"
+                  "    end\n"
+                  "    while a < b do a = a + 1 end\n"
+                  "    return t, a\n"
+                  "end\n\n";
+    }
+    return result;
+}
+
+shared_ptr<const TokenBuffer> scan(const string &source) {
+    PreprocessedFileInputStream stream{make_unique<istringstream>(source)};
+    ModularScanner scanner{stream};
+    return TokenBufferScanner::scanAll(scanner);
+}
+
+void BM_Scan(benchmark::State &state, const string &source) {
+    for (auto _: state) {
+        benchmark::DoNotOptimize(scan(source));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * source.size()));
+}
+
+void BM_Parse(benchmark::State &state, const string &source) {
+    auto tokens = scan(source);
+    size_t errors = 0;
+    for (auto _: state) {
+        Parser parser{make_shared<TokenBufferScanner>(tokens)};
+        benchmark::DoNotOptimize(parser.parse());
+        errors = parser.getErrors().size();
+    }
+    state.counters["errors"] = static_cast<double>(errors);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tokens->size()));
+}
+
+void BM_Validate(benchmark::State &state, const string &source) {
+    auto tokens = scan(source);
+    size_t errors = 0;
+    for (auto _: state) {
+        Parser parser{make_shared<TokenBufferScanner>(tokens)};
+        errors = parser.validate().size();
+        benchmark::DoNotOptimize(errors);
+    }
+    state.counters["errors"] = static_cast<double>(errors);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tokens->size()));
+}
+
+void BM_TableDrivenValidate(benchmark::State &state, const string &source) {
+    auto tokens = scan(source);
+    size_t errors = 0;
+    for (auto _: state) {
+        TableDrivenParser parser{make_shared<TokenBufferScanner>(tokens)};
+        errors = parser.validate().size();
+        benchmark::DoNotOptimize(errors);
+    }
+    state.counters["errors"] = static_cast<double>(errors);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tokens->size()));
+}
+
+void BM_ParallelParse(benchmark::State &state, const string &source) {
+    auto tokens = scan(source);
+    size_t errors = 0;
+    for (auto _: state) {
+        ParallelParser parser{tokens, static_cast<size_t>(state.range(0))};
+        benchmark::DoNotOptimize(parser.parse());
+        errors = parser.getErrors().size();
+    }
+    state.counters["errors"] = static_cast<double>(errors);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tokens->size()));
+}
+
+size_t countNodesLeftRight(const shared_ptr<BaseTree> &tree) {
+    return tree ? 1 + countNodesLeftRight(tree->getLeft()) + countNodesLeftRight(tree->getRight()) : 0;
+}
+
+size_t countNodesChildren(const BaseTree &tree) {
+    size_t result = 1;
+    tree.forEachChild([&](const TreeChild &child) {
+        result += child.tree ? countNodesChildren(*child.tree) : static_cast<bool>(child.token);
+    });
+    return result;
+}
+
+void BM_WalkLeftRight(benchmark::State &state, const string &source) {
+    Parser parser{make_shared<TokenBufferScanner>(scan(source))};
+    auto tree = parser.parse();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(countNodesLeftRight(tree));
+    }
+}
+
+void BM_WalkChildren(benchmark::State &state, const string &source) {
+    Parser parser{make_shared<TokenBufferScanner>(scan(source))};
+    auto tree = parser.parse();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(countNodesChildren(*tree));
+    }
+}
+
+void BM_ArenaAdd(benchmark::State &state, const string &source) {
+    Parser parser{make_shared<TokenBufferScanner>(scan(source))};
+    auto tree = parser.parse();
+    size_t nodes = 0, bytes = 0;
+    for (auto _: state) {
+        AstArena arena;
+        benchmark::DoNotOptimize(arena.add(tree));
+        nodes = arena.getNodesCount();
+        bytes = arena.getMemoryUsage();
+    }
+    state.counters["nodes"] = static_cast<double>(nodes);
+    state.counters["bytes_per_node"] = static_cast<double>(bytes) / static_cast<double>(nodes);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * nodes));
+}
+
+/**
+ * Typing inside one function in the middle of the source, each iteration inserts a statement and removes it back
+ */
+void BM_IncrementalEdit(benchmark::State &state, const string &source) {
+    IncrementalParser parser{source};
+    const string statement = "a = a + 1 ";
+    auto offset = parser.getSource().find("return t, a", source.size() / 2);
+
+    size_t incremental = 0, edits = 0;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(parser.edit(offset, 0, statement));
+        incremental += parser.isLastEditIncremental();
+        benchmark::DoNotOptimize(parser.edit(offset, statement.size(), ""));
+        incremental += parser.isLastEditIncremental();
+        edits += 2;
+    }
+    state.counters["incremental"] = static_cast<double>(incremental) / static_cast<double>(edits);
+    state.SetItemsProcessed(static_cast<int64_t>(edits));
+}
+
+BENCHMARK_CAPTURE(BM_Scan, big_lua_program, bigLuaProgram())->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Parse, big_lua_program, bigLuaProgram())->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Validate, big_lua_program, bigLuaProgram())->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_TableDrivenValidate, big_lua_program, bigLuaProgram())->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_CAPTURE(BM_Scan, synthetic_corpus, syntheticCorpus())->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Parse, synthetic_corpus, syntheticCorpus())->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Validate, synthetic_corpus, syntheticCorpus())->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_TableDrivenValidate, synthetic_corpus, syntheticCorpus())->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ParallelParse, synthetic_corpus, syntheticCorpus())
+        ->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_IncrementalEdit, synthetic_corpus, syntheticCorpus())->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_WalkLeftRight, synthetic_corpus, syntheticCorpus())->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_WalkChildren, synthetic_corpus, syntheticCorpus())->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ArenaAdd, synthetic_corpus, syntheticCorpus())->Unit(benchmark::kMillisecond);
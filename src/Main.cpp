@@ -1,10 +1,85 @@
+#include <iostream>
+
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "scanner/ModularScanner.h"
 #include "scanner/input_stream/PreprocessedFileInputStream.h"
+#include "parser/Parser.h"
+#include "parser/ParallelParser.h"
+#include "intermediate_representation/AstStatistics.h"
+#include "intermediate_representation/AstExporter.h"
+#include "intermediate_representation/StructuralHashing.h"
+#include "intermediate_representation/HirLowering.h"
+#include "semantic/ScopeResolver.h"
+#include "optimizer/ConstantFolder.h"
+#include "optimizer/DeadCodeEliminator.h"
 
 DEFINE_string(src, "", "Source file to be compiled");
+DEFINE_bool(dump_tokens, false, "Log scanned tokens instead of parsing the source file");
+DEFINE_bool(syntax_only, false, "Only check syntax of the source file without building a parse tree");
+DEFINE_uint32(max_nesting_depth, 0, "Parse with explicit stack allowing the given nesting depth, "
+                                    "for deeply nested generated sources. Recursive descent is used if 0");
+DEFINE_uint32(parse_threads, 1, "Number of threads parsing top-level function definitions, all cores are used if 0");
+DEFINE_bool(ast_stats, false, "Print node counts, memory footprint and shape of the parse tree");
+DEFINE_string(ast_stats_format, "text", "Format of --ast_stats output: text or json");
+DEFINE_bool(hash_consing, false, "Share structurally equal literals, pure expressions and constant table constructors "
+                                 "of the parse tree, only those at the same source range with --emit");
+DEFINE_string(emit, "", "Write the parse tree to the standard output: ast-dot for Graphviz or ast-json, "
+                        "or its high-level IR as S-expressions: hir");
+DEFINE_bool(optimize, false, "Fold constants and eliminate dead code of the high-level IR before --emit=hir");
+
+void printAstStatistics(const aux::ir::ast::BaseTree &tree) {
+    auto statistics = aux::ir::ast::AstStatistics::collect(tree);
+    if (FLAGS_ast_stats_format == "json") {
+        statistics.writeJson(std::cout);
+    } else if (FLAGS_ast_stats_format == "text") {
+        statistics.writeText(std::cout);
+    } else {
+        LOG(FATAL) << "Unknown AST statistics format " << FLAGS_ast_stats_format;
+    }
+}
+
+void reportTree(std::shared_ptr<aux::ir::ast::BaseTree> tree) {
+    if (FLAGS_hash_consing) {
+        // Emitted trees and IR keep source ranges, which are exact only if equal subtrees at other places are not shared
+        aux::ir::ast::HashConser conser{FLAGS_emit.empty()};
+        tree = conser.share(tree);
+        LOG(INFO) << "Hash-consing shared " << conser.getSharedCount() << " subtrees";
+    }
+    if (FLAGS_ast_stats) {
+        printAstStatistics(*tree);
+    }
+    if (FLAGS_emit == "hir") {
+        aux::ir::hir::HirLowering lowering;
+        auto module = lowering.lower(*tree);
+        for (const auto &error: lowering.getErrors()) {
+            LOG(ERROR) << error.what();
+        }
+        if (FLAGS_optimize) {
+            aux::semantic::ScopeResolver resolver;
+            auto resolution = resolver.resolve(module);
+            for (const auto &error: resolver.getErrors()) {
+                LOG(ERROR) << error.what();
+            }
+            aux::optimizer::ConstantFolder folder;
+            module = folder.fold(module, &resolution);
+            aux::optimizer::DeadCodeEliminator eliminator;
+            module = eliminator.eliminate(module);
+            LOG(INFO) << "Folded " << folder.getFoldedCount() << " expressions, propagated "
+                      << folder.getPropagatedCount() << " locals, removed " << eliminator.getRemovedNodesCount()
+                      << " dead nodes (" << eliminator.getRemovedBytes() << " bytes)";
+        }
+        module.write(std::cout);
+        std::cout << "\n";
+    } else if (!FLAGS_emit.empty()) {
+        auto format = aux::ir::ast::AstExporter::parseFormat(FLAGS_emit);
+        if (!format) {
+            LOG(FATAL) << "Unknown emit format " << FLAGS_emit;
+        }
+        aux::ir::ast::AstExporter::write(std::cout, *tree, *format);
+    }
+}
 
 int main(int argc, char** argv) {
     std::string usage = "This is aux lua compiler. Sample usage:\n";
@@ -12,6 +87,8 @@ int main(int argc, char** argv) {
     gflags::SetUsageMessage(usage);
 
     gflags::ParseCommandLineFlags(&argc, &argv, true);
+    // Trees are written to std::cout, which is buffered only when not synchronized with stdio
+    std::ios::sync_with_stdio(false);
     google::InitGoogleLogging(argv[0]);
 
     if (FLAGS_src.empty()) {
@@ -19,17 +96,47 @@ int main(int argc, char** argv) {
     }
 
     aux::scanner::input_stream::PreprocessedFileInputStream fis(FLAGS_src);
-    aux::scanner::ModularScanner scanner(fis);
+    auto scanner = std::make_shared<aux::scanner::ModularScanner>(fis);
 
-    while (true) {
-        auto currToken = scanner.next();
-        if (currToken) {
+    if (FLAGS_dump_tokens) {
+        while (true) {
+            auto currToken = scanner->next();
+            if (currToken->getType() == aux::ir::tokens::TokenType::EOF_OR_UNDEFINED) {
+                break;
+            }
             LOG(INFO) << "Token of type " << *currToken->getType()
                       << " at (" << currToken->getSpan().row << " : " << currToken->getSpan().column << ")";
-        } else {
-            break;
         }
+        return 0;
+    }
+
+    if (FLAGS_parse_threads != 1 && !FLAGS_syntax_only && FLAGS_max_nesting_depth == 0) {
+        aux::parser::ParallelParser parser{aux::scanner::TokenBufferScanner::scanAll(*scanner), FLAGS_parse_threads};
+        auto tree = parser.parse();
+        for (const auto &error: parser.getErrors()) {
+            LOG(ERROR) << error.what();
+        }
+        reportTree(tree);
+        return parser.getErrors().empty() ? 0 : 1;
+    }
+
+    aux::parser::Parser parser{scanner};
+    if (FLAGS_max_nesting_depth > 0) {
+        parser.useExplicitStack(FLAGS_max_nesting_depth);
+    }
+    std::shared_ptr<aux::ir::ast::BaseTree> tree;
+    if (FLAGS_syntax_only) {
+        parser.validate();
+    } else {
+        tree = parser.parse();
+    }
+
+    for (const auto &error: parser.getErrors()) {
+        LOG(ERROR) << error.what();
+    }
+    if (tree) {
+        reportTree(tree);
     }
 
-    return 0;
+    return parser.getErrors().empty() ? 0 : 1;
 }
@@ -69,6 +69,16 @@ namespace aux::exception {
             return exceptionMessage.c_str();
         }
 
+        [[nodiscard]]
+        inline uint32_t getRow() const {
+            return row;
+        }
+
+        [[nodiscard]]
+        inline uint32_t getColumn() const {
+            return column;
+        }
+
         inline static ParsingExceptionBuilder builder();
         inline static ParsingExceptionBuilder expressionErrorBuilder();
         inline static ParsingExceptionBuilder statementErrorBuilder();
@@ -130,6 +140,26 @@ namespace aux::exception {
 
     };
 
+    /**
+     * Error in a syntactically valid program found by lowering or analysis passes, e.g. an unknown attribute
+     * or a goto to an invisible label. Passes report them and go on, same as the parser does
+     */
+    struct SemanticException : std::logic_error {
+
+        inline SemanticException(const ir::tokens::Span &span, const std::string &message)
+                : logic_error(
+                "Semantic error at (" + std::to_string(span.row) + ":" + std::to_string(span.column) + ") " + message
+        ), row(span.row), column(span.column) {}
+
+        [[nodiscard]]
+        inline ir::tokens::Span getSpan() const {
+            return {static_cast<uint16_t>(row), static_cast<uint16_t>(column)};
+        }
+
+    private:
+        uint32_t row, column;
+    };
+
     ParsingExceptionBuilder ParsingException::builder() {
         return {};
     }
@@ -0,0 +1,46 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "../parser/grammar/GrammarCompiler.h"
+
+/**
+ * Regenerates parse tables of @class aux::parser::TableDrivenParser, invoked by the build:
+ * aux_parse_tables_generator resources/syntax.ebnf <build>/src/parser/generated/LuaParseTables.h
+ */
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <grammar.ebnf> <output.h>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream grammar{argv[1]};
+    if (!grammar) {
+        std::cerr << "Can not open grammar " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::stringstream header;
+    try {
+        aux::parser::grammar::GrammarCompiler compiler{grammar};
+        auto tables = compiler.compile();
+        for (const auto &conflict: compiler.getConflicts()) {
+            std::cerr << "LL(1) conflict resolved in favour of the first alternative: " << conflict << std::endl;
+        }
+        aux::parser::grammar::GrammarCompiler::writeHeader(header, tables);
+    } catch (const std::invalid_argument &error) {
+        std::cerr << argv[1] << ": " << error.what() << std::endl;
+        return 1;
+    }
+
+    // Keep the file untouched if tables did not change, so that dependent sources are not rebuilt
+    std::ifstream previous{argv[2]};
+    std::stringstream previousContent;
+    previousContent << previous.rdbuf();
+    if (previousContent.str() != header.str()) {
+        std::filesystem::create_directories(std::filesystem::path{argv[2]}.parent_path());
+        std::ofstream{argv[2]} << header.str();
+    }
+    return 0;
+}
@@ -0,0 +1,258 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "AstArena.h"
+
+#include <stdexcept>
+
+using namespace aux::ir::ast;
+using namespace aux::ir::tokens;
+using namespace std;
+
+template<typename Node>
+NodeRef AstArena::push(vector<Node> &pool, NodeRef::Pool type, Node node) {
+    if (pool.size() > NodeRef::MAX_INDEX) {
+        throw length_error("AST arena pool overflow");
+    }
+    pool.push_back(node);
+    return {type, static_cast<uint32_t>(pool.size() - 1)};
+}
+
+NodeRef AstArena::add(const shared_ptr<BaseTree> &tree) {
+    auto result = copy(tree);
+    // Addresses of tokens are only unique while the tree is alive
+    _addedTokens.clear();
+    return result;
+}
+
+/**
+ * Children are added before their parent, so every pool ends up in post-order
+ */
+NodeRef AstArena::copy(const shared_ptr<BaseTree> &tree) {
+    using Pool = NodeRef::Pool;
+
+    if (!tree) {
+        return {};
+    }
+
+    if (auto bin = tree->as<BinTree>()) {
+        auto left = copy(bin->left);
+        auto right = copy(bin->right);
+        return push(binNodes, Pool::BIN, BinNode{bin->type, addToken(bin->op), left, right});
+    } else if (auto list = tree->as<ListTree>()) {
+        vector<NodeRef> children;
+        children.reserve(list->trees.size());
+        for (const auto &child: list->trees) {
+            children.push_back(copy(child));
+        }
+        // Children of a list are contiguous, so they are appended only after the nested lists are
+        auto firstChild = static_cast<uint32_t>(listChildren.size());
+        listChildren.insert(listChildren.end(), children.begin(), children.end());
+        return push(listNodes, Pool::LIST, ListNode{list->type, firstChild, static_cast<uint32_t>(children.size())});
+    } else if (auto token = tree->as<TokenTree>()) {
+        return push(tokenNodes, Pool::TOKEN, TokenNode{token->type, addToken(token->token)});
+    } else if (auto args = tree->as<ArgsTree>()) {
+        auto listTree = copy(args->listTree);
+        return push(argsNodes, Pool::ARGS, ArgsNode{addToken(args->stringLiteral), listTree});
+    } else if (auto call = tree->as<FunctionCallSuffixTree>()) {
+        auto argsTree = copy(call->argsTree);
+        return push(functionCallSuffixNodes, Pool::FUNCTION_CALL_SUFFIX, FunctionCallSuffixNode{
+                addToken(call->identifier), argsTree
+        });
+    } else if (auto suffix = tree->as<ExprSuffixTree>()) {
+        auto expression = copy(suffix->expression);
+        return push(exprSuffixNodes, Pool::EXPR_SUFFIX, ExprSuffixNode{expression, addToken(suffix->identifier)});
+    } else if (auto variable = tree->as<VariableTree>()) {
+        auto expression = copy(variable->expression);
+        auto suffixes = copy(variable->exprSuffixes);
+        return push(variableNodes, Pool::VARIABLE, VariableNode{addToken(variable->identifier), expression, suffixes});
+    } else if (auto prefixExpr = tree->as<PrefixExprTree>()) {
+        auto expression = copy(prefixExpr->expression);
+        auto suffixes = copy(prefixExpr->suffixes);
+        return push(prefixExprNodes, Pool::PREFIX_EXPR, PrefixExprNode{
+                addToken(prefixExpr->identifier), expression, suffixes
+        });
+    } else if (auto term = tree->as<TermTree>()) {
+        auto prefix = copy(term->prefixExpr);
+        return push(termNodes, Pool::TERM, TermNode{prefix, addToken(term->token)});
+    } else if (auto forLoop = tree->as<ForLoopTree>()) {
+        auto identifiers = copy(forLoop->identifierList);
+        auto expressions = copy(forLoop->expList);
+        auto block = copy(forLoop->block);
+        return push(forLoopNodes, Pool::FOR_LOOP, ForLoopNode{identifiers, expressions, block, addToken(forLoop->op)});
+    } else if (auto error = tree->as<ErrorTree>()) {
+        return push(errorNodes, Pool::ERROR, ErrorNode{addToken(error->token)});
+    }
+
+    throw invalid_argument("Unexpected tree " + tree->getPrintValue());
+}
+
+shared_ptr<BaseTree> AstArena::toTree(NodeRef node) const {
+    using Pool = NodeRef::Pool;
+
+    if (!node) {
+        return nullptr;
+    }
+
+    auto index = node.getIndex();
+    switch (node.getPool()) {
+        case Pool::BIN: {
+            const auto &bin = binNodes[index];
+            return make_shared<BinTree>(bin.type, toTree(bin.left), toTree(bin.right), toToken(bin.op));
+        }
+        case Pool::LIST: {
+            auto result = make_shared<ListTree>(listNodes[index].type);
+            for (auto child: getChildren(listNodes[index])) {
+                result->pushBack(toTree(child));
+            }
+            return result;
+        }
+        case Pool::TOKEN:
+            return make_shared<TokenTree>(tokenNodes[index].type, toToken(tokenNodes[index].token));
+        case Pool::ARGS: {
+            const auto &args = argsNodes[index];
+            if (args.stringLiteral != NO_TOKEN) {
+                return make_shared<ArgsTree>(static_pointer_cast<TokenStringLiteral>(toToken(args.stringLiteral)));
+            }
+            return make_shared<ArgsTree>(static_pointer_cast<ListTree>(toTree(args.list)));
+        }
+        case Pool::FUNCTION_CALL_SUFFIX: {
+            const auto &call = functionCallSuffixNodes[index];
+            return make_shared<FunctionCallSuffixTree>(
+                    static_pointer_cast<ArgsTree>(toTree(call.args)),
+                    static_pointer_cast<TokenIdentifier>(toToken(call.identifier))
+            );
+        }
+        case Pool::EXPR_SUFFIX: {
+            const auto &suffix = exprSuffixNodes[index];
+            if (suffix.identifier != NO_TOKEN) {
+                return make_shared<ExprSuffixTree>(static_pointer_cast<TokenIdentifier>(toToken(suffix.identifier)));
+            }
+            return make_shared<ExprSuffixTree>(toTree(suffix.expression));
+        }
+        case Pool::VARIABLE: {
+            const auto &variable = variableNodes[index];
+            auto suffixes = static_pointer_cast<ListTree>(toTree(variable.suffixes));
+            if (variable.identifier != NO_TOKEN) {
+                return make_shared<VariableTree>(
+                        static_pointer_cast<TokenIdentifier>(toToken(variable.identifier)), suffixes
+                );
+            }
+            return make_shared<VariableTree>(toTree(variable.expression), suffixes);
+        }
+        case Pool::PREFIX_EXPR: {
+            const auto &prefixExpr = prefixExprNodes[index];
+            auto suffixes = static_pointer_cast<ListTree>(toTree(prefixExpr.suffixes));
+            if (prefixExpr.identifier != NO_TOKEN) {
+                return make_shared<PrefixExprTree>(
+                        static_pointer_cast<TokenIdentifier>(toToken(prefixExpr.identifier)), suffixes
+                );
+            }
+            return make_shared<PrefixExprTree>(toTree(prefixExpr.expression), suffixes);
+        }
+        case Pool::TERM: {
+            const auto &term = termNodes[index];
+            if (term.token != NO_TOKEN) {
+                return make_shared<TermTree>(toToken(term.token));
+            }
+            return make_shared<TermTree>(static_pointer_cast<PrefixExprTree>(toTree(term.prefixExpr)));
+        }
+        case Pool::FOR_LOOP: {
+            const auto &forLoop = forLoopNodes[index];
+            return make_shared<ForLoopTree>(
+                    static_pointer_cast<ListTree>(toTree(forLoop.identifiers)), toToken(forLoop.op),
+                    static_pointer_cast<ListTree>(toTree(forLoop.expressions)),
+                    static_pointer_cast<ListTree>(toTree(forLoop.block))
+            );
+        }
+        case Pool::ERROR:
+            return make_shared<ErrorTree>(toToken(errorNodes[index].token));
+    }
+
+    throw invalid_argument("Unexpected node reference " + to_string(node.value));
+}
+
+string_view AstArena::getString(uint32_t index) const {
+    return {characters.data() + stringOffsets[index], stringOffsets[index + 1] - stringOffsets[index]};
+}
+
+string_view AstArena::getRawValue(TokenRef token) const {
+    return getString(tokens[token].value);
+}
+
+span<const NodeRef> AstArena::getChildren(const ListNode &list) const {
+    return {listChildren.data() + list.firstChild, list.childrenCount};
+}
+
+size_t AstArena::getNodesCount() const {
+    return binNodes.size() + listNodes.size() + tokenNodes.size() + argsNodes.size()
+           + functionCallSuffixNodes.size() + exprSuffixNodes.size() + variableNodes.size()
+           + prefixExprNodes.size() + termNodes.size() + forLoopNodes.size() + errorNodes.size();
+}
+
+size_t AstArena::getMemoryUsage() const {
+    auto bytes = [](const auto &pool) {
+        return pool.capacity() * sizeof(typename decay_t<decltype(pool)>::value_type);
+    };
+    return bytes(binNodes) + bytes(listNodes) + bytes(listChildren) + bytes(tokenNodes) + bytes(argsNodes)
+           + bytes(functionCallSuffixNodes) + bytes(exprSuffixNodes) + bytes(variableNodes)
+           + bytes(prefixExprNodes) + bytes(termNodes) + bytes(forLoopNodes) + bytes(errorNodes)
+           + bytes(tokens) + bytes(characters) + bytes(stringOffsets);
+}
+
+void AstArena::clear() {
+    *this = AstArena{};
+}
+
+TokenRef AstArena::addToken(const shared_ptr<Token> &token) {
+    if (!token) {
+        return NO_TOKEN;
+    }
+
+    auto [added, inserted] = _addedTokens.emplace(token.get(), static_cast<TokenRef>(tokens.size()));
+    if (inserted) {
+        auto span = token->getSpan();
+        tokens.push_back(TokenRecord{intern(token->getRawValue()), span.row, span.column, token->getType()});
+    }
+    return added->second;
+}
+
+uint32_t AstArena::intern(const string &value) {
+    auto [interned, inserted] = _internedStrings.emplace(value, static_cast<uint32_t>(stringOffsets.size() - 1));
+    if (inserted) {
+        characters.insert(characters.end(), value.begin(), value.end());
+        stringOffsets.push_back(static_cast<uint32_t>(characters.size()));
+    }
+    return interned->second;
+}
+
+shared_ptr<Token> AstArena::toToken(TokenRef token) const {
+    if (token == NO_TOKEN) {
+        return nullptr;
+    }
+
+    const auto &record = tokens[token];
+    string value{getString(record.value)};
+    Span span{record.row, record.column};
+    switch (record.type) {
+        case TokenType::IDENTIFIER:
+            return make_shared<TokenIdentifier>(value, span);
+        case TokenType::KEYWORD:
+            return make_shared<TokenKeyword>(value, span);
+        case TokenType::NUMERIC_DECIMAL:
+            return make_shared<TokenDecimal>(value, span);
+        case TokenType::NUMERIC_HEX:
+            return make_shared<TokenHex>(value, span);
+        case TokenType::NUMERIC_DOUBLE:
+            return make_shared<TokenDouble>(value, span);
+        case TokenType::STRING_LITERAL:
+            return make_shared<TokenStringLiteral>(value, span);
+        case TokenType::OPERATOR:
+            return make_shared<TokenOperator>(value, span);
+        case TokenType::COMMENT:
+            return make_shared<TokenComment>(value, span);
+        default:
+            return make_shared<TokenEofOrUndefined>(span);
+    }
+}
@@ -0,0 +1,207 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_ASTARENA_H
+#define AUX_ASTARENA_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Tree.h"
+
+namespace aux::ir::ast {
+
+    /**
+     * 32-bit handle of a node in @class AstArena: the pool of the node, one per @enum NodeKind,
+     * in the highest 4 bits and its index in that pool in the rest
+     */
+    struct NodeRef {
+        using Pool = NodeKind;
+
+        static constexpr uint32_t INDEX_BITS = 28;
+        static constexpr uint32_t MAX_INDEX = (1u << INDEX_BITS) - 1;
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        uint32_t value{NONE};
+
+        NodeRef() = default;
+
+        NodeRef(Pool pool, uint32_t index) : value(static_cast<uint32_t>(pool) << INDEX_BITS | index) {}
+
+        [[nodiscard]]
+        inline Pool getPool() const {
+            return static_cast<Pool>(value >> INDEX_BITS);
+        }
+
+        [[nodiscard]]
+        inline uint32_t getIndex() const {
+            return value & MAX_INDEX;
+        }
+
+        inline explicit operator bool() const {
+            return value != NONE;
+        }
+
+        inline bool operator==(const NodeRef &other) const = default;
+    };
+
+    using TokenRef = uint32_t;
+    constexpr TokenRef NO_TOKEN = UINT32_MAX;
+
+    /**
+     * Token without its virtual interface, the raw value is an interned string of the arena
+     */
+    struct TokenRecord {
+        uint32_t value;
+        uint16_t row;
+        uint16_t column;
+        tokens::TokenType type;
+    };
+
+    struct BinNode {
+        BinTree::Type type;
+        TokenRef op;
+        NodeRef left, right;
+    };
+
+    struct ListNode {
+        ListTree::Type type;
+        uint32_t firstChild;    // Children are at [firstChild, firstChild + childrenCount) of listChildren
+        uint32_t childrenCount;
+    };
+
+    struct TokenNode {
+        TokenTree::Type type;
+        TokenRef token;
+    };
+
+    struct ArgsNode {
+        TokenRef stringLiteral;
+        NodeRef list;
+    };
+
+    struct FunctionCallSuffixNode {
+        TokenRef identifier;
+        NodeRef args;
+    };
+
+    struct ExprSuffixNode {
+        NodeRef expression;
+        TokenRef identifier;
+    };
+
+    struct VariableNode {
+        TokenRef identifier;
+        NodeRef expression, suffixes;
+    };
+
+    struct PrefixExprNode {
+        TokenRef identifier;
+        NodeRef expression, suffixes;
+    };
+
+    struct TermNode {
+        NodeRef prefixExpr;
+        TokenRef token;
+    };
+
+    struct ForLoopNode {
+        NodeRef identifiers, expressions, block;
+        TokenRef op;
+    };
+
+    struct ErrorNode {
+        TokenRef token;
+    };
+
+    /**
+     * AST of a compilation unit stored in contiguous pools, one per node type of Tree.h. Nodes refer to each other
+     * with 32-bit @class NodeRef instead of shared pointers and all nodes are freed at once with the arena.
+     * Raw values of tokens are interned.
+     * The arena is only a post-parse compaction step. The parser does not build into it, it builds a Tree.h tree
+     * with one allocation per node, which @function add then copies. Parsing itself is neither faster nor smaller,
+     * only passes that keep or traverse the compacted tree afterwards benefit
+     */
+    struct AstArena {
+        std::vector<BinNode> binNodes;
+        std::vector<ListNode> listNodes;
+        std::vector<NodeRef> listChildren;
+        std::vector<TokenNode> tokenNodes;
+        std::vector<ArgsNode> argsNodes;
+        std::vector<FunctionCallSuffixNode> functionCallSuffixNodes;
+        std::vector<ExprSuffixNode> exprSuffixNodes;
+        std::vector<VariableNode> variableNodes;
+        std::vector<PrefixExprNode> prefixExprNodes;
+        std::vector<TermNode> termNodes;
+        std::vector<ForLoopNode> forLoopNodes;
+        std::vector<ErrorNode> errorNodes;
+
+        std::vector<TokenRecord> tokens;
+        std::vector<char> characters;
+        std::vector<uint32_t> stringOffsets{0}; // String i is at [stringOffsets[i], stringOffsets[i + 1])
+
+        /**
+         * Copies the tree into the arena, tokens shared by several nodes are stored once.
+         * The tree is left intact, it may be released by the caller afterwards
+         * @return reference to the root of the copy, empty for nullptr
+         * @throws std::length_error if a pool overflows 28-bit indices
+         */
+        NodeRef add(const std::shared_ptr<BaseTree> &tree);
+
+        /**
+         * Builds the Tree.h representation of the node, e.g. for passes not ported to the arena yet
+         */
+        [[nodiscard]]
+        std::shared_ptr<BaseTree> toTree(NodeRef node) const;
+
+        [[nodiscard]]
+        std::string_view getString(uint32_t index) const;
+
+        [[nodiscard]]
+        std::string_view getRawValue(TokenRef token) const;
+
+        [[nodiscard]]
+        std::span<const NodeRef> getChildren(const ListNode &list) const;
+
+        /**
+         * @return number of nodes in all pools
+         */
+        [[nodiscard]]
+        size_t getNodesCount() const;
+
+        /**
+         * @return bytes used by pools, including their unused capacity
+         */
+        [[nodiscard]]
+        size_t getMemoryUsage() const;
+
+        /**
+         * Frees every node at once
+         */
+        void clear();
+
+    private:
+        std::unordered_map<std::string, uint32_t> _internedStrings;
+        std::unordered_map<const tokens::Token *, TokenRef> _addedTokens;
+
+        NodeRef copy(const std::shared_ptr<BaseTree> &tree);
+
+        template<typename Node>
+        NodeRef push(std::vector<Node> &pool, NodeRef::Pool type, Node node);
+
+        TokenRef addToken(const std::shared_ptr<tokens::Token> &token);
+
+        uint32_t intern(const std::string &value);
+
+        [[nodiscard]]
+        std::shared_ptr<tokens::Token> toToken(TokenRef token) const;
+    };
+
+}
+
+#endif //AUX_ASTARENA_H
@@ -0,0 +1,149 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "AstExporter.h"
+
+#include <vector>
+
+#include "AstStatistics.h"
+
+using namespace aux::ir::ast;
+using namespace aux::ir::tokens;
+using namespace std;
+
+namespace {
+
+    /**
+     * Walks the tree in pre-order keeping only the path to the current node.
+     * Enter gets every child subtree or token with its id, the id of the parent and the index in the parent,
+     * exit is called for subtrees after all of their children
+     */
+    template<typename Enter, typename Exit>
+    void walk(const BaseTree &root, Enter &&enter, Exit &&exit) {
+        struct Frame {
+            const BaseTree *tree;
+            size_t id;
+            size_t next;
+            size_t count;
+        };
+
+        size_t nextId = 0;
+        enter(&root, nullptr, nextId, nextId, 0);
+        vector<Frame> path{{&root, nextId++, 0, root.getChildrenCount()}};
+        while (!path.empty()) {
+            auto &frame = path.back();
+            if (frame.next == frame.count) {
+                exit(*frame.tree);
+                path.pop_back();
+                continue;
+            }
+
+            auto index = frame.next++;
+            auto child = frame.tree->getChild(index);
+            auto id = nextId++;
+            enter(child.tree, child.token, id, frame.id, index);
+            if (child.tree) {
+                // Invalidates the frame reference
+                path.push_back({child.tree, id, 0, child.tree->getChildrenCount()});
+            }
+        }
+    }
+
+    void writeEscaped(ostream &out, const string &value, bool isJson) {
+        for (char character: value) {
+            switch (character) {
+                case '"':
+                    out << "\\\"";
+                    break;
+                case '\\':
+                    out << "\\\\";
+                    break;
+                case '\n':
+                    out << "\\n";
+                    break;
+                case '\r':
+                    out << "\\r";
+                    break;
+                case '\t':
+                    out << "\\t";
+                    break;
+                default: {
+                    // Lua strings are bytes, bytes of non-ASCII ones are written as U+0080..U+00FF to keep JSON valid
+                    auto byte = static_cast<unsigned char>(character);
+                    if (isJson && (byte < 0x20 || byte >= 0x80)) {
+                        static const char *digits = "0123456789abcdef";
+                        out << "\\u00" << digits[byte >> 4] << digits[byte & 0xF];
+                    } else {
+                        out << character;
+                    }
+                }
+            }
+        }
+    }
+
+}
+
+optional<AstExporter::Format> AstExporter::parseFormat(const string &name) {
+    if (name == "ast-dot") {
+        return Format::DOT;
+    } else if (name == "ast-json") {
+        return Format::JSON;
+    }
+    return nullopt;
+}
+
+void AstExporter::write(ostream &out, const BaseTree &root, Format format) {
+    if (format == Format::DOT) {
+        writeDot(out, root);
+    } else {
+        writeJson(out, root);
+    }
+}
+
+void AstExporter::writeDot(ostream &out, const BaseTree &root) {
+    out << "digraph AST {\n"
+           "node [shape=box, fontname=\"monospace\"];\n";
+    walk(root, [&](const BaseTree *tree, const Token *token, size_t id, size_t parentId, size_t) {
+        if (!tree && !token) {
+            return;
+        }
+
+        out << "n" << id << " [label=\"";
+        if (tree) {
+            writeEscaped(out, tree->getPrintValue(), false);
+            out << "\"];\n";
+        } else {
+            writeEscaped(out, token->getRawValue(), false);
+            out << "\", shape=ellipse];\n";
+        }
+        if (id != parentId) {
+            out << "n" << parentId << " -> n" << id << ";\n";
+        }
+    }, [](const BaseTree &) {});
+    out << "}\n";
+}
+
+void AstExporter::writeJson(ostream &out, const BaseTree &root) {
+    walk(root, [&](const BaseTree *tree, const Token *token, size_t, size_t, size_t index) {
+        if (index > 0) {
+            out << ",";
+        }
+
+        if (tree) {
+            out << "{\"kind\":\"" << getKindName(tree->kind) << "\",\"label\":\"";
+            writeEscaped(out, tree->getPrintValue(), true);
+            out << "\",\"children\":[";
+        } else if (token) {
+            auto span = token->getSpan();
+            out << "{\"token\":\"" << *token->getType() << "\",\"value\":\"";
+            writeEscaped(out, token->getRawValue(), true);
+            out << "\",\"row\":" << span.row << ",\"column\":" << span.column << "}";
+        } else {
+            out << "null";
+        }
+    }, [&](const BaseTree &) {
+        out << "]}";
+    });
+    out << "\n";
+}
@@ -0,0 +1,48 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_ASTEXPORTER_H
+#define AUX_ASTEXPORTER_H
+
+#include <optional>
+#include <ostream>
+#include <string>
+
+#include "Tree.h"
+
+namespace aux::ir::ast {
+
+    /**
+     * Writes a parse tree as Graphviz DOT or JSON in a single walk. Nothing is kept besides the path
+     * to the current node, so memory is bounded by the depth of the tree and the output goes
+     * straight to the stream, which should be buffered for large trees
+     */
+    struct AstExporter {
+        enum class Format {
+            DOT,
+            JSON
+        };
+
+        /**
+         * @return format by its command line name: "ast-dot" or "ast-json"
+         */
+        static std::optional<Format> parseFormat(const std::string &name);
+
+        static void write(std::ostream &out, const BaseTree &root, Format format);
+
+        /**
+         * Nodes are labeled with their print values, tokens stored in nodes directly are leaves labeled with raw values
+         */
+        static void writeDot(std::ostream &out, const BaseTree &root);
+
+        /**
+         * Every node is an object {"kind", "label", "children"}, tokens stored in nodes directly are
+         * objects {"token", "value", "row", "column"} and null elements of lists are nulls
+         */
+        static void writeJson(std::ostream &out, const BaseTree &root);
+    };
+
+}
+
+#endif //AUX_ASTEXPORTER_H
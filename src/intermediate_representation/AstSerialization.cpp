@@ -0,0 +1,311 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "AstSerialization.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace aux::ir::ast;
+using namespace std;
+
+namespace {
+
+    using Section = AstFileHeader::Section;
+
+    constexpr size_t ALIGNMENT = 8;
+
+    size_t aligned(size_t offset) {
+        return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    /**
+     * Calls the function with each section and the matching pool of the arena or the view
+     */
+    template<typename Pools, typename Function>
+    void forEachSection(Pools &pools, Function &&function) {
+        function(Section::BIN_NODES, pools.binNodes);
+        function(Section::LIST_NODES, pools.listNodes);
+        function(Section::LIST_CHILDREN, pools.listChildren);
+        function(Section::TOKEN_NODES, pools.tokenNodes);
+        function(Section::ARGS_NODES, pools.argsNodes);
+        function(Section::FUNCTION_CALL_SUFFIX_NODES, pools.functionCallSuffixNodes);
+        function(Section::EXPR_SUFFIX_NODES, pools.exprSuffixNodes);
+        function(Section::VARIABLE_NODES, pools.variableNodes);
+        function(Section::PREFIX_EXPR_NODES, pools.prefixExprNodes);
+        function(Section::TERM_NODES, pools.termNodes);
+        function(Section::FOR_LOOP_NODES, pools.forLoopNodes);
+        function(Section::ERROR_NODES, pools.errorNodes);
+        function(Section::TOKENS, pools.tokens);
+        function(Section::CHARACTERS, pools.characters);
+        function(Section::STRING_OFFSETS, pools.stringOffsets);
+    }
+
+}
+
+void AstWriter::write(ostream &out, const AstArena &arena, NodeRef root) {
+    AstFileHeader header;
+    header.root = root;
+
+    size_t offset = aligned(sizeof(AstFileHeader));
+    forEachSection(arena, [&](Section section, const auto &pool) {
+        using Record = typename decay_t<decltype(pool)>::value_type;
+        static_assert(is_trivially_copyable_v<Record>);
+
+        header.sections[static_cast<size_t>(section)] = {offset, static_cast<uint32_t>(pool.size()), sizeof(Record)};
+        offset = aligned(offset + pool.size() * sizeof(Record));
+    });
+
+    const char padding[ALIGNMENT] = {};
+    size_t written = sizeof(AstFileHeader);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(AstFileHeader));
+    forEachSection(arena, [&](Section section, const auto &pool) {
+        const auto &entry = header.sections[static_cast<size_t>(section)];
+        out.write(padding, static_cast<streamsize>(entry.offset - written));
+        out.write(reinterpret_cast<const char *>(pool.data()), static_cast<streamsize>(entry.count * entry.recordSize));
+        written = entry.offset + entry.count * entry.recordSize;
+    });
+    out.write(padding, static_cast<streamsize>(aligned(written) - written));
+}
+
+AstView::AstView(span<const byte> buffer) {
+    if (buffer.size() < sizeof(AstFileHeader) || reinterpret_cast<uintptr_t>(buffer.data()) % ALIGNMENT != 0) {
+        throw invalid_argument("Buffer is too small or not aligned for a serialized AST");
+    }
+
+    const auto &header = *reinterpret_cast<const AstFileHeader *>(buffer.data());
+    if (header.magic != AstFileHeader::MAGIC || header.version != AstFileHeader::VERSION) {
+        throw invalid_argument("Buffer is not a serialized AST of version " + to_string(AstFileHeader::VERSION));
+    }
+    root = header.root;
+
+    forEachSection(*this, [&](Section section, auto &pool) {
+        using Record = typename decay_t<decltype(pool)>::element_type;
+
+        const auto &entry = header.sections[static_cast<size_t>(section)];
+        if (entry.recordSize != sizeof(Record) || entry.offset % alignof(Record) != 0
+            || entry.offset > buffer.size() || entry.count > (buffer.size() - entry.offset) / sizeof(Record)) {
+            throw invalid_argument("Section " + to_string(static_cast<uint32_t>(section)) + " of AST is malformed");
+        }
+        pool = {reinterpret_cast<const Record *>(buffer.data() + entry.offset), entry.count};
+    });
+
+    validate();
+}
+
+void AstView::validate() const {
+    using Pool = NodeRef::Pool;
+    using tokens::TokenType;
+
+    if (stringOffsets.empty() || stringOffsets.front() != 0 || stringOffsets.back() != characters.size()
+        || !is_sorted(stringOffsets.begin(), stringOffsets.end())) {
+        throw invalid_argument("Strings of AST are malformed");
+    }
+    for (const auto &token: tokens) {
+        if (token.value >= stringOffsets.size() - 1 || token.type > TokenType::EOF_OR_UNDEFINED) {
+            throw invalid_argument("Token of AST is malformed");
+        }
+    }
+
+    checkNode(root);
+    for (const auto &bin: binNodes) {
+        checkNode(bin.left);
+        checkNode(bin.right);
+        checkToken(bin.op);
+    }
+    for (const auto &list: listNodes) {
+        if (uint64_t{list.firstChild} + list.childrenCount > listChildren.size()) {
+            throw invalid_argument("Children of AST list are out of bounds");
+        }
+    }
+    for (auto child: listChildren) {
+        checkNode(child);
+    }
+    for (const auto &token: tokenNodes) {
+        checkToken(token.token);
+    }
+    for (const auto &args: argsNodes) {
+        checkToken(args.stringLiteral, TokenType::STRING_LITERAL);
+        checkNode(args.list, Pool::LIST);
+    }
+    for (const auto &call: functionCallSuffixNodes) {
+        checkToken(call.identifier, TokenType::IDENTIFIER);
+        checkNode(call.args, Pool::ARGS);
+    }
+    for (const auto &suffix: exprSuffixNodes) {
+        checkNode(suffix.expression);
+        checkToken(suffix.identifier, TokenType::IDENTIFIER);
+    }
+    for (const auto &variable: variableNodes) {
+        checkToken(variable.identifier, TokenType::IDENTIFIER);
+        checkNode(variable.expression);
+        checkNode(variable.suffixes, Pool::LIST);
+    }
+    for (const auto &prefixExpr: prefixExprNodes) {
+        checkToken(prefixExpr.identifier, TokenType::IDENTIFIER);
+        checkNode(prefixExpr.expression);
+        checkNode(prefixExpr.suffixes, Pool::LIST);
+    }
+    for (const auto &term: termNodes) {
+        checkNode(term.prefixExpr, Pool::PREFIX_EXPR);
+        checkToken(term.token);
+    }
+    for (const auto &forLoop: forLoopNodes) {
+        checkNode(forLoop.identifiers, Pool::LIST);
+        checkNode(forLoop.expressions, Pool::LIST);
+        checkNode(forLoop.block, Pool::LIST);
+        checkToken(forLoop.op);
+    }
+    for (const auto &error: errorNodes) {
+        checkToken(error.token);
+    }
+}
+
+void AstView::checkNode(NodeRef node) const {
+    using Pool = NodeRef::Pool;
+
+    if (!node) {
+        return;
+    }
+
+    size_t size = 0;
+    switch (node.getPool()) {
+        case Pool::BIN:
+            size = binNodes.size();
+            break;
+        case Pool::LIST:
+            size = listNodes.size();
+            break;
+        case Pool::TOKEN:
+            size = tokenNodes.size();
+            break;
+        case Pool::ARGS:
+            size = argsNodes.size();
+            break;
+        case Pool::FUNCTION_CALL_SUFFIX:
+            size = functionCallSuffixNodes.size();
+            break;
+        case Pool::EXPR_SUFFIX:
+            size = exprSuffixNodes.size();
+            break;
+        case Pool::VARIABLE:
+            size = variableNodes.size();
+            break;
+        case Pool::PREFIX_EXPR:
+            size = prefixExprNodes.size();
+            break;
+        case Pool::TERM:
+            size = termNodes.size();
+            break;
+        case Pool::FOR_LOOP:
+            size = forLoopNodes.size();
+            break;
+        case Pool::ERROR:
+            size = errorNodes.size();
+            break;
+    }
+    if (node.getIndex() >= size) {
+        throw invalid_argument("Node reference " + to_string(node.value) + " of AST is out of bounds");
+    }
+}
+
+void AstView::checkNode(NodeRef node, NodeRef::Pool pool) const {
+    if (node && node.getPool() != pool) {
+        throw invalid_argument("Node reference " + to_string(node.value) + " of AST has unexpected type");
+    }
+    checkNode(node);
+}
+
+void AstView::checkToken(TokenRef token) const {
+    if (token != NO_TOKEN && token >= tokens.size()) {
+        throw invalid_argument("Token reference " + to_string(token) + " of AST is out of bounds");
+    }
+}
+
+void AstView::checkToken(TokenRef token, tokens::TokenType type) const {
+    checkToken(token);
+    if (token != NO_TOKEN && tokens[token].type != type) {
+        throw invalid_argument("Token reference " + to_string(token) + " of AST has unexpected type");
+    }
+}
+
+string_view AstView::getString(uint32_t index) const {
+    return {characters.data() + stringOffsets[index], stringOffsets[index + 1] - stringOffsets[index]};
+}
+
+string_view AstView::getRawValue(TokenRef token) const {
+    return getString(tokens[token].value);
+}
+
+span<const NodeRef> AstView::getChildren(const ListNode &list) const {
+    return listChildren.subspan(list.firstChild, list.childrenCount);
+}
+
+AstArena AstView::toArena() const {
+    AstArena result;
+    auto copy = [](auto &to, const auto &from) {
+        to.assign(from.begin(), from.end());
+    };
+    copy(result.binNodes, binNodes);
+    copy(result.listNodes, listNodes);
+    copy(result.listChildren, listChildren);
+    copy(result.tokenNodes, tokenNodes);
+    copy(result.argsNodes, argsNodes);
+    copy(result.functionCallSuffixNodes, functionCallSuffixNodes);
+    copy(result.exprSuffixNodes, exprSuffixNodes);
+    copy(result.variableNodes, variableNodes);
+    copy(result.prefixExprNodes, prefixExprNodes);
+    copy(result.termNodes, termNodes);
+    copy(result.forLoopNodes, forLoopNodes);
+    copy(result.errorNodes, errorNodes);
+    copy(result.tokens, tokens);
+    copy(result.characters, characters);
+    copy(result.stringOffsets, stringOffsets);
+    return result;
+}
+
+MappedAstFile::MappedAstFile(const string &path) {
+    auto descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw runtime_error("Cannot open AST file " + path + ": " + strerror(errno));
+    }
+
+    struct stat status{};
+    if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+        close(descriptor);
+        throw runtime_error("Cannot map empty or inaccessible AST file " + path);
+    }
+
+    _size = static_cast<size_t>(status.st_size);
+    _address = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (_address == MAP_FAILED) {
+        _address = nullptr;
+        throw runtime_error("Cannot map AST file " + path + ": " + strerror(errno));
+    }
+
+    try {
+        _view = make_unique<AstView>(span<const byte>{static_cast<const byte *>(_address), _size});
+    } catch (...) {
+        munmap(_address, _size);
+        throw;
+    }
+}
+
+MappedAstFile::~MappedAstFile() {
+    if (_address) {
+        munmap(_address, _size);
+    }
+}
+
+const AstView &MappedAstFile::getView() const {
+    return *_view;
+}
@@ -0,0 +1,153 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_ASTSERIALIZATION_H
+#define AUX_ASTSERIALIZATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+
+#include "AstArena.h"
+
+namespace aux::ir::ast {
+
+    /**
+     * Binary AST format: a header followed by the pools of @class AstArena, each aligned to 8 bytes.
+     * Sections are located by offsets from the beginning of the file, so the file can be mapped
+     * at any address and read in place. Records are stored in the native byte order and layout,
+     * the header keeps enough to reject files written by an incompatible build
+     */
+    struct AstFileHeader {
+        enum class Section : uint32_t {
+            BIN_NODES,
+            LIST_NODES,
+            LIST_CHILDREN,
+            TOKEN_NODES,
+            ARGS_NODES,
+            FUNCTION_CALL_SUFFIX_NODES,
+            EXPR_SUFFIX_NODES,
+            VARIABLE_NODES,
+            PREFIX_EXPR_NODES,
+            TERM_NODES,
+            FOR_LOOP_NODES,
+            ERROR_NODES,
+            TOKENS,
+            CHARACTERS,
+            STRING_OFFSETS,
+            COUNT
+        };
+
+        struct SectionEntry {
+            uint64_t offset;
+            uint32_t count;
+            uint32_t recordSize;
+        };
+
+        static constexpr uint32_t MAGIC = 0x41535458; // "XTSA" in little endian files
+        static constexpr uint32_t VERSION = 1;
+
+        uint32_t magic{MAGIC};
+        uint32_t version{VERSION};
+        NodeRef root;
+        uint32_t reserved{0};
+        SectionEntry sections[static_cast<size_t>(Section::COUNT)];
+    };
+
+    struct AstWriter {
+        /**
+         * Writes pools of the arena with the given root to the stream
+         */
+        static void write(std::ostream &out, const AstArena &arena, NodeRef root);
+    };
+
+    /**
+     * Read-only view of a serialized AST, pools are spans over the buffer, which must outlive the view
+     */
+    struct AstView {
+        std::span<const BinNode> binNodes;
+        std::span<const ListNode> listNodes;
+        std::span<const NodeRef> listChildren;
+        std::span<const TokenNode> tokenNodes;
+        std::span<const ArgsNode> argsNodes;
+        std::span<const FunctionCallSuffixNode> functionCallSuffixNodes;
+        std::span<const ExprSuffixNode> exprSuffixNodes;
+        std::span<const VariableNode> variableNodes;
+        std::span<const PrefixExprNode> prefixExprNodes;
+        std::span<const TermNode> termNodes;
+        std::span<const ForLoopNode> forLoopNodes;
+        std::span<const ErrorNode> errorNodes;
+
+        std::span<const TokenRecord> tokens;
+        std::span<const char> characters;
+        std::span<const uint32_t> stringOffsets;
+
+        NodeRef root;
+
+        /**
+         * Checks that sections fit the buffer and that every node, token and string reference of the records
+         * is in bounds and of the type its field expects, so that a corrupted file is rejected here rather than
+         * read out of bounds later. Values of enum fields are not checked
+         * @param buffer serialized AST aligned to 8 bytes, e.g. a mapped file
+         * @throws std::invalid_argument if the buffer is not a serialized AST of this build
+         */
+        explicit AstView(std::span<const std::byte> buffer);
+
+        [[nodiscard]]
+        std::string_view getString(uint32_t index) const;
+
+        [[nodiscard]]
+        std::string_view getRawValue(TokenRef token) const;
+
+        [[nodiscard]]
+        std::span<const NodeRef> getChildren(const ListNode &list) const;
+
+        /**
+         * Copies pools into a new arena, e.g. to continue building it
+         */
+        [[nodiscard]]
+        AstArena toArena() const;
+
+    private:
+        void validate() const;
+
+        void checkNode(NodeRef node) const;
+
+        void checkNode(NodeRef node, NodeRef::Pool pool) const;
+
+        void checkToken(TokenRef token) const;
+
+        void checkToken(TokenRef token, tokens::TokenType type) const;
+    };
+
+    /**
+     * Read-only memory mapping of a serialized AST file, unmapped on destruction
+     */
+    struct MappedAstFile {
+        /**
+         * @throws std::runtime_error if the file cannot be mapped
+         * @throws std::invalid_argument if it is not a serialized AST of this build
+         */
+        explicit MappedAstFile(const std::string &path);
+
+        MappedAstFile(const MappedAstFile &) = delete;
+
+        MappedAstFile &operator=(const MappedAstFile &) = delete;
+
+        ~MappedAstFile();
+
+        [[nodiscard]]
+        const AstView &getView() const;
+
+    private:
+        void *_address{nullptr};
+        size_t _size{0};
+        std::unique_ptr<AstView> _view;
+    };
+
+}
+
+#endif //AUX_ASTSERIALIZATION_H
@@ -0,0 +1,195 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "AstStatistics.h"
+
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace aux::ir::ast;
+using namespace aux::ir::tokens;
+using namespace std;
+
+namespace {
+
+    // Objects are created with make_shared, which places them after a control block of a vtable and two counters
+    constexpr size_t CONTROL_BLOCK_BYTES = sizeof(void *) + 2 * sizeof(int);
+
+    size_t heapBytes(const string &value) {
+        auto data = reinterpret_cast<const char *>(value.data());
+        auto object = reinterpret_cast<const char *>(&value);
+        bool isSmall = data >= object && data < object + sizeof(string);
+        return isSmall ? 0 : value.capacity() + 1;
+    }
+
+    /**
+     * For strings that are only accessible by copy, assumes they were allocated exactly
+     */
+    size_t heapBytes(size_t length) {
+        static const size_t smallCapacity = string{}.capacity();
+        return length > smallCapacity ? length + 1 : 0;
+    }
+
+    size_t nodeBytes(const BaseTree &tree) {
+        switch (tree.kind) {
+            case NodeKind::BIN:
+                return sizeof(BinTree);
+            case NodeKind::LIST:
+                return sizeof(ListTree)
+                       + tree.as<ListTree>()->trees.capacity() * sizeof(shared_ptr<BaseTree>);
+            case NodeKind::TOKEN:
+                return sizeof(TokenTree);
+            case NodeKind::ARGS:
+                return sizeof(ArgsTree);
+            case NodeKind::FUNCTION_CALL_SUFFIX:
+                return sizeof(FunctionCallSuffixTree);
+            case NodeKind::EXPR_SUFFIX:
+                return sizeof(ExprSuffixTree);
+            case NodeKind::VARIABLE:
+                return sizeof(VariableTree);
+            case NodeKind::PREFIX_EXPR:
+                return sizeof(PrefixExprTree);
+            case NodeKind::TERM:
+                return sizeof(TermTree);
+            case NodeKind::FOR_LOOP:
+                return sizeof(ForLoopTree);
+            case NodeKind::ERROR:
+                return sizeof(ErrorTree);
+        }
+        return 0;
+    }
+
+    size_t tokenBytes(const Token &token) {
+        switch (token.getType()) {
+            case TokenType::IDENTIFIER:
+                return sizeof(TokenIdentifier) + heapBytes(static_cast<const TokenIdentifier &>(token).getValue());
+            case TokenType::STRING_LITERAL:
+                return sizeof(TokenStringLiteral)
+                       + heapBytes(static_cast<const TokenStringLiteral &>(token).getValue());
+            case TokenType::COMMENT:
+                return sizeof(TokenComment) + heapBytes(static_cast<const TokenComment &>(token).getValue());
+            case TokenType::KEYWORD:
+                return sizeof(TokenKeyword);
+            case TokenType::OPERATOR:
+                return sizeof(TokenOperator);
+            case TokenType::NUMERIC_DECIMAL:
+                return sizeof(TokenDecimal) + heapBytes(token.getRawValue().size());
+            case TokenType::NUMERIC_HEX:
+                return sizeof(TokenHex) + heapBytes(token.getRawValue().size());
+            case TokenType::NUMERIC_DOUBLE:
+                return sizeof(TokenDouble) + heapBytes(token.getRawValue().size());
+            case TokenType::EOF_OR_UNDEFINED:
+                return sizeof(TokenEofOrUndefined);
+        }
+        return 0;
+    }
+
+    /**
+     * Empty suffix lists of prefix expressions are allocated, but not shown as children
+     */
+    const BaseTree *hiddenChild(const BaseTree &tree) {
+        auto prefixExpr = tree.as<PrefixExprTree>();
+        return prefixExpr && prefixExpr->suffixes && prefixExpr->suffixes->trees.empty()
+               ? prefixExpr->suffixes.get() : nullptr;
+    }
+
+}
+
+AstStatistics AstStatistics::collect(const BaseTree &root) {
+    AstStatistics result;
+    unordered_set<const void *> visited;
+
+    auto addToken = [&](const Token *token) {
+        if (token && visited.insert(token).second) {
+            ++result.tokens.count;
+            result.tokens.bytes += tokenBytes(*token) + CONTROL_BLOCK_BYTES;
+        }
+    };
+
+    vector<pair<const BaseTree *, size_t>> stack{{&root, 1}};
+    while (!stack.empty()) {
+        auto [tree, depth] = stack.back();
+        stack.pop_back();
+        if (!visited.insert(tree).second) {
+            continue;
+        }
+
+        auto &entry = result.kinds[static_cast<size_t>(tree->kind)];
+        ++entry.count;
+        entry.bytes += nodeBytes(*tree) + CONTROL_BLOCK_BYTES;
+        result.maxDepth = max(result.maxDepth, depth);
+        addToken(getOwnToken(*tree));
+        if (auto hidden = hiddenChild(*tree)) {
+            stack.emplace_back(hidden, depth + 1);
+        }
+
+        auto childrenCount = tree->getChildrenCount();
+        if (childrenCount > 0) {
+            ++result.innerNodes;
+            result.innerChildren += childrenCount;
+        }
+        tree->forEachChild([&](const TreeChild &child) {
+            if (child.tree) {
+                stack.emplace_back(child.tree, depth + 1);
+            }
+            addToken(child.token);
+        });
+    }
+
+    return result;
+}
+
+size_t AstStatistics::getNodesCount() const {
+    size_t result = 0;
+    for (const auto &entry: kinds) {
+        result += entry.count;
+    }
+    return result;
+}
+
+size_t AstStatistics::getBytes() const {
+    size_t result = tokens.bytes;
+    for (const auto &entry: kinds) {
+        result += entry.bytes;
+    }
+    return result;
+}
+
+double AstStatistics::getAverageFanOut() const {
+    return innerNodes == 0 ? 0.0 : static_cast<double>(innerChildren) / static_cast<double>(innerNodes);
+}
+
+void AstStatistics::writeText(ostream &out) const {
+    out << "Nodes: " << getNodesCount() << "\n"
+        << "Bytes: " << getBytes() << "\n"
+        << "Max depth: " << maxDepth << "\n"
+        << "Average fan-out: " << getAverageFanOut() << "\n"
+        << "Tokens: " << tokens.count << " (" << tokens.bytes << " bytes)\n";
+    for (size_t kind = 0; kind < NODE_KINDS_COUNT; ++kind) {
+        if (kinds[kind].count > 0) {
+            out << getKindName(static_cast<NodeKind>(kind)) << ": "
+                << kinds[kind].count << " (" << kinds[kind].bytes << " bytes)\n";
+        }
+    }
+}
+
+void AstStatistics::writeJson(ostream &out) const {
+    auto writeEntry = [&](const Entry &entry) {
+        out << "{\"count\": " << entry.count << ", \"bytes\": " << entry.bytes << "}";
+    };
+
+    out << "{\"nodes\": " << getNodesCount()
+        << ", \"bytes\": " << getBytes()
+        << ", \"maxDepth\": " << maxDepth
+        << ", \"averageFanOut\": " << getAverageFanOut()
+        << ", \"tokens\": ";
+    writeEntry(tokens);
+    out << ", \"kinds\": {";
+    for (size_t kind = 0; kind < NODE_KINDS_COUNT; ++kind) {
+        out << (kind == 0 ? "" : ", ") << "\"" << getKindName(static_cast<NodeKind>(kind)) << "\": ";
+        writeEntry(kinds[kind]);
+    }
+    out << "}}\n";
+}
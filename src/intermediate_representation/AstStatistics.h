@@ -0,0 +1,91 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_ASTSTATISTICS_H
+#define AUX_ASTSTATISTICS_H
+
+#include <array>
+#include <cstddef>
+#include <ostream>
+
+#include "Tree.h"
+
+namespace aux::ir::ast {
+
+    inline constexpr size_t NODE_KINDS_COUNT = static_cast<size_t>(NodeKind::ERROR) + 1;
+
+    /**
+     * @return name of the node kind as written in statistics and exported trees, e.g. "Bin" for NodeKind::BIN
+     */
+    constexpr const char *getKindName(NodeKind kind) {
+        switch (kind) {
+            case NodeKind::BIN:
+                return "Bin";
+            case NodeKind::LIST:
+                return "List";
+            case NodeKind::TOKEN:
+                return "Token";
+            case NodeKind::ARGS:
+                return "Args";
+            case NodeKind::FUNCTION_CALL_SUFFIX:
+                return "FunctionCallSuffix";
+            case NodeKind::EXPR_SUFFIX:
+                return "ExprSuffix";
+            case NodeKind::VARIABLE:
+                return "Variable";
+            case NodeKind::PREFIX_EXPR:
+                return "PrefixExpr";
+            case NodeKind::TERM:
+                return "Term";
+            case NodeKind::FOR_LOOP:
+                return "ForLoop";
+            case NodeKind::ERROR:
+                return "Error";
+        }
+        return "Unknown";
+    }
+
+    /**
+     * Memory footprint and shape of a parse tree. Bytes are estimated for the allocations the tree owns:
+     * node objects with their shared_ptr control blocks, element buffers of ListTree::trees,
+     * and tokens with heap buffers of their strings. Nodes and tokens reachable by several paths are counted once
+     */
+    struct AstStatistics {
+        struct Entry {
+            size_t count{0};
+            size_t bytes{0};
+        };
+
+        std::array<Entry, NODE_KINDS_COUNT> kinds{};
+        Entry tokens;
+        size_t maxDepth{0};
+        // Nodes having at least one child and the number of their children, for the average fan-out
+        size_t innerNodes{0};
+        size_t innerChildren{0};
+
+        /**
+         * Walks the tree once without recursion, so it works for trees built with explicit stack parsing
+         */
+        static AstStatistics collect(const BaseTree &root);
+
+        [[nodiscard]]
+        size_t getNodesCount() const;
+
+        /**
+         * @return bytes of nodes and tokens together
+         */
+        [[nodiscard]]
+        size_t getBytes() const;
+
+        [[nodiscard]]
+        double getAverageFanOut() const;
+
+        void writeText(std::ostream &out) const;
+
+        void writeJson(std::ostream &out) const;
+    };
+
+}
+
+#endif //AUX_ASTSTATISTICS_H
@@ -0,0 +1,50 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "FrozenTree.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+using namespace aux::ir::ast;
+using namespace std;
+
+FrozenTree::FrozenTree(shared_ptr<BaseTree> root) {
+    if (!root) {
+        throw invalid_argument("Can not freeze an empty tree");
+    }
+    if (root.use_count() != 1) {
+        throw invalid_argument("Can not freeze a tree that is referenced somewhere else");
+    }
+    _root = std::move(root);
+
+    unordered_set<const BaseTree *> visited;
+    vector<const BaseTree *> stack{_root.get()};
+    while (!stack.empty()) {
+        auto tree = stack.back();
+        stack.pop_back();
+        if (!visited.insert(tree).second) {
+            continue;
+        }
+
+        _nodes.push_back(tree);
+        auto begin = stack.size();
+        tree->forEachChild([&](const TreeChild &child) {
+            if (child.tree) {
+                stack.push_back(child.tree);
+            }
+        });
+        // Children are pushed in order, but have to be popped in order too
+        reverse(stack.begin() + static_cast<ptrdiff_t>(begin), stack.end());
+    }
+}
+
+const BaseTree &FrozenTree::getRoot() const {
+    return *_root;
+}
+
+const vector<const BaseTree *> &FrozenTree::getNodes() const {
+    return _nodes;
+}
@@ -0,0 +1,54 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_FROZENTREE_H
+#define AUX_FROZENTREE_H
+
+#include <memory>
+#include <vector>
+
+#include "Tree.h"
+
+namespace aux::ir::ast {
+
+    /**
+     * Parse tree that no longer changes, made from the result of Parser::parse once parsing is finished.
+     * It only gives out const references and raw pointers to nodes: reads do not touch reference counters
+     * or any other shared state, so one frozen tree can be read by several analysis passes at once,
+     * each in its own thread, without locks. Nodes are kept alive by the frozen tree and have to outlive
+     * the passes that read them.
+     * Only the reference to the root is checked. Subtrees may still be referenced elsewhere, e.g. by function body
+     * records of Parser and IncrementalParser or by a HashConser, which must not change them while the tree is read
+     */
+    struct FrozenTree {
+        /**
+         * Takes the only reference to the root of the tree
+         * @throws std::invalid_argument if the tree is null or its root is still referenced somewhere else
+         */
+        explicit FrozenTree(std::shared_ptr<BaseTree> root);
+
+        FrozenTree(const FrozenTree &) = delete;
+        FrozenTree(FrozenTree &&) = default;
+        FrozenTree &operator=(const FrozenTree &) = delete;
+        FrozenTree &operator=(FrozenTree &&) = default;
+
+        [[nodiscard]]
+        const BaseTree &getRoot() const;
+
+        /**
+         * @return every node of the tree in pre-order, so that passes can split the work without walking the tree.
+         * Subtrees shared by several parents, e.g. after hash-consing, are listed once
+         */
+        [[nodiscard]]
+        const std::vector<const BaseTree *> &getNodes() const;
+
+    private:
+        std::shared_ptr<const BaseTree> _root;
+        std::vector<const BaseTree *> _nodes;
+
+    };
+
+}
+
+#endif //AUX_FROZENTREE_H
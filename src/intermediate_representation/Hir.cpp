@@ -0,0 +1,277 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "Hir.h"
+
+#include <cstdio>
+#include <stdexcept>
+
+using namespace aux::ir::hir;
+using namespace std;
+
+namespace {
+
+    void writeQuoted(ostream &out, string_view value) {
+        out << '"';
+        for (char character: value) {
+            switch (character) {
+                case '"':
+                    out << "\\\"";
+                    break;
+                case '\\':
+                    out << "\\\\";
+                    break;
+                case '\n':
+                    out << "\\n";
+                    break;
+                default:
+                    out << character;
+            }
+        }
+        out << '"';
+    }
+
+}
+
+string aux::ir::hir::toLuaString(double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.14g", value);
+    string result{buffer};
+    if (result.find_first_not_of("-0123456789") == string::npos) {
+        result += ".0";
+    }
+    return result;
+}
+
+const char *aux::ir::hir::getKindName(HirKind kind) {
+    switch (kind) {
+        case HirKind::NIL:
+            return "Nil";
+        case HirKind::TRUE:
+            return "True";
+        case HirKind::FALSE:
+            return "False";
+        case HirKind::INTEGER:
+            return "Integer";
+        case HirKind::FLOAT:
+            return "Float";
+        case HirKind::STRING:
+            return "String";
+        case HirKind::VARARG:
+            return "Vararg";
+        case HirKind::NAME:
+            return "Name";
+        case HirKind::INDEX:
+            return "Index";
+        case HirKind::CALL:
+            return "Call";
+        case HirKind::METHOD_CALL:
+            return "MethodCall";
+        case HirKind::FUNCTION:
+            return "Function";
+        case HirKind::TABLE:
+            return "Table";
+        case HirKind::TABLE_FIELD:
+            return "TableField";
+        case HirKind::BINARY:
+            return "Binary";
+        case HirKind::UNARY:
+            return "Unary";
+        case HirKind::PAREN:
+            return "Paren";
+        case HirKind::DECLARATION:
+            return "Declaration";
+        case HirKind::BLOCK:
+            return "Block";
+        case HirKind::LOCAL_DECL:
+            return "LocalDecl";
+        case HirKind::LOCAL_FUNCTION:
+            return "LocalFunction";
+        case HirKind::ASSIGN:
+            return "Assign";
+        case HirKind::RETURN:
+            return "Return";
+        case HirKind::IF:
+            return "If";
+        case HirKind::WHILE:
+            return "While";
+        case HirKind::REPEAT:
+            return "Repeat";
+        case HirKind::NUMERIC_FOR:
+            return "NumericFor";
+        case HirKind::GENERIC_FOR:
+            return "GenericFor";
+        case HirKind::BREAK:
+            return "Break";
+        case HirKind::GOTO:
+            return "Goto";
+        case HirKind::LABEL:
+            return "Label";
+    }
+    return "";
+}
+
+const char *aux::ir::hir::getOperatorName(BinaryOp op) {
+    switch (op) {
+        case BinaryOp::ADD:
+            return "+";
+        case BinaryOp::SUB:
+            return "-";
+        case BinaryOp::MUL:
+            return "*";
+        case BinaryOp::DIV:
+            return "/";
+        case BinaryOp::FLOOR_DIV:
+            return "//";
+        case BinaryOp::MOD:
+            return "%";
+        case BinaryOp::POW:
+            return "^";
+        case BinaryOp::CONCAT:
+            return "..";
+        case BinaryOp::EQ:
+            return "==";
+        case BinaryOp::NE:
+            return "~=";
+        case BinaryOp::LT:
+            return "<";
+        case BinaryOp::LE:
+            return "<=";
+        case BinaryOp::GT:
+            return ">";
+        case BinaryOp::GE:
+            return ">=";
+        case BinaryOp::AND:
+            return "and";
+        case BinaryOp::OR:
+            return "or";
+        case BinaryOp::BAND:
+            return "&";
+        case BinaryOp::BOR:
+            return "|";
+        case BinaryOp::BXOR:
+            return "~";
+        case BinaryOp::SHL:
+            return "<<";
+        case BinaryOp::SHR:
+            return ">>";
+    }
+    return "";
+}
+
+const char *aux::ir::hir::getOperatorName(UnaryOp op) {
+    switch (op) {
+        case UnaryOp::NEG:
+            return "-";
+        case UnaryOp::NOT:
+            return "not";
+        case UnaryOp::LEN:
+            return "#";
+        case UnaryOp::BNOT:
+            return "~";
+    }
+    return "";
+}
+
+bool aux::ir::hir::isStatement(HirKind kind) {
+    return kind >= HirKind::BLOCK || kind == HirKind::CALL || kind == HirKind::METHOD_CALL;
+}
+
+SymbolId SymbolTable::intern(string_view value) {
+    auto [symbol, isNew] = _symbols.try_emplace(string(value), static_cast<SymbolId>(size()));
+    if (isNew) {
+        characters.insert(characters.end(), value.begin(), value.end());
+        offsets.push_back(static_cast<uint32_t>(characters.size()));
+    }
+    return symbol->second;
+}
+
+SymbolId SymbolTable::find(string_view value) const {
+    auto symbol = _symbols.find(string(value));
+    return symbol != _symbols.end() ? symbol->second : NO_SYMBOL;
+}
+
+string_view SymbolTable::getName(SymbolId symbol) const {
+    return {characters.data() + offsets[symbol], offsets[symbol + 1] - offsets[symbol]};
+}
+
+size_t SymbolTable::size() const {
+    return offsets.size() - 1;
+}
+
+NodeId HirModule::add(HirNode node, span<const NodeId> nodeChildren) {
+    if (nodes.size() >= NO_NODE || children.size() + nodeChildren.size() >= UINT32_MAX) {
+        throw length_error("HIR module is too large");
+    }
+    node.first = static_cast<uint32_t>(children.size());
+    node.count = static_cast<uint32_t>(nodeChildren.size());
+    children.insert(children.end(), nodeChildren.begin(), nodeChildren.end());
+    nodes.push_back(node);
+    return static_cast<NodeId>(nodes.size() - 1);
+}
+
+size_t HirModule::getMemoryUsage() const {
+    return nodes.capacity() * sizeof(HirNode)
+           + children.capacity() * sizeof(NodeId)
+           + integers.capacity() * sizeof(int64_t)
+           + floats.capacity() * sizeof(double)
+           + symbols.characters.capacity()
+           + symbols.offsets.capacity() * sizeof(uint32_t);
+}
+
+void HirModule::write(ostream &out, NodeId node) const {
+    const auto &hirNode = nodes[node];
+    out << "(" << getKindName(hirNode.kind);
+    switch (hirNode.kind) {
+        case HirKind::INTEGER:
+            out << " " << integers[hirNode.value];
+            break;
+        case HirKind::FLOAT:
+            out << " " << toLuaString(floats[hirNode.value]);
+            break;
+        case HirKind::STRING:
+            out << " ";
+            writeQuoted(out, symbols.getName(hirNode.value));
+            break;
+        case HirKind::NAME:
+        case HirKind::GOTO:
+        case HirKind::LABEL:
+            out << " " << symbols.getName(hirNode.value);
+            break;
+        case HirKind::METHOD_CALL:
+            out << " :" << symbols.getName(hirNode.value);
+            break;
+        case HirKind::FUNCTION:
+            if (hirNode.op) {
+                out << " ...";
+            }
+            break;
+        case HirKind::BINARY:
+            out << " " << getOperatorName(static_cast<BinaryOp>(hirNode.op));
+            break;
+        case HirKind::UNARY:
+            out << " " << getOperatorName(static_cast<UnaryOp>(hirNode.op));
+            break;
+        case HirKind::DECLARATION:
+            out << " " << symbols.getName(hirNode.value);
+            if (hirNode.op == static_cast<uint8_t>(Attribute::CONST)) {
+                out << "<const>";
+            } else if (hirNode.op == static_cast<uint8_t>(Attribute::CLOSE)) {
+                out << "<close>";
+            }
+            break;
+        default:
+            break;
+    }
+
+    auto nodeChildren = getChildren(node);
+    for (size_t i = 0; i < nodeChildren.size(); ++i) {
+        if (hirNode.kind == HirKind::ASSIGN && i == hirNode.split) {
+            out << " =";
+        }
+        out << " ";
+        write(out, nodeChildren[i]);
+    }
+    out << ")";
+}
@@ -0,0 +1,206 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_HIR_H
+#define AUX_HIR_H
+
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Tree.h"
+
+namespace aux::ir::hir {
+
+    using NodeId = uint32_t;
+    using SymbolId = uint32_t;
+
+    inline constexpr NodeId NO_NODE = UINT32_MAX;
+    inline constexpr SymbolId NO_SYMBOL = UINT32_MAX;
+
+    /**
+     * Kind of a HIR node, children of every kind are listed in the order they are stored
+     */
+    enum class HirKind : uint8_t {
+        // Expressions
+        NIL,
+        TRUE,
+        FALSE,
+        INTEGER,        // value is an index in HirModule::integers
+        FLOAT,          // value is an index in HirModule::floats
+        STRING,         // value is the symbol of the string
+        VARARG,
+        NAME,           // value is the symbol of the name
+        INDEX,          // object, key. Fields, e.g. a.b, are indexed with string keys
+        CALL,           // callee, arguments...
+        METHOD_CALL,    // object, arguments... value is the symbol of the method
+        FUNCTION,       // parameters..., body. split is the number of parameters, op is 1 for vararg functions
+        TABLE,          // positional values and TABLE_FIELD nodes in the order of the constructor
+        TABLE_FIELD,    // key, value
+        BINARY,         // left, right. op is @enum BinaryOp
+        UNARY,          // operand. op is @enum UnaryOp
+        PAREN,          // expression truncated to a single value, only kept around calls and varargs
+
+        // Declared names: of locals, parameters and loop variables. value is the symbol, op is @enum Attribute
+        DECLARATION,
+
+        // Statements
+        BLOCK,          // statements...
+        LOCAL_DECL,     // declarations..., values... split is the number of declarations
+        LOCAL_FUNCTION, // declaration, function
+        ASSIGN,         // targets..., values... split is the number of targets, targets are NAME and INDEX
+        RETURN,         // values...
+        IF,             // condition, block, condition, block, ..., else block if the number of children is odd
+        WHILE,          // condition, block
+        REPEAT,         // block, condition
+        NUMERIC_FOR,    // declaration, start, limit, step, block. Step is an INTEGER 1 if omitted
+        GENERIC_FOR,    // declarations..., expressions..., block. split is the number of declarations
+        BREAK,
+        GOTO,           // value is the symbol of the label
+        LABEL           // value is the symbol of the label
+    };
+
+    enum class BinaryOp : uint8_t {
+        ADD, SUB, MUL, DIV, FLOOR_DIV, MOD, POW, CONCAT,
+        EQ, NE, LT, LE, GT, GE,
+        AND, OR,
+        BAND, BOR, BXOR, SHL, SHR
+    };
+
+    enum class UnaryOp : uint8_t {
+        NEG, NOT, LEN, BNOT
+    };
+
+    enum class Attribute : uint8_t {
+        NONE, CONST, CLOSE
+    };
+
+    /**
+     * @return name of the kind as written by HirModule::write, e.g. "LocalDecl" for HirKind::LOCAL_DECL
+     */
+    const char *getKindName(HirKind kind);
+
+    /**
+     * @return Lua spelling of the operator, e.g. "//" for BinaryOp::FLOOR_DIV
+     */
+    const char *getOperatorName(BinaryOp op);
+
+    const char *getOperatorName(UnaryOp op);
+
+    /**
+     * Same as Lua converts floats to strings: 14 significant digits, integral values keep ".0", e.g. "1e+15", "2.0"
+     */
+    std::string toLuaString(double value);
+
+    /**
+     * Statements and calls are the only kinds allowed in blocks
+     */
+    bool isStatement(HirKind kind);
+
+    /**
+     * Children of a node are at [first, first + count) of HirModule::children
+     */
+    struct HirNode {
+        HirKind kind;
+        uint8_t op{0};
+        uint16_t split{0};
+        uint32_t value{0};
+        uint32_t first{0};
+        uint32_t count{0};
+        ast::SourceRange range;
+    };
+
+    /**
+     * Names and string literals interned as consecutive characters, equal strings have equal symbols
+     */
+    struct SymbolTable {
+        std::vector<char> characters;
+        std::vector<uint32_t> offsets{0}; // Symbol i is at [offsets[i], offsets[i + 1])
+
+        SymbolId intern(std::string_view value);
+
+        /**
+         * @return symbol of the string if it was interned, NO_SYMBOL otherwise
+         */
+        [[nodiscard]]
+        SymbolId find(std::string_view value) const;
+
+        [[nodiscard]]
+        std::string_view getName(SymbolId symbol) const;
+
+        [[nodiscard]]
+        size_t size() const;
+
+    private:
+        std::unordered_map<std::string, SymbolId> _symbols;
+    };
+
+    /**
+     * High-level IR of a chunk: the parse tree lowered to nodes of distinct kinds with operators as enums
+     * and names as symbols, see HirLowering.h. Nodes are stored in one vector, children of a node are
+     * stored before it and their ids are consecutive in @var children, so passes walk plain arrays.
+     * Passes keep their results in vectors indexed by NodeId
+     */
+    struct HirModule {
+        std::vector<HirNode> nodes;
+        std::vector<NodeId> children;
+        std::vector<int64_t> integers;
+        std::vector<double> floats;
+        SymbolTable symbols;
+
+        // FUNCTION of the main chunk, which is vararg and has no parameters
+        NodeId root{NO_NODE};
+
+        [[nodiscard]]
+        inline const HirNode &operator[](NodeId node) const {
+            return nodes[node];
+        }
+
+        [[nodiscard]]
+        inline std::span<const NodeId> getChildren(NodeId node) const {
+            return {children.data() + nodes[node].first, nodes[node].count};
+        }
+
+        [[nodiscard]]
+        inline NodeId getChild(NodeId node, size_t index) const {
+            return children[nodes[node].first + index];
+        }
+
+        /**
+         * Appends a node with the given children
+         * @throws std::length_error if ids overflow 32 bits
+         */
+        NodeId add(HirNode node, std::span<const NodeId> nodeChildren);
+
+        /**
+         * @return body of the function, which is its last child
+         */
+        [[nodiscard]]
+        inline NodeId getFunctionBody(NodeId function) const {
+            return getChild(function, nodes[function].count - 1);
+        }
+
+        /**
+         * @return bytes used by nodes, children and constants, including their unused capacity
+         */
+        [[nodiscard]]
+        size_t getMemoryUsage() const;
+
+        /**
+         * Writes the subtree as an S-expression, e.g. (Assign (Name x) (Binary + (Integer 1) (Name y)))
+         */
+        void write(std::ostream &out, NodeId node) const;
+
+        inline void write(std::ostream &out) const {
+            write(out, root);
+        }
+    };
+
+}
+
+#endif //AUX_HIR_H
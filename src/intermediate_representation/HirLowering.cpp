@@ -0,0 +1,552 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "HirLowering.h"
+
+#include <limits>
+#include <stdexcept>
+
+using namespace aux::ir::hir;
+using namespace aux::ir::ast;
+using namespace aux::ir::tokens;
+using namespace aux::exception;
+using namespace std;
+
+namespace {
+
+    BinaryOp toBinaryOp(const Token &token) {
+        if (token.getType() == TokenType::KEYWORD) {
+            if (token.getRawValue() == *Keyword::AND) {
+                return BinaryOp::AND;
+            } else if (token.getRawValue() == *Keyword::OR) {
+                return BinaryOp::OR;
+            }
+        } else if (token.getType() == TokenType::OPERATOR) {
+            switch (static_cast<const TokenOperator &>(token).getOperator()) {
+                case Operator::PLUS:
+                    return BinaryOp::ADD;
+                case Operator::MINUS:
+                    return BinaryOp::SUB;
+                case Operator::ASTERISK:
+                    return BinaryOp::MUL;
+                case Operator::SLASH:
+                    return BinaryOp::DIV;
+                case Operator::SLASH_SLASH:
+                    return BinaryOp::FLOOR_DIV;
+                case Operator::PERCENT:
+                    return BinaryOp::MOD;
+                case Operator::CARET:
+                    return BinaryOp::POW;
+                case Operator::DOT_DOT:
+                    return BinaryOp::CONCAT;
+                case Operator::EQUAL_EQUAL:
+                    return BinaryOp::EQ;
+                case Operator::TILDA_EQUAL:
+                    return BinaryOp::NE;
+                case Operator::LESS_THAN:
+                    return BinaryOp::LT;
+                case Operator::LT_EQUAL:
+                    return BinaryOp::LE;
+                case Operator::GREATER_THAN:
+                    return BinaryOp::GT;
+                case Operator::GT_EQUAL:
+                    return BinaryOp::GE;
+                case Operator::AMPERSAND:
+                    return BinaryOp::BAND;
+                case Operator::VERTICAL_BAR:
+                    return BinaryOp::BOR;
+                case Operator::TILDA:
+                    return BinaryOp::BXOR;
+                case Operator::LT_LT:
+                    return BinaryOp::SHL;
+                case Operator::GT_GT:
+                    return BinaryOp::SHR;
+                default:
+                    break;
+            }
+        }
+        throw logic_error("Unexpected binary operator " + token.getRawValue());
+    }
+
+    UnaryOp toUnaryOp(const Token &token) {
+        if (token.getRawValue() == *Keyword::NOT) {
+            return UnaryOp::NOT;
+        } else if (token.getRawValue() == *Operator::MINUS) {
+            return UnaryOp::NEG;
+        } else if (token.getRawValue() == *Operator::SHARP) {
+            return UnaryOp::LEN;
+        } else if (token.getRawValue() == *Operator::TILDA) {
+            return UnaryOp::BNOT;
+        }
+        throw logic_error("Unexpected unary operator " + token.getRawValue());
+    }
+
+    bool isMultipleValued(HirKind kind) {
+        return kind == HirKind::CALL || kind == HirKind::METHOD_CALL || kind == HirKind::VARARG;
+    }
+
+    SourceRange rangeOf(const Token *token, const SourceRange &fallback) {
+        return token ? SourceRange::of(*token) : fallback;
+    }
+
+}
+
+HirModule HirLowering::lower(const BaseTree &chunk) {
+    _module = HirModule{};
+    _stack.clear();
+    _errors.clear();
+
+    auto mark = _stack.size();
+    lowerBlock(chunk);
+    _module.root = finish({HirKind::FUNCTION, 1, 0, 0, 0, 0, chunk.range}, mark);
+    _stack.clear();
+    return std::move(_module);
+}
+
+const vector<SemanticException> &HirLowering::getErrors() const {
+    return _errors;
+}
+
+NodeId HirLowering::finish(HirNode node, size_t mark) {
+    auto result = _module.add(node, span<const NodeId>{_stack.data() + mark, _stack.size() - mark});
+    _stack.resize(mark);
+    _stack.push_back(result);
+    return result;
+}
+
+void HirLowering::pushLeaf(HirKind kind, uint32_t value, const SourceRange &range) {
+    finish({kind, 0, 0, value, 0, 0, range}, _stack.size());
+}
+
+void HirLowering::reportError(const SourceRange &range, const string &message) {
+    _errors.emplace_back(range.getStart(), message);
+}
+
+uint16_t HirLowering::toSplit(size_t count, const SourceRange &range, const string &items) {
+    constexpr size_t MAX_SPLIT = numeric_limits<decltype(HirNode::split)>::max();
+    if (count > MAX_SPLIT) {
+        reportError(range, "too many " + items + " (limit is " + to_string(MAX_SPLIT) + ")");
+        return MAX_SPLIT;
+    }
+    return static_cast<uint16_t>(count);
+}
+
+void HirLowering::lowerBlock(const BaseTree &block) {
+    auto mark = _stack.size();
+    if (auto list = block.as<ListTree>()) {
+        for (const auto &statement: list->trees) {
+            if (statement) {
+                lowerStatement(*statement);
+            }
+        }
+    } else {
+        lowerStatement(block);
+    }
+    finish({HirKind::BLOCK, 0, 0, 0, 0, 0, block.range}, mark);
+}
+
+void HirLowering::lowerStatement(const BaseTree &statement) {
+    auto mark = _stack.size();
+    switch (statement.kind) {
+        case NodeKind::TOKEN: {
+            auto token = statement.as<TokenTree>();
+            if (token->type == TokenTree::Type::GOTO_IDENTIFIER) {
+                pushLeaf(HirKind::GOTO, _module.symbols.intern(token->token->getRawValue()), statement.range);
+            } else if (token->type == TokenTree::Type::LABEL) {
+                pushLeaf(HirKind::LABEL, _module.symbols.intern(token->token->getRawValue()), statement.range);
+            } else if (token->token->getRawValue() == *Keyword::BREAK) {
+                pushLeaf(HirKind::BREAK, 0, statement.range);
+            }
+            return;
+        }
+        case NodeKind::LIST: {
+            auto list = statement.as<ListTree>();
+            if (list->type == ListTree::Type::IF_THEN_ELSE) {
+                lowerIf(*list);
+            } else {
+                lowerBlock(*list);
+            }
+            return;
+        }
+        case NodeKind::FOR_LOOP:
+            lowerForLoop(*statement.as<ForLoopTree>());
+            return;
+        case NodeKind::ERROR:
+            return;
+        case NodeKind::BIN:
+            break;
+        default:
+            throw logic_error("Unexpected statement " + statement.getPrintValue());
+    }
+
+    auto bin = statement.as<BinTree>();
+    switch (bin->type) {
+        case BinTree::Type::BINARY_OPERATION:
+            if (bin->op && bin->op->getRawValue() == *Keyword::RETURN) {
+                lowerExpressions(bin->right ? bin->right->as<ListTree>() : nullptr);
+                finish({HirKind::RETURN, 0, 0, 0, 0, 0, statement.range}, mark);
+            } else if (auto left = bin->left->as<ListTree>(); left->type == ListTree::Type::ATTRIBUTE_IDENTIFIER_LIST) {
+                lowerLocalDeclaration(*bin);
+            } else {
+                lowerAssignment(*bin);
+            }
+            return;
+        case BinTree::Type::FUNCTION_CALL:
+            lowerExpression(*bin->right);
+            return;
+        case BinTree::Type::WHILE_LOOP:
+            lowerExpression(*bin->left);
+            lowerBlock(*bin->right);
+            finish({HirKind::WHILE, 0, 0, 0, 0, 0, statement.range}, mark);
+            return;
+        case BinTree::Type::REPEAT_UNTIL_LOOP:
+            lowerBlock(*bin->right);
+            lowerExpression(*bin->left);
+            finish({HirKind::REPEAT, 0, 0, 0, 0, 0, statement.range}, mark);
+            return;
+        case BinTree::Type::FUNCTION_DEFINITION:
+        case BinTree::Type::LOCAL_FUNCTION_DEFINITION:
+            lowerFunctionDefinition(*bin);
+            return;
+        default:
+            throw logic_error("Unexpected statement " + statement.getPrintValue());
+    }
+}
+
+void HirLowering::lowerLocalDeclaration(const BinTree &statement) {
+    auto mark = _stack.size();
+    const auto &names = statement.left->as<ListTree>()->trees;
+    bool hasClose = false;
+    for (const auto &name: names) {
+        lowerDeclaration(*name);
+        if (_module[_stack.back()].op == static_cast<uint8_t>(Attribute::CLOSE)) {
+            if (hasClose) {
+                reportError(name->range, "multiple to-be-closed variables in local list");
+            }
+            hasClose = true;
+        }
+    }
+    lowerExpressions(statement.right ? statement.right->as<ListTree>() : nullptr);
+    auto split = toSplit(names.size(), statement.range, "local variables");
+    finish({HirKind::LOCAL_DECL, 0, split, 0, 0, 0, statement.range}, mark);
+}
+
+void HirLowering::lowerAssignment(const BinTree &statement) {
+    auto mark = _stack.size();
+    const auto &targets = statement.left->as<ListTree>()->trees;
+    for (const auto &target: targets) {
+        lowerExpression(*target);
+        auto kind = _module[_stack.back()].kind;
+        if (kind != HirKind::NAME && kind != HirKind::INDEX) {
+            reportError(target->range, "cannot assign to " + string(getKindName(kind)));
+        }
+    }
+    lowerExpressions(statement.right ? statement.right->as<ListTree>() : nullptr);
+    auto split = toSplit(targets.size(), statement.range, "assignment targets");
+    finish({HirKind::ASSIGN, 0, split, 0, 0, 0, statement.range}, mark);
+}
+
+void HirLowering::lowerFunctionDefinition(const BinTree &statement) {
+    auto mark = _stack.size();
+    const auto &path = statement.left->as<ListTree>()->trees;
+    auto body = statement.right->as<BinTree>();
+    if (statement.type == BinTree::Type::LOCAL_FUNCTION_DEFINITION) {
+        lowerDeclaration(*path.front());
+        lowerFunction(*body, false, statement.range);
+        finish({HirKind::LOCAL_FUNCTION, 0, 0, 0, 0, 0, statement.range}, mark);
+        return;
+    }
+
+    // function a.b:c() end is a.b.c = function(self) end
+    auto nameMark = _stack.size();
+    auto first = path.front()->as<TokenTree>();
+    pushLeaf(HirKind::NAME, _module.symbols.intern(first->token->getRawValue()), first->range);
+    auto range = first->range;
+    bool isMethod = false;
+    for (size_t i = 1; i < path.size(); ++i) {
+        auto field = path[i]->as<TokenTree>();
+        pushLeaf(HirKind::STRING, _module.symbols.intern(field->token->getRawValue()), field->range);
+        range.cover(field->range);
+        finish({HirKind::INDEX, 0, 0, 0, 0, 0, range}, nameMark);
+        isMethod = field->type == TokenTree::Type::COLON_IDENTIFIER;
+    }
+    lowerFunction(*body, isMethod, statement.range);
+    finish({HirKind::ASSIGN, 0, 1, 0, 0, 0, statement.range}, mark);
+}
+
+void HirLowering::lowerForLoop(const ForLoopTree &statement) {
+    auto mark = _stack.size();
+    const auto &names = statement.identifierList->trees;
+    const auto &expressions = statement.expList->trees;
+    if (statement.op->getRawValue() == *Keyword::IN) {
+        for (const auto &name: names) {
+            lowerDeclaration(*name);
+        }
+        lowerExpressions(statement.expList.get());
+        lowerBlock(*statement.block);
+        auto split = toSplit(names.size(), statement.range, "loop variables");
+        finish({HirKind::GENERIC_FOR, 0, split, 0, 0, 0, statement.range}, mark);
+        return;
+    }
+
+    if (names.size() != 1) {
+        reportError(statement.identifierList->range, "numeric for has a single control variable");
+    }
+    if (expressions.size() < 2 || expressions.size() > 3) {
+        reportError(statement.expList->range, "numeric for has a start, a limit and an optional step");
+    }
+    lowerDeclaration(*names.front());
+    lowerExpression(*expressions.front());
+    if (expressions.size() > 1) {
+        lowerExpression(*expressions[1]);
+    } else {
+        pushLeaf(HirKind::NIL, 0, statement.expList->range);
+    }
+    if (expressions.size() > 2) {
+        lowerExpression(*expressions[2]);
+    } else {
+        _module.integers.push_back(1);
+        pushLeaf(HirKind::INTEGER, static_cast<uint32_t>(_module.integers.size() - 1), statement.expList->range);
+    }
+    lowerBlock(*statement.block);
+    finish({HirKind::NUMERIC_FOR, 0, 1, 0, 0, 0, statement.range}, mark);
+}
+
+void HirLowering::lowerIf(const ListTree &statement) {
+    auto mark = _stack.size();
+    for (const auto &branch: statement.trees) {
+        auto bin = branch->as<BinTree>();
+        if (bin->type == BinTree::Type::IF_THEN) {
+            lowerExpression(*bin->left);
+        }
+        lowerBlock(*bin->right);
+    }
+    finish({HirKind::IF, 0, 0, 0, 0, 0, statement.range}, mark);
+}
+
+void HirLowering::lowerDeclaration(const BaseTree &name) {
+    auto attribute = Attribute::NONE;
+    auto identifier = name.as<TokenTree>();
+    if (auto attributed = name.as<BinTree>()) {
+        identifier = attributed->left->as<TokenTree>();
+        auto attributeName = attributed->right->as<TokenTree>()->token->getRawValue();
+        if (attributeName == "const") {
+            attribute = Attribute::CONST;
+        } else if (attributeName == "close") {
+            attribute = Attribute::CLOSE;
+        } else {
+            reportError(attributed->right->range, "unknown attribute '" + attributeName + "'");
+        }
+    }
+    auto symbol = _module.symbols.intern(identifier->token->getRawValue());
+    finish({HirKind::DECLARATION, static_cast<uint8_t>(attribute), 0, symbol, 0, 0, name.range}, _stack.size());
+}
+
+void HirLowering::lowerExpressions(const ListTree *expressions) {
+    if (!expressions) {
+        return;
+    }
+    for (const auto &expression: expressions->trees) {
+        lowerExpression(*expression);
+    }
+}
+
+void HirLowering::lowerExpression(const BaseTree &expression) {
+    auto mark = _stack.size();
+    switch (expression.kind) {
+        case NodeKind::BIN: {
+            auto bin = expression.as<BinTree>();
+            if (bin->type == BinTree::Type::FUNCTION_BODY) {
+                lowerFunction(*bin, false, expression.range);
+            } else if (bin->type == BinTree::Type::UNARY_OPERATION) {
+                lowerExpression(*bin->right);
+                finish({HirKind::UNARY, static_cast<uint8_t>(toUnaryOp(*bin->op)), 0, 0, 0, 0, expression.range}, mark);
+            } else if (!bin->op) {
+                // Exponent terms wrap every operand
+                lowerExpression(*bin->left);
+            } else {
+                lowerExpression(*bin->left);
+                lowerExpression(*bin->right);
+                finish({HirKind::BINARY, static_cast<uint8_t>(toBinaryOp(*bin->op)), 0, 0, 0, 0, expression.range}, mark);
+            }
+            return;
+        }
+        case NodeKind::LIST:
+            lowerTable(*expression.as<ListTree>());
+            return;
+        case NodeKind::TOKEN:
+            // The only expression that is a token is '...'
+            pushLeaf(HirKind::VARARG, 0, expression.range);
+            return;
+        case NodeKind::TERM: {
+            auto term = expression.as<TermTree>();
+            if (term->token) {
+                lowerLiteral(*term->token, expression.range);
+            } else {
+                lowerExpression(*term->prefixExpr);
+            }
+            return;
+        }
+        case NodeKind::PREFIX_EXPR: {
+            auto prefixExpr = expression.as<PrefixExprTree>();
+            lowerSuffixedExpression(
+                    prefixExpr->identifier.get(), prefixExpr->expression.get(), prefixExpr->suffixes.get(),
+                    expression.range
+            );
+            return;
+        }
+        case NodeKind::VARIABLE: {
+            auto variable = expression.as<VariableTree>();
+            lowerSuffixedExpression(
+                    variable->identifier.get(), variable->expression.get(), variable->exprSuffixes.get(),
+                    expression.range
+            );
+            return;
+        }
+        default:
+            throw logic_error("Unexpected expression " + expression.getPrintValue());
+    }
+}
+
+void HirLowering::lowerLiteral(const Token &token, const SourceRange &range) {
+    switch (token.getType()) {
+        case TokenType::NUMERIC_DECIMAL:
+            _module.integers.push_back(static_cast<int64_t>(static_cast<const TokenDecimal &>(token).getValue()));
+            pushLeaf(HirKind::INTEGER, static_cast<uint32_t>(_module.integers.size() - 1), range);
+            return;
+        case TokenType::NUMERIC_HEX:
+            _module.integers.push_back(static_cast<int64_t>(static_cast<const TokenHex &>(token).getValue()));
+            pushLeaf(HirKind::INTEGER, static_cast<uint32_t>(_module.integers.size() - 1), range);
+            return;
+        case TokenType::NUMERIC_DOUBLE:
+            _module.floats.push_back(static_cast<double>(static_cast<const TokenDouble &>(token).getValue()));
+            pushLeaf(HirKind::FLOAT, static_cast<uint32_t>(_module.floats.size() - 1), range);
+            return;
+        case TokenType::STRING_LITERAL:
+            pushLeaf(
+                    HirKind::STRING,
+                    _module.symbols.intern(static_cast<const TokenStringLiteral &>(token).getValue()),
+                    range
+            );
+            return;
+        default:
+            break;
+    }
+
+    if (token.getRawValue() == *Keyword::NIL) {
+        pushLeaf(HirKind::NIL, 0, range);
+    } else if (token.getRawValue() == *Keyword::TRUE) {
+        pushLeaf(HirKind::TRUE, 0, range);
+    } else if (token.getRawValue() == *Keyword::FALSE) {
+        pushLeaf(HirKind::FALSE, 0, range);
+    } else {
+        throw logic_error("Unexpected literal " + token.getRawValue());
+    }
+}
+
+void HirLowering::lowerFunction(const BinTree &body, bool isMethod, const SourceRange &range) {
+    auto mark = _stack.size();
+    if (isMethod) {
+        finish({HirKind::DECLARATION, 0, 0, _module.symbols.intern("self"), 0, 0, range}, _stack.size());
+    }
+
+    bool isVararg = false;
+    auto lowerParameter = [&](const BaseTree &parameter) {
+        if (parameter.as<TokenTree>()->type == TokenTree::Type::PARAMETER_LIST) {
+            isVararg = true;
+        } else {
+            lowerDeclaration(parameter);
+        }
+    };
+    if (auto parameters = body.left ? body.left->as<ListTree>() : nullptr) {
+        for (const auto &parameter: parameters->trees) {
+            lowerParameter(*parameter);
+        }
+    } else if (body.left) {
+        lowerParameter(*body.left);
+    }
+
+    auto parametersCount = toSplit(_stack.size() - mark, range, "parameters");
+    lowerBlock(*body.right);
+    finish({HirKind::FUNCTION, static_cast<uint8_t>(isVararg), parametersCount, 0, 0, 0, range}, mark);
+}
+
+void HirLowering::lowerTable(const ListTree &fields) {
+    auto mark = _stack.size();
+    for (const auto &field: fields.trees) {
+        auto declaration = field->as<BinTree>();
+        if (!declaration->left) {
+            // Empty field after a trailing separator
+            continue;
+        }
+        if (!declaration->right) {
+            lowerExpression(*declaration->left);
+            continue;
+        }
+
+        auto fieldMark = _stack.size();
+        auto name = declaration->left->as<TokenTree>();
+        if (name && name->token->getType() == TokenType::IDENTIFIER) {
+            pushLeaf(HirKind::STRING, _module.symbols.intern(name->token->getRawValue()), name->range);
+        } else {
+            lowerExpression(*declaration->left);
+        }
+        lowerExpression(*declaration->right);
+        finish({HirKind::TABLE_FIELD, 0, 0, 0, 0, 0, field->range}, fieldMark);
+    }
+    finish({HirKind::TABLE, 0, 0, 0, 0, 0, fields.range}, mark);
+}
+
+void HirLowering::lowerSuffixedExpression(
+        const Token *identifier,
+        const BaseTree *expression,
+        const ListTree *suffixes,
+        const SourceRange &range
+) {
+    auto mark = _stack.size();
+    auto baseRange = expression ? expression->range : rangeOf(identifier, range);
+    if (expression) {
+        lowerExpression(*expression);
+        if (isMultipleValued(_module[_stack.back()].kind)) {
+            finish({HirKind::PAREN, 0, 0, 0, 0, 0, expression->range}, mark);
+        }
+    } else {
+        pushLeaf(HirKind::NAME, _module.symbols.intern(identifier->getRawValue()), baseRange);
+    }
+
+    if (!suffixes) {
+        return;
+    }
+    auto suffixRange = baseRange;
+    for (const auto &suffix: suffixes->trees) {
+        suffixRange.cover(suffix->range);
+        if (auto index = suffix->as<ExprSuffixTree>()) {
+            if (index->identifier) {
+                pushLeaf(HirKind::STRING, _module.symbols.intern(index->identifier->getValue()), suffix->range);
+            } else {
+                lowerExpression(*index->expression);
+            }
+            finish({HirKind::INDEX, 0, 0, 0, 0, 0, suffixRange}, mark);
+        } else {
+            auto call = suffix->as<FunctionCallSuffixTree>();
+            lowerArguments(*call->argsTree);
+            if (call->identifier) {
+                auto method = _module.symbols.intern(call->identifier->getValue());
+                finish({HirKind::METHOD_CALL, 0, 0, method, 0, 0, suffixRange}, mark);
+            } else {
+                finish({HirKind::CALL, 0, 0, 0, 0, 0, suffixRange}, mark);
+            }
+        }
+    }
+}
+
+void HirLowering::lowerArguments(const ArgsTree &arguments) {
+    if (arguments.stringLiteral) {
+        lowerLiteral(*arguments.stringLiteral, arguments.range);
+    } else if (arguments.listTree->type == ListTree::Type::TABLE_FIELD_LIST) {
+        lowerTable(*arguments.listTree);
+    } else {
+        lowerExpressions(arguments.listTree.get());
+    }
+}
@@ -0,0 +1,109 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_HIRLOWERING_H
+#define AUX_HIRLOWERING_H
+
+#include <vector>
+
+#include "Hir.h"
+#include "Tree.h"
+#include "../exception/Exception.h"
+
+namespace aux::ir::hir {
+
+    /**
+     * Lowers a parse tree of @class parser::Parser to @class HirModule in one walk. Shapes of the parse tree
+     * are decoded once here, so later passes do not have to:
+     * - binary operations over lists become LocalDecl, Assign and Return
+     * - for loops become NumericFor, with an explicit step, or GenericFor
+     * - prefix expressions become chains of Index, Call and MethodCall, a.b is indexed with the string "b"
+     * - function definitions become assignments of functions, methods get an explicit "self" parameter
+     * - parentheses are dropped unless they truncate calls or varargs, ';' is dropped
+     */
+    struct HirLowering {
+        /**
+         * @param chunk statements list of a chunk, error nodes left by error recovery of the parser are skipped
+         * @return module with the main chunk as its root function
+         */
+        HirModule lower(const ast::BaseTree &chunk);
+
+        /**
+         * @return errors found while lowering, e.g. unknown attributes of locals
+         */
+        [[nodiscard]]
+        const std::vector<exception::SemanticException> &getErrors() const;
+
+    private:
+        HirModule _module;
+        // Ids of lowered nodes waiting for their parents, every lower method pushes one id
+        std::vector<NodeId> _stack;
+        std::vector<exception::SemanticException> _errors;
+
+        /**
+         * Adds the node with children pushed since the mark and pushes it instead of them
+         */
+        NodeId finish(HirNode node, size_t mark);
+
+        void pushLeaf(HirKind kind, uint32_t value, const ast::SourceRange &range);
+
+        void reportError(const ast::SourceRange &range, const std::string &message);
+
+        /**
+         * @return count as HirNode::split, reporting an error and clamping it if it does not fit
+         */
+        uint16_t toSplit(size_t count, const ast::SourceRange &range, const std::string &items);
+
+        void lowerBlock(const ast::BaseTree &block);
+
+        /**
+         * Pushes nothing for statements that are dropped, e.g. ';'
+         */
+        void lowerStatement(const ast::BaseTree &statement);
+
+        void lowerLocalDeclaration(const ast::BinTree &statement);
+
+        void lowerAssignment(const ast::BinTree &statement);
+
+        void lowerFunctionDefinition(const ast::BinTree &statement);
+
+        void lowerForLoop(const ast::ForLoopTree &statement);
+
+        void lowerIf(const ast::ListTree &statement);
+
+        /**
+         * Declaration of a local, a parameter or a loop variable: an identifier token, possibly with an attribute
+         */
+        void lowerDeclaration(const ast::BaseTree &name);
+
+        void lowerExpression(const ast::BaseTree &expression);
+
+        /**
+         * Pushes every expression of the list, nothing if it is null
+         */
+        void lowerExpressions(const ast::ListTree *expressions);
+
+        void lowerLiteral(const tokens::Token &token, const ast::SourceRange &range);
+
+        void lowerFunction(const ast::BinTree &body, bool isMethod, const ast::SourceRange &range);
+
+        void lowerTable(const ast::ListTree &fields);
+
+        /**
+         * Prefix expressions and variables: a name or a parenthesized expression followed by suffixes
+         */
+        void lowerSuffixedExpression(
+                const tokens::Token *identifier,
+                const ast::BaseTree *expression,
+                const ast::ListTree *suffixes,
+                const ast::SourceRange &range
+        );
+
+        void lowerArguments(const ast::ArgsTree &arguments);
+
+    };
+
+}
+
+#endif //AUX_HIRLOWERING_H
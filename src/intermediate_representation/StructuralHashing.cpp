@@ -0,0 +1,328 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "StructuralHashing.h"
+
+#include <functional>
+#include <vector>
+
+using namespace aux::ir::ast;
+using namespace aux::ir::tokens;
+using namespace std;
+
+namespace {
+
+    constexpr uint64_t SEED = 0xcbf29ce484222325;
+    constexpr uint64_t ABSENT = 0x9e3779b97f4a7c15;
+
+    inline uint64_t mix(uint64_t hash, uint64_t value) {
+        return hash ^ (value + ABSENT + (hash << 6) + (hash >> 2));
+    }
+
+    uint64_t hashRange(const SourceRange &range) {
+        return mix(mix(mix(mix(range.startRow, range.startColumn), range.endRow), range.endColumn), range.revision);
+    }
+
+    bool equalRanges(const BaseTree &left, const BaseTree &right) {
+        if (&left == &right) {
+            return true;
+        }
+        auto isEqual = [](const SourceRange &first, const SourceRange &second) {
+            return first.startRow == second.startRow && first.startColumn == second.startColumn
+                   && first.endRow == second.endRow && first.endColumn == second.endColumn
+                   && first.revision == second.revision;
+        };
+        if (!isEqual(left.range, right.range)) {
+            return false;
+        }
+        // Subtrees are structurally equal, so their children are at the same indices
+        for (size_t i = 0; i < left.getChildrenCount(); ++i) {
+            auto leftChild = left.getChild(i), rightChild = right.getChild(i);
+            if (leftChild.tree && !equalRanges(*leftChild.tree, *rightChild.tree)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int getSubtype(const BaseTree &tree) {
+        switch (tree.kind) {
+            case NodeKind::BIN:
+                return static_cast<int>(tree.as<BinTree>()->type);
+            case NodeKind::LIST:
+                return static_cast<int>(tree.as<ListTree>()->type);
+            case NodeKind::TOKEN:
+                return static_cast<int>(tree.as<TokenTree>()->type);
+            default:
+                return 0;
+        }
+    }
+
+    /**
+     * Calls onTree with every subtree field and onToken with every token field of the node,
+     * absent ones included, so that fields are told apart by their positions
+     */
+    template<typename OnTree, typename OnToken>
+    void forEachField(const BaseTree &tree, OnTree &&onTree, OnToken &&onToken) {
+        switch (tree.kind) {
+            case NodeKind::BIN: {
+                auto bin = tree.as<BinTree>();
+                onTree(bin->left.get());
+                onTree(bin->right.get());
+                onToken(bin->op.get());
+                break;
+            }
+            case NodeKind::LIST:
+                for (const auto &element: tree.as<ListTree>()->trees) {
+                    onTree(element.get());
+                }
+                break;
+            case NodeKind::TOKEN:
+                onToken(tree.as<TokenTree>()->token.get());
+                break;
+            case NodeKind::ARGS: {
+                auto args = tree.as<ArgsTree>();
+                onTree(args->listTree.get());
+                onToken(args->stringLiteral.get());
+                break;
+            }
+            case NodeKind::FUNCTION_CALL_SUFFIX: {
+                auto call = tree.as<FunctionCallSuffixTree>();
+                onTree(call->argsTree.get());
+                onToken(call->identifier.get());
+                break;
+            }
+            case NodeKind::EXPR_SUFFIX: {
+                auto suffix = tree.as<ExprSuffixTree>();
+                onTree(suffix->expression.get());
+                onToken(suffix->identifier.get());
+                break;
+            }
+            case NodeKind::VARIABLE: {
+                auto variable = tree.as<VariableTree>();
+                onTree(variable->expression.get());
+                onTree(variable->exprSuffixes.get());
+                onToken(variable->identifier.get());
+                break;
+            }
+            case NodeKind::PREFIX_EXPR: {
+                auto prefixExpr = tree.as<PrefixExprTree>();
+                onTree(prefixExpr->expression.get());
+                onTree(prefixExpr->suffixes.get());
+                onToken(prefixExpr->identifier.get());
+                break;
+            }
+            case NodeKind::TERM: {
+                auto term = tree.as<TermTree>();
+                onTree(term->prefixExpr.get());
+                onToken(term->token.get());
+                break;
+            }
+            case NodeKind::FOR_LOOP: {
+                auto forLoop = tree.as<ForLoopTree>();
+                onTree(forLoop->identifierList.get());
+                onTree(forLoop->expList.get());
+                onTree(forLoop->block.get());
+                onToken(forLoop->op.get());
+                break;
+            }
+            case NodeKind::ERROR:
+                onToken(tree.as<ErrorTree>()->token.get());
+                break;
+        }
+    }
+
+    uint64_t hashToken(const Token *token) {
+        if (!token) {
+            return ABSENT;
+        }
+        return mix(static_cast<uint64_t>(token->getType()), std::hash<string>{}(token->getRawValue()));
+    }
+
+    bool equalTokens(const Token *left, const Token *right) {
+        if (!left || !right) {
+            return left == right;
+        }
+        return left == right || (left->getType() == right->getType() && left->getRawValue() == right->getRawValue());
+    }
+
+    using Field = pair<const BaseTree *, const Token *>;
+
+    vector<Field> getFields(const BaseTree &tree) {
+        vector<Field> result;
+        forEachField(tree, [&](const BaseTree *child) {
+            result.emplace_back(child, nullptr);
+        }, [&](const Token *token) {
+            result.emplace_back(nullptr, token);
+        });
+        return result;
+    }
+
+    /**
+     * Names may resolve to different variables at different places, so identifiers are immutable only as
+     * keys of table fields, e.g. x in {x = 1}
+     */
+    bool isFieldName(const BaseTree *tree) {
+        auto token = tree ? tree->as<TokenTree>() : nullptr;
+        return token && token->type == TokenTree::Type::SIMPLE_TOKEN && token->token->getType() == TokenType::IDENTIFIER;
+    }
+
+}
+
+template<typename ChildHash>
+uint64_t StructuralHasher::combine(const BaseTree &tree, ChildHash &&childHash) {
+    auto result = mix(mix(SEED, static_cast<uint64_t>(tree.kind)), static_cast<uint64_t>(getSubtype(tree)));
+    forEachField(tree, [&](const BaseTree *child) {
+        result = mix(result, child ? childHash(*child) : ABSENT);
+    }, [&](const Token *token) {
+        result = mix(result, hashToken(token));
+    });
+    return result;
+}
+
+uint64_t StructuralHasher::hash(const BaseTree &tree) {
+    if (auto cached = _hashes.find(&tree); cached != _hashes.end()) {
+        return cached->second;
+    }
+
+    auto result = combine(tree, [this](const BaseTree &child) {
+        return hash(child);
+    });
+    _hashes.emplace(&tree, result);
+    return result;
+}
+
+bool StructuralHasher::equal(const BaseTree *left, const BaseTree *right) {
+    if (left == right) {
+        return true;
+    }
+    if (!left || !right || left->kind != right->kind || getSubtype(*left) != getSubtype(*right)) {
+        return false;
+    }
+
+    auto leftFields = getFields(*left);
+    auto rightFields = getFields(*right);
+    if (leftFields.size() != rightFields.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < leftFields.size(); ++i) {
+        if (!equal(leftFields[i].first, rightFields[i].first)
+            || !equalTokens(leftFields[i].second, rightFields[i].second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+HashConser::HashConser(bool ignoresRanges) : _ignoresRanges(ignoresRanges) {}
+
+shared_ptr<BaseTree> HashConser::share(const shared_ptr<BaseTree> &tree) {
+    auto result = tree;
+    shareSlot(result);
+    return result;
+}
+
+size_t HashConser::getSharedCount() const {
+    return _sharedCount;
+}
+
+template<typename T>
+bool HashConser::shareSlot(shared_ptr<T> &slot) {
+    if (!slot || !shareChildren(*slot)) {
+        return false;
+    }
+
+    // Children of an immutable tree are shared already, except names of table fields, which are leaves
+    auto hash = StructuralHasher::combine(*slot, [this](const BaseTree &child) {
+        auto shared = _hashes.find(&child);
+        return shared != _hashes.end() ? shared->second : StructuralHasher{}.hash(child);
+    });
+
+    auto key = _ignoresRanges ? hash : mix(hash, hashRange(slot->range));
+    auto [begin, end] = _shared.equal_range(key);
+    for (auto candidate = begin; candidate != end; ++candidate) {
+        if (StructuralHasher::equal(candidate->second.get(), slot.get())
+            && (_ignoresRanges || equalRanges(*candidate->second, *slot))) {
+            if (candidate->second != slot) {
+                slot = static_pointer_cast<T>(candidate->second);
+                ++_sharedCount;
+            }
+            return true;
+        }
+    }
+
+    _hashes.emplace(slot.get(), hash);
+    _shared.emplace(key, slot);
+    return true;
+}
+
+bool HashConser::shareChildren(BaseTree &tree) {
+    switch (tree.kind) {
+        case NodeKind::BIN: {
+            auto bin = tree.as<BinTree>();
+            bool isLeftImmutable = shareSlot(bin->left);
+            bool isRightImmutable = shareSlot(bin->right);
+            switch (bin->type) {
+                case BinTree::Type::BINARY_OPERATION:
+                case BinTree::Type::UNARY_OPERATION:
+                    // Statements, e.g. assignments, are binary operations over lists, which are never immutable
+                    return (!bin->left || isLeftImmutable) && (!bin->right || isRightImmutable);
+                case BinTree::Type::TABLE_FIELD_DECLARATION:
+                    return (!bin->left || isLeftImmutable || isFieldName(bin->left.get()))
+                           && (!bin->right || isRightImmutable);
+                default:
+                    return false;
+            }
+        }
+        case NodeKind::LIST: {
+            auto list = tree.as<ListTree>();
+            bool isImmutable = list->type == ListTree::Type::TABLE_FIELD_LIST;
+            for (auto &element: list->trees) {
+                isImmutable &= shareSlot(element);
+            }
+            return isImmutable;
+        }
+        case NodeKind::TOKEN: {
+            auto token = tree.as<TokenTree>();
+            return token->type == TokenTree::Type::SIMPLE_TOKEN && token->token
+                   && token->token->getRawValue() == *Operator::DOT_DOT_DOT;
+        }
+        case NodeKind::ARGS:
+            shareSlot(tree.as<ArgsTree>()->listTree);
+            return false;
+        case NodeKind::FUNCTION_CALL_SUFFIX:
+            shareSlot(tree.as<FunctionCallSuffixTree>()->argsTree);
+            return false;
+        case NodeKind::EXPR_SUFFIX:
+            shareSlot(tree.as<ExprSuffixTree>()->expression);
+            return false;
+        case NodeKind::VARIABLE: {
+            auto variable = tree.as<VariableTree>();
+            shareSlot(variable->expression);
+            shareSlot(variable->exprSuffixes);
+            return false;
+        }
+        case NodeKind::PREFIX_EXPR: {
+            // Only parenthesized expressions without suffixes, names and calls are not immutable
+            auto prefixExpr = tree.as<PrefixExprTree>();
+            bool isImmutable = shareSlot(prefixExpr->expression);
+            shareSlot(prefixExpr->suffixes);
+            return isImmutable && (!prefixExpr->suffixes || prefixExpr->suffixes->trees.empty());
+        }
+        case NodeKind::TERM: {
+            auto term = tree.as<TermTree>();
+            return term->token || shareSlot(term->prefixExpr);
+        }
+        case NodeKind::FOR_LOOP: {
+            auto forLoop = tree.as<ForLoopTree>();
+            shareSlot(forLoop->identifierList);
+            shareSlot(forLoop->expList);
+            shareSlot(forLoop->block);
+            return false;
+        }
+        case NodeKind::ERROR:
+            return false;
+    }
+    return false;
+}
@@ -0,0 +1,93 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_STRUCTURALHASHING_H
+#define AUX_STRUCTURALHASHING_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "Tree.h"
+
+namespace aux::ir::ast {
+
+    /**
+     * Hashes of subtrees that depend only on their structure: kinds and types of nodes, types and raw values
+     * of tokens, and positions of absent fields. Spans and ranges are ignored, so equal code at different places
+     * has equal hashes, e.g. to find common subexpressions. Hashes are cached by node, so the tree must not change
+     * while the hasher is used
+     */
+    struct StructuralHasher {
+        /**
+         * Hashes every subtree of the tree bottom-up in one pass, subtrees hashed before are not visited again
+         */
+        uint64_t hash(const BaseTree &tree);
+
+        /**
+         * Compares subtrees field by field, nodes shared by both are not descended into
+         */
+        static bool equal(const BaseTree *left, const BaseTree *right);
+
+    private:
+        friend struct HashConser;
+
+        std::unordered_map<const BaseTree *, uint64_t> _hashes;
+
+        /**
+         * Hash of the node given hashes of its child subtrees
+         */
+        template<typename ChildHash>
+        static uint64_t combine(const BaseTree &tree, ChildHash &&childHash);
+
+    };
+
+    /**
+     * Hash-consing: replaces every immutable subtree with the first structurally equal one met before,
+     * so repeated literals, pure expressions and constant table constructors are stored once.
+     * Shared subtrees have several parents, passes that annotate nodes must tolerate that.
+     * Names are never shared, as they may resolve to different variables, neither are function bodies.
+     * A node has a single range, so by default only subtrees at the same range are shared, which keeps ranges
+     * of parsed trees exact and shares trees without ranges, e.g. built by passes
+     */
+    struct HashConser {
+        /**
+         * @param ignoresRanges share structurally equal subtrees wherever they are, the shared ones keep the range
+         * of their first occurrence. Only for trees whose positions are not used afterwards, e.g. to measure memory
+         */
+        explicit HashConser(bool ignoresRanges = false);
+
+        /**
+         * Shares subtrees of the tree, both with each other and with subtrees of the trees shared before
+         * @return the same tree, or the shared one if the whole tree is immutable
+         */
+        std::shared_ptr<BaseTree> share(const std::shared_ptr<BaseTree> &tree);
+
+        /**
+         * @return number of subtrees replaced with shared ones
+         */
+        [[nodiscard]]
+        size_t getSharedCount() const;
+
+    private:
+        // Shared subtrees are kept alive by the table, so their addresses identify them
+        std::unordered_multimap<uint64_t, std::shared_ptr<BaseTree>> _shared;
+        std::unordered_map<const BaseTree *, uint64_t> _hashes;
+        size_t _sharedCount{0};
+        bool _ignoresRanges;
+
+        /**
+         * Shares children of the tree, then the tree in the slot if it is immutable
+         * @return whether the tree is immutable
+         */
+        template<typename T>
+        bool shareSlot(std::shared_ptr<T> &slot);
+
+        bool shareChildren(BaseTree &tree);
+
+    };
+
+}
+
+#endif //AUX_STRUCTURALHASHING_H
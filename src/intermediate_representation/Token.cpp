@@ -77,6 +77,14 @@ Span Token::getSpan() const {
     return this->_span;
 }
 
+uint32_t Token::getRevision() const {
+    return this->_revision;
+}
+
+void Token::setRevision(uint32_t revision) {
+    this->_revision = revision;
+}
+
 TokenType TokenIdentifier::getType() const {
     return TokenType::IDENTIFIER;
 }
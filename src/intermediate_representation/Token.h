@@ -142,6 +142,15 @@ namespace aux::ir::tokens {
         [[nodiscard]]
         Span getSpan() const;
 
+        /**
+         * Number of source edits applied before the token was scanned, spans of older tokens
+         * are translated lazily by @class parser::IncrementalParser
+         */
+        [[nodiscard]]
+        uint32_t getRevision() const;
+
+        void setRevision(uint32_t revision);
+
         [[nodiscard]]
         virtual TokenType getType() const = 0;
 
@@ -149,6 +158,7 @@ namespace aux::ir::tokens {
 
     private:
         const Span _span;
+        uint32_t _revision{0};
 
     };
 
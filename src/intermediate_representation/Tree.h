@@ -5,23 +5,255 @@
 #ifndef AUX_TREE_H
 #define AUX_TREE_H
 
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
 #include <memory>
 #include <utility>
+#include <vector>
 #include "Token.h"
 
 namespace aux::ir::ast {
 
+    /**
+     * Concrete type of a node, so that passes dispatch with a switch instead of RTTI, see TreeVisitor.h
+     */
+    enum class NodeKind : uint8_t {
+        BIN,
+        LIST,
+        TOKEN,
+        ARGS,
+        FUNCTION_CALL_SUFFIX,
+        EXPR_SUFFIX,
+        VARIABLE,
+        PREFIX_EXPR,
+        TERM,
+        FOR_LOOP,
+        ERROR
+    };
+
+    struct BaseTree;
+
+    /**
+     * Positions of the first and the last token of a node, both are starts of tokens as in tokens::Span.
+     * Revision is the one of the tokens, so that @class parser::IncrementalParser can translate the range
+     * after edits. Rows start at 1, a range with row 0 is unknown, e.g. for trees not built by the parser
+     */
+    struct SourceRange {
+        uint16_t startRow{0};
+        uint16_t startColumn{0};
+        uint16_t endRow{0};
+        uint16_t endColumn{0};
+        uint32_t revision{0};
+
+        static inline SourceRange of(const tokens::Token &token) {
+            auto span = token.getSpan();
+            return {span.row, span.column, span.row, span.column, token.getRevision()};
+        }
+
+        inline explicit operator bool() const {
+            return startRow != 0;
+        }
+
+        [[nodiscard]]
+        inline tokens::Span getStart() const {
+            return {startRow, startColumn};
+        }
+
+        [[nodiscard]]
+        inline tokens::Span getEnd() const {
+            return {endRow, endColumn};
+        }
+
+        [[nodiscard]]
+        inline bool startsBefore(const SourceRange &other) const {
+            return std::pair{startRow, startColumn} < std::pair{other.startRow, other.startColumn};
+        }
+
+        /**
+         * Extends the range to include the other one, unknown ranges are ignored
+         */
+        inline void cover(const SourceRange &other) {
+            if (!other) {
+                return;
+            }
+            if (!*this) {
+                *this = other;
+                return;
+            }
+            if (other.startsBefore(*this)) {
+                startRow = other.startRow, startColumn = other.startColumn;
+            }
+            if (std::pair{other.endRow, other.endColumn} > std::pair{endRow, endColumn}) {
+                endRow = other.endRow, endColumn = other.endColumn;
+            }
+            revision = std::max(revision, other.revision);
+        }
+    };
+
+    /**
+     * Child of a node, either a subtree or a token stored in the node directly, e.g. identifier of a variable
+     */
+    struct TreeChild {
+        BaseTree *tree{nullptr};
+        tokens::Token *token{nullptr};
+
+        inline explicit operator bool() const {
+            return tree || token;
+        }
+    };
+
     struct BaseTree {
 
-        virtual std::string getPrintValue() = 0;
+        const NodeKind kind;
+
+        /**
+         * Filled by @class parser::Parser. Subtrees shared by a @class HashConser ignoring ranges keep the range
+         * of their first occurrence
+         */
+        SourceRange range;
+
+        explicit BaseTree(NodeKind kind) : kind(kind) {}
+
+        /**
+         * @return the node as T if it is one, e.g. tree->as<BinTree>(), checked by kind instead of dynamic_cast
+         */
+        template<typename T>
+        inline T *as() {
+            return kind == T::KIND ? static_cast<T *>(this) : nullptr;
+        }
 
+        template<typename T>
+        inline const T *as() const {
+            return kind == T::KIND ? static_cast<const T *>(this) : nullptr;
+        }
+
+        [[nodiscard]]
+        virtual std::string getPrintValue() const = 0;
+
+        /**
+         * Binary view of the node, may allocate wrappers, e.g. chains of LIST_ELEM for lists.
+         * Prefer @function getChild for traversals
+         */
         virtual std::shared_ptr<BaseTree> getLeft() = 0;
 
         virtual std::shared_ptr<BaseTree> getRight() = 0;
 
+        /**
+         * @return number of children in the same order as @function getLeft and @function getRight show them.
+         * Null fields are skipped, but null elements of lists are kept as empty children to keep indices O(1).
+         * Tokens written into print values (operators and terms) are not children
+         */
+        [[nodiscard]]
+        virtual size_t getChildrenCount() const = 0;
+
+        /**
+         * Never allocates, index is below @function getChildrenCount
+         */
+        [[nodiscard]]
+        virtual TreeChild getChild(size_t index) const = 0;
+
+        template<typename Visitor>
+        inline void forEachChild(Visitor &&visitor) const {
+            for (size_t i = 0, count = getChildrenCount(); i < count; ++i) {
+                visitor(getChild(i));
+            }
+        }
+
+        virtual ~BaseTree() = default;
+
+        /**
+         * Empty lists are positioned at the token following them and do not extend ranges of their parents
+         */
+        static inline bool isEmptyList(const BaseTree &tree) {
+            return tree.kind == NodeKind::LIST && tree.getChildrenCount() == 0;
+        }
+
+    protected:
+        static inline size_t countPresent(std::initializer_list<TreeChild> children) {
+            size_t result = 0;
+            for (const auto &child: children) {
+                result += static_cast<bool>(child);
+            }
+            return result;
+        }
+
+        static inline TreeChild nthPresent(size_t index, std::initializer_list<TreeChild> children) {
+            for (const auto &child: children) {
+                if (child && index-- == 0) {
+                    return child;
+                }
+            }
+            return {};
+        }
+
+        /**
+         * Called by destructors of nodes with their subtrees. Subtrees are handed to the outermost destructor running
+         * on the thread, which releases them in a loop, so that destroying deep trees, e.g. long chains of binary
+         * operations or deeply nested tables, takes constant stack
+         */
+        template<typename... Trees>
+        static inline void releaseChildren(std::shared_ptr<Trees> &... children) {
+            ReleaseScope scope;
+            (scope.defer(children), ...);
+        }
+
+        static inline void releaseChildren(std::vector<std::shared_ptr<BaseTree>> &children) {
+            ReleaseScope scope;
+            for (auto &child: children) {
+                scope.defer(child);
+            }
+        }
+
+    private:
+        struct ReleaseScope {
+            ReleaseScope() : _isOutermost(_released == nullptr) {
+                if (_isOutermost) {
+                    _released = &_trees;
+                }
+            }
+
+            ~ReleaseScope() {
+                if (!_isOutermost) {
+                    return;
+                }
+                while (!_trees.empty()) {
+                    // Destructor of the subtree defers its own children to this loop
+                    auto tree = std::move(_trees.back());
+                    _trees.pop_back();
+                }
+                _released = nullptr;
+            }
+
+            template<typename T>
+            inline void defer(std::shared_ptr<T> &tree) {
+                if (tree) {
+                    _released->push_back(std::move(tree));
+                }
+            }
+
+        private:
+            const bool _isOutermost;
+            std::vector<std::shared_ptr<BaseTree>> _trees;
+        };
+
+        // Pending subtrees of the outermost destructor, trivially destructible as nodes may outlive thread storage
+        static inline thread_local std::vector<std::shared_ptr<BaseTree>> *_released{nullptr};
+
     };
 
+    /**
+     * Counterpart of std::dynamic_pointer_cast checked by kind
+     * @return nullptr if the tree is not a T
+     */
+    template<typename T>
+    inline std::shared_ptr<T> treeCast(const std::shared_ptr<BaseTree> &tree) {
+        return tree && tree->kind == T::KIND ? std::static_pointer_cast<T>(tree) : nullptr;
+    }
+
     struct BinTree : BaseTree {
+        static constexpr NodeKind KIND = NodeKind::BIN;
+
         enum class Type {
             NONE,
             TABLE_FIELD_DECLARATION,
@@ -44,36 +276,24 @@ namespace aux::ir::ast {
         std::shared_ptr<BaseTree> right;
         std::shared_ptr<tokens::Token> op;
 
-        BinTree() = default;
+        BinTree() : BaseTree(KIND) {}
 
-        explicit BinTree(const Type type) : type(type) {}
+        explicit BinTree(const Type type) : BaseTree(KIND), type(type) {}
 
         BinTree(
                 Type type,
                 std::shared_ptr<BaseTree> left,
                 std::shared_ptr<BaseTree> right,
                 std::shared_ptr<tokens::Token> op
-        ) : type(type), left(std::move(left)), right(std::move(right)), op(std::move(op)) {}
-
-        inline std::string getPrintValue() override {
-            static std::unordered_map<Type, std::string> types = {
-                    {Type::NONE,                      "None"},
-                    {Type::TABLE_FIELD_DECLARATION,   "Table Field Declaration"},
-                    {Type::BINARY_OPERATION,          "Binary Operation"},
-                    {Type::UNARY_OPERATION,           "Unary Operation"},
-                    {Type::ATTRIBUTE_IDENTIFIER,      "Attribute Identifier"},
-                    {Type::LIST_ELEM,                 "List Element"},
-                    {Type::FUNCTION_BODY,             "Function Body"},
-                    {Type::FUNCTION_DEFINITION,       "Function Definition"},
-                    {Type::LOCAL_FUNCTION_DEFINITION, "Local Function Definition"},
-                    {Type::WHILE_LOOP,                "While Loop"},
-                    {Type::REPEAT_UNTIL_LOOP,         "Repeat Until Loop"},
-                    {Type::IF_THEN,                   "If/Elseif Branch"},
-                    {Type::ELSE,                      "Else"},
-                    {Type::FUNCTION_CALL,             "Function Call"}
-            };
-
-            std::string result = types[type];
+        ) : BaseTree(KIND), type(type), left(std::move(left)), right(std::move(right)), op(std::move(op)) {}
+
+        ~BinTree() override {
+            releaseChildren(left, right);
+        }
+
+        [[nodiscard]]
+        inline std::string getPrintValue() const override {
+            std::string result = getTypeName(type);
 
             if (op) {
                 result += "\n[  " + op->getRawValue() + "  ]";
@@ -82,6 +302,40 @@ namespace aux::ir::ast {
             return result;
         }
 
+        static constexpr const char *getTypeName(Type type) {
+            switch (type) {
+                case Type::NONE:
+                    return "None";
+                case Type::TABLE_FIELD_DECLARATION:
+                    return "Table Field Declaration";
+                case Type::BINARY_OPERATION:
+                    return "Binary Operation";
+                case Type::UNARY_OPERATION:
+                    return "Unary Operation";
+                case Type::ATTRIBUTE_IDENTIFIER:
+                    return "Attribute Identifier";
+                case Type::LIST_ELEM:
+                    return "List Element";
+                case Type::FUNCTION_BODY:
+                    return "Function Body";
+                case Type::FUNCTION_DEFINITION:
+                    return "Function Definition";
+                case Type::LOCAL_FUNCTION_DEFINITION:
+                    return "Local Function Definition";
+                case Type::WHILE_LOOP:
+                    return "While Loop";
+                case Type::REPEAT_UNTIL_LOOP:
+                    return "Repeat Until Loop";
+                case Type::IF_THEN:
+                    return "If/Elseif Branch";
+                case Type::ELSE:
+                    return "Else";
+                case Type::FUNCTION_CALL:
+                    return "Function Call";
+            }
+            return "";
+        }
+
         inline std::shared_ptr<BaseTree> getLeft() override {
             return left;
         }
@@ -90,9 +344,21 @@ namespace aux::ir::ast {
             return right;
         }
 
+        [[nodiscard]]
+        inline size_t getChildrenCount() const override {
+            return countPresent({{left.get()}, {right.get()}});
+        }
+
+        [[nodiscard]]
+        inline TreeChild getChild(size_t index) const override {
+            return nthPresent(index, {{left.get()}, {right.get()}});
+        }
+
     };
 
     struct ListTree : BaseTree {
+        static constexpr NodeKind KIND = NodeKind::LIST;
+
         enum class Type {
             NONE,
             TABLE_FIELD_LIST,
@@ -109,31 +375,57 @@ namespace aux::ir::ast {
         const Type type{Type::NONE};
         std::vector<std::shared_ptr<BaseTree>> trees;
 
-        ListTree() = default;
+        ListTree() : BaseTree(KIND) {}
 
-        explicit ListTree(Type type) : type(type) {}
+        explicit ListTree(Type type) : BaseTree(KIND), type(type) {}
 
-        explicit ListTree(std::vector<std::shared_ptr<BaseTree>> trees) : trees(std::move(trees)) {}
+        explicit ListTree(std::vector<std::shared_ptr<BaseTree>> trees) : BaseTree(KIND), trees(std::move(trees)) {}
 
         inline void pushBack(const std::shared_ptr<BaseTree> &tree) {
+            bool wasEmpty = trees.empty();
             trees.push_back(tree);
+            if (tree && !isEmptyList(*tree)) {
+                if (wasEmpty) {
+                    range = tree->range;
+                } else {
+                    range.cover(tree->range);
+                }
+            }
+        }
+
+        ~ListTree() override {
+            releaseChildren(trees);
         }
 
-        inline std::string getPrintValue() override {
-            static std::unordered_map<Type, std::string> types = {
-                    {Type::NONE,                         "None List"},
-                    {Type::EXPRESSION_LIST,              "Expression List"},
-                    {Type::TABLE_FIELD_LIST,             "Table Field List"},
-                    {Type::PE_SUFFIX_LIST,               "Prefix Expression\nSuffix List"},
-                    {Type::IDENTIFIER_LIST,              "Identifier List"},
-                    {Type::VARIABLE_LIST,                "Variable List"},
-                    {Type::ATTRIBUTE_IDENTIFIER_LIST,    "Attributed Identifier List"},
-                    {Type::FUNCTION_IDENTIFIER_SEQUENCE, "Function Identifier Sequence"},
-                    {Type::STATEMENTS_LIST,              "Statements List"},
-                    {Type::IF_THEN_ELSE,                 "If-Else Statement"}
-            };
+        [[nodiscard]]
+        inline std::string getPrintValue() const override {
+            return getTypeName(type);
+        }
 
-            return types[type];
+        static constexpr const char *getTypeName(Type type) {
+            switch (type) {
+                case Type::NONE:
+                    return "None List";
+                case Type::EXPRESSION_LIST:
+                    return "Expression List";
+                case Type::TABLE_FIELD_LIST:
+                    return "Table Field List";
+                case Type::PE_SUFFIX_LIST:
+                    return "Prefix Expression\nSuffix List";
+                case Type::IDENTIFIER_LIST:
+                    return "Identifier List";
+                case Type::VARIABLE_LIST:
+                    return "Variable List";
+                case Type::ATTRIBUTE_IDENTIFIER_LIST:
+                    return "Attributed Identifier List";
+                case Type::FUNCTION_IDENTIFIER_SEQUENCE:
+                    return "Function Identifier Sequence";
+                case Type::STATEMENTS_LIST:
+                    return "Statements List";
+                case Type::IF_THEN_ELSE:
+                    return "If-Else Statement";
+            }
+            return "";
         }
 
         inline std::shared_ptr<BaseTree> getLeft() override {
@@ -162,9 +454,21 @@ namespace aux::ir::ast {
             return result;
         }
 
+        [[nodiscard]]
+        inline size_t getChildrenCount() const override {
+            return trees.size();
+        }
+
+        [[nodiscard]]
+        inline TreeChild getChild(size_t index) const override {
+            return {trees[index].get()};
+        }
+
     };
 
     struct TokenTree : BaseTree {
+        static constexpr NodeKind KIND = NodeKind::TOKEN;
+
         enum class Type {
             SIMPLE_TOKEN,
             ATTRIBUTE,
@@ -178,21 +482,33 @@ namespace aux::ir::ast {
         const Type type = Type::SIMPLE_TOKEN;
         std::shared_ptr<tokens::Token> token;
 
-        explicit TokenTree(std::shared_ptr<tokens::Token> token) : token(std::move(token)) {}
+        explicit TokenTree(std::shared_ptr<tokens::Token> token) : BaseTree(KIND), token(std::move(token)) {}
 
-        TokenTree(const Type type, std::shared_ptr<tokens::Token> token) : type(type), token(std::move(token)) {}
+        TokenTree(const Type type, std::shared_ptr<tokens::Token> token) : BaseTree(KIND), type(type), token(std::move(token)) {}
 
-        inline std::string getPrintValue() override {
-            std::unordered_map<Type, std::string> printValues{
-                    {Type::SIMPLE_TOKEN,     "Token"},
-                    {Type::ATTRIBUTE,        "Attribute"},
-                    {Type::PARAMETER_LIST,   "ParameterList"},
-                    {Type::LABEL,            "Label"},
-                    {Type::DOT_IDENTIFIER,   ".Identifier"},
-                    {Type::COLON_IDENTIFIER, ":Identifier"},
-                    {Type::GOTO_IDENTIFIER,  "Goto"}
-            };
-            return "(" + printValues[type] + ", " + *token->getType() + ") : " + token->getRawValue();
+        [[nodiscard]]
+        inline std::string getPrintValue() const override {
+            return "(" + std::string(getTypeName(type)) + ", " + *token->getType() + ") : " + token->getRawValue();
+        }
+
+        static constexpr const char *getTypeName(Type type) {
+            switch (type) {
+                case Type::SIMPLE_TOKEN:
+                    return "Token";
+                case Type::ATTRIBUTE:
+                    return "Attribute";
+                case Type::PARAMETER_LIST:
+                    return "ParameterList";
+                case Type::LABEL:
+                    return "Label";
+                case Type::DOT_IDENTIFIER:
+                    return ".Identifier";
+                case Type::COLON_IDENTIFIER:
+                    return ":Identifier";
+                case Type::GOTO_IDENTIFIER:
+                    return "Goto";
+            }
+            return "";
         }
 
         inline std::shared_ptr<BaseTree> getLeft() override {
@@ -202,19 +518,36 @@ namespace aux::ir::ast {
         inline std::shared_ptr<BaseTree> getRight() override {
             return nullptr;
         }
+
+        [[nodiscard]]
+        inline size_t getChildrenCount() const override {
+            return 0;
+        }
+
+        [[nodiscard]]
+        inline TreeChild getChild(size_t) const override {
+            return {};
+        }
+
     };
 
     struct ArgsTree : BaseTree {
+        static constexpr NodeKind KIND = NodeKind::ARGS;
 
         std::shared_ptr<tokens::TokenStringLiteral> stringLiteral;
         std::shared_ptr<ListTree> listTree;
 
         explicit ArgsTree(std::shared_ptr<tokens::TokenStringLiteral> stringLiteral)
-                : stringLiteral(std::move(stringLiteral)), listTree(nullptr) {}
+                : BaseTree(KIND), stringLiteral(std::move(stringLiteral)), listTree(nullptr) {}
 
-        explicit ArgsTree(std::shared_ptr<ListTree> listTree) : listTree(std::move(listTree)) {}
+        explicit ArgsTree(std::shared_ptr<ListTree> listTree) : BaseTree(KIND), listTree(std::move(listTree)) {}
 
-        inline std::string getPrintValue() override {
+        ~ArgsTree() override {
+            releaseChildren(listTree);
+        }
+
+        [[nodiscard]]
+        inline std::string getPrintValue() const override {
             return "Function Call Arguments";
         }
 
@@ -230,18 +563,35 @@ namespace aux::ir::ast {
             return listTree;
         }
 
+        [[nodiscard]]
+        inline size_t getChildrenCount() const override {
+            return countPresent({{nullptr, stringLiteral.get()}, {listTree.get()}});
+        }
+
+        [[nodiscard]]
+        inline TreeChild getChild(size_t index) const override {
+            return nthPresent(index, {{nullptr, stringLiteral.get()}, {listTree.get()}});
+        }
+
     };
 
     struct FunctionCallSuffixTree : BaseTree {
+        static constexpr NodeKind KIND = NodeKind::FUNCTION_CALL_SUFFIX;
+
         std::shared_ptr<tokens::TokenIdentifier> identifier;
         std::shared_ptr<ArgsTree> argsTree;
 
         explicit FunctionCallSuffixTree(
                 std::shared_ptr<ArgsTree> argsTree,
                 std::shared_ptr<tokens::TokenIdentifier> identifier = nullptr
-        ) : argsTree(std::move(argsTree)), identifier(std::move(identifier)) {}
+        ) : BaseTree(KIND), argsTree(std::move(argsTree)), identifier(std::move(identifier)) {}
 
-        inline std::string getPrintValue() override {
+        ~FunctionCallSuffixTree() override {
+            releaseChildren(argsTree);
+        }
+
+        [[nodiscard]]
+        inline std::string getPrintValue() const override {
             return "Function Call Suffix";
         }
 
@@ -256,19 +606,36 @@ namespace aux::ir::ast {
             return argsTree;
         }
 
+        [[nodiscard]]
+        inline size_t getChildrenCount() const override {
+            return countPresent({{nullptr, identifier.get()}, {argsTree.get()}});
+        }
+
+        [[nodiscard]]
+        inline TreeChild getChild(size_t index) const override {
+            return nthPresent(index, {{nullptr, identifier.get()}, {argsTree.get()}});
+        }
+
     };
 
     struct ExprSuffixTree : BaseTree {
+        static constexpr NodeKind KIND = NodeKind::EXPR_SUFFIX;
+
         std::shared_ptr<BaseTree> expression; // todo Change type of expression after expression created
         std::shared_ptr<tokens::TokenIdentifier> identifier;
 
         explicit ExprSuffixTree(std::shared_ptr<BaseTree> expression)
-                : expression(std::move(expression)), identifier(nullptr) {}
+                : BaseTree(KIND), expression(std::move(expression)), identifier(nullptr) {}
 
         explicit ExprSuffixTree(std::shared_ptr<tokens::TokenIdentifier> identifier)
-                : identifier(std::move(identifier)), expression(nullptr) {}
+                : BaseTree(KIND), identifier(std::move(identifier)), expression(nullptr) {}
+
+        ~ExprSuffixTree() override {
+            releaseChildren(expression);
+        }
 
-        inline std::string getPrintValue() override {
+        [[nodiscard]]
+        inline std::string getPrintValue() const override {
             return "Expression Suffix of " + std::string(expression ? "[Expression]" : ".Identifier");
         }
 
@@ -283,22 +650,39 @@ namespace aux::ir::ast {
             return nullptr;
         }
 
+        [[nodiscard]]
+        inline size_t getChildrenCount() const override {
+            return countPresent({{expression.get()}, {nullptr, identifier.get()}});
+        }
+
+        [[nodiscard]]
+        inline TreeChild getChild(size_t index) const override {
+            return nthPresent(index, {{expression.get()}, {nullptr, identifier.get()}});
+        }
+
     };
 
     struct VariableTree : BaseTree {
+        static constexpr NodeKind KIND = NodeKind::VARIABLE;
+
         std::shared_ptr<tokens::TokenIdentifier> identifier{nullptr};
         std::shared_ptr<BaseTree> expression{nullptr}; // todo change whern expr. is created
         std::shared_ptr<ListTree> exprSuffixes;
 
         VariableTree(std::shared_ptr<BaseTree> expression, std::shared_ptr<ListTree> exprSuffixes)
-                : expression(std::move(expression)), exprSuffixes(std::move(exprSuffixes)) {}
+                : BaseTree(KIND), expression(std::move(expression)), exprSuffixes(std::move(exprSuffixes)) {}
 
         VariableTree(
                 std::shared_ptr<tokens::TokenIdentifier> identifier,
                 std::shared_ptr<ListTree> exprSuffixes
-        ) : identifier(std::move(identifier)), exprSuffixes(std::move(exprSuffixes)) {}
+        ) : BaseTree(KIND), identifier(std::move(identifier)), exprSuffixes(std::move(exprSuffixes)) {}
+
+        ~VariableTree() override {
+            releaseChildren(expression, exprSuffixes);
+        }
 
-        inline std::string getPrintValue() override {
+        [[nodiscard]]
+        inline std::string getPrintValue() const override {
             return "Variable Reference";
         }
 
@@ -313,9 +697,21 @@ namespace aux::ir::ast {
             return exprSuffixes;
         }
 
+        [[nodiscard]]
+        inline size_t getChildrenCount() const override {
+            return countPresent({{nullptr, identifier.get()}, {expression.get()}, {exprSuffixes.get()}});
+        }
+
+        [[nodiscard]]
+        inline TreeChild getChild(size_t index) const override {
+            return nthPresent(index, {{nullptr, identifier.get()}, {expression.get()}, {exprSuffixes.get()}});
+        }
+
     };
 
     struct PrefixExprTree : BaseTree {
+        static constexpr NodeKind KIND = NodeKind::PREFIX_EXPR;
+
         std::shared_ptr<tokens::TokenIdentifier> identifier{nullptr};
         std::shared_ptr<BaseTree> expression{nullptr};
         std::shared_ptr<ListTree> suffixes;
@@ -323,12 +719,17 @@ namespace aux::ir::ast {
         PrefixExprTree(
                 std::shared_ptr<tokens::TokenIdentifier> identifier,
                 std::shared_ptr<ListTree> suffixes
-        ) : identifier(std::move(identifier)), suffixes(std::move(suffixes)) {}
+        ) : BaseTree(KIND), identifier(std::move(identifier)), suffixes(std::move(suffixes)) {}
 
         PrefixExprTree(std::shared_ptr<BaseTree> expression, std::shared_ptr<ListTree> suffixes)
-                : expression(std::move(expression)), suffixes(std::move(suffixes)) {}
+                : BaseTree(KIND), expression(std::move(expression)), suffixes(std::move(suffixes)) {}
+
+        ~PrefixExprTree() override {
+            releaseChildren(expression, suffixes);
+        }
 
-        inline std::string getPrintValue() override {
+        [[nodiscard]]
+        inline std::string getPrintValue() const override {
             return "Prefix Expression";
         }
 
@@ -347,18 +748,40 @@ namespace aux::ir::ast {
             }
         }
 
+        [[nodiscard]]
+        inline size_t getChildrenCount() const override {
+            return countPresent({{nullptr, identifier.get()}, {expression.get()}, {nonEmptySuffixes()}});
+        }
+
+        [[nodiscard]]
+        inline TreeChild getChild(size_t index) const override {
+            return nthPresent(index, {{nullptr, identifier.get()}, {expression.get()}, {nonEmptySuffixes()}});
+        }
+
+    private:
+        [[nodiscard]]
+        inline ListTree *nonEmptySuffixes() const {
+            return suffixes && !suffixes->trees.empty() ? suffixes.get() : nullptr;
+        }
+
     };
 
     struct TermTree : BaseTree {
+        static constexpr NodeKind KIND = NodeKind::TERM;
 
         std::shared_ptr<PrefixExprTree> prefixExpr{nullptr};
         std::shared_ptr<tokens::Token> token{nullptr};
 
-        explicit TermTree(std::shared_ptr<PrefixExprTree> prefixExpr) : prefixExpr(std::move(prefixExpr)) {}
+        explicit TermTree(std::shared_ptr<PrefixExprTree> prefixExpr) : BaseTree(KIND), prefixExpr(std::move(prefixExpr)) {}
 
-        explicit TermTree(std::shared_ptr<tokens::Token> token) : token(std::move(token)) {}
+        explicit TermTree(std::shared_ptr<tokens::Token> token) : BaseTree(KIND), token(std::move(token)) {}
 
-        std::string getPrintValue() override {
+        ~TermTree() override {
+            releaseChildren(prefixExpr);
+        }
+
+        [[nodiscard]]
+        std::string getPrintValue() const override {
             std::string result = "Term";
             if (token) {
                 result += " [" + *token->getType() + " : " + token->getRawValue() + "]";
@@ -374,9 +797,21 @@ namespace aux::ir::ast {
             return prefixExpr;
         }
 
+        [[nodiscard]]
+        size_t getChildrenCount() const override {
+            return prefixExpr ? 1 : 0;
+        }
+
+        [[nodiscard]]
+        TreeChild getChild(size_t) const override {
+            return {prefixExpr.get()};
+        }
+
     };
 
     struct ForLoopTree : BaseTree {
+        static constexpr NodeKind KIND = NodeKind::FOR_LOOP;
+
         std::shared_ptr<ListTree> identifierList;
         std::shared_ptr<ListTree> expList;
         std::shared_ptr<ListTree> block;
@@ -387,9 +822,14 @@ namespace aux::ir::ast {
                 std::shared_ptr<tokens::Token> op,
                 std::shared_ptr<ListTree> expList,
                 std::shared_ptr<ListTree> block
-        ) : identifierList(std::move(identifierList)), expList(std::move(expList)), block(std::move(block)), op(std::move(op)) {}
+        ) : BaseTree(KIND), identifierList(std::move(identifierList)), expList(std::move(expList)), block(std::move(block)), op(std::move(op)) {}
 
-        inline std::string getPrintValue() override {
+        ~ForLoopTree() override {
+            releaseChildren(identifierList, expList, block);
+        }
+
+        [[nodiscard]]
+        inline std::string getPrintValue() const override {
             return "For [" + op->getRawValue() + "] Loop";
         }
 
@@ -401,8 +841,72 @@ namespace aux::ir::ast {
             return block;
         }
 
+        [[nodiscard]]
+        inline size_t getChildrenCount() const override {
+            return countPresent({{identifierList.get()}, {expList.get()}, {block.get()}});
+        }
+
+        [[nodiscard]]
+        inline TreeChild getChild(size_t index) const override {
+            return nthPresent(index, {{identifierList.get()}, {expList.get()}, {block.get()}});
+        }
+
     };
 
+    /**
+     * Placeholder for a statement that could not be parsed, token is the one at which the error was detected
+     */
+    struct ErrorTree : BaseTree {
+        static constexpr NodeKind KIND = NodeKind::ERROR;
+
+        std::shared_ptr<tokens::Token> token;
+
+        explicit ErrorTree(std::shared_ptr<tokens::Token> token) : BaseTree(KIND), token(std::move(token)) {}
+
+        [[nodiscard]]
+        inline std::string getPrintValue() const override {
+            return "Syntax Error at [" + token->getRawValue() + "]";
+        }
+
+        inline std::shared_ptr<BaseTree> getLeft() override {
+            return nullptr;
+        }
+
+        inline std::shared_ptr<BaseTree> getRight() override {
+            return nullptr;
+        }
+
+        [[nodiscard]]
+        inline size_t getChildrenCount() const override {
+            return 0;
+        }
+
+        [[nodiscard]]
+        inline TreeChild getChild(size_t) const override {
+            return {};
+        }
+
+    };
+
+    /**
+     * @return token kept by the node itself rather than as a child, e.g. operator of a BinTree
+     */
+    inline tokens::Token *getOwnToken(const BaseTree &tree) {
+        switch (tree.kind) {
+            case NodeKind::BIN:
+                return tree.as<BinTree>()->op.get();
+            case NodeKind::TOKEN:
+                return tree.as<TokenTree>()->token.get();
+            case NodeKind::TERM:
+                return tree.as<TermTree>()->token.get();
+            case NodeKind::FOR_LOOP:
+                return tree.as<ForLoopTree>()->op.get();
+            case NodeKind::ERROR:
+                return tree.as<ErrorTree>()->token.get();
+            default:
+                return nullptr;
+        }
+    }
 
 }
 
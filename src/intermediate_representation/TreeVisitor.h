@@ -0,0 +1,126 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_TREEVISITOR_H
+#define AUX_TREEVISITOR_H
+
+#include <type_traits>
+
+#include "Tree.h"
+
+namespace aux::ir::ast {
+
+    /**
+     * Statically dispatched visitor: @function visit switches on the kind of the node and calls the typed
+     * visit method of Derived, which hides the ones it handles. Unhandled kinds go to visitTree,
+     * so a pass overrides only the nodes it cares about:
+     *
+     * struct CallsCounter : TreeVisitor<CallsCounter, size_t> {
+     *     size_t visitTree(BaseTree &tree);
+     *     size_t visitBin(Node<BinTree> &tree);
+     * };
+     *
+     * Passes that only read the tree derive from ConstTreeVisitor and take nodes by const references,
+     * so they can run over a @class FrozenTree
+     */
+    template<typename Derived, typename Result = void, bool IsConst = false>
+    struct TreeVisitor {
+        template<typename T>
+        using Node = std::conditional_t<IsConst, const T, T>;
+
+        inline Result visit(Node<BaseTree> &tree) {
+            auto &derived = static_cast<Derived &>(*this);
+            switch (tree.kind) {
+                case NodeKind::BIN:
+                    return derived.visitBin(static_cast<Node<BinTree> &>(tree));
+                case NodeKind::LIST:
+                    return derived.visitList(static_cast<Node<ListTree> &>(tree));
+                case NodeKind::TOKEN:
+                    return derived.visitToken(static_cast<Node<TokenTree> &>(tree));
+                case NodeKind::ARGS:
+                    return derived.visitArgs(static_cast<Node<ArgsTree> &>(tree));
+                case NodeKind::FUNCTION_CALL_SUFFIX:
+                    return derived.visitFunctionCallSuffix(static_cast<Node<FunctionCallSuffixTree> &>(tree));
+                case NodeKind::EXPR_SUFFIX:
+                    return derived.visitExprSuffix(static_cast<Node<ExprSuffixTree> &>(tree));
+                case NodeKind::VARIABLE:
+                    return derived.visitVariable(static_cast<Node<VariableTree> &>(tree));
+                case NodeKind::PREFIX_EXPR:
+                    return derived.visitPrefixExpr(static_cast<Node<PrefixExprTree> &>(tree));
+                case NodeKind::TERM:
+                    return derived.visitTerm(static_cast<Node<TermTree> &>(tree));
+                case NodeKind::FOR_LOOP:
+                    return derived.visitForLoop(static_cast<Node<ForLoopTree> &>(tree));
+                case NodeKind::ERROR:
+                    return derived.visitError(static_cast<Node<ErrorTree> &>(tree));
+            }
+            return derived.visitTree(tree);
+        }
+
+        /**
+         * Visits every child subtree in order, tokens stored in nodes are skipped
+         */
+        inline void visitChildren(Node<BaseTree> &tree) {
+            tree.forEachChild([this](const TreeChild &child) {
+                if (child.tree) {
+                    visit(*child.tree);
+                }
+            });
+        }
+
+        inline Result visitTree(Node<BaseTree> &) {
+            return Result();
+        }
+
+        inline Result visitBin(Node<BinTree> &tree) {
+            return static_cast<Derived &>(*this).visitTree(tree);
+        }
+
+        inline Result visitList(Node<ListTree> &tree) {
+            return static_cast<Derived &>(*this).visitTree(tree);
+        }
+
+        inline Result visitToken(Node<TokenTree> &tree) {
+            return static_cast<Derived &>(*this).visitTree(tree);
+        }
+
+        inline Result visitArgs(Node<ArgsTree> &tree) {
+            return static_cast<Derived &>(*this).visitTree(tree);
+        }
+
+        inline Result visitFunctionCallSuffix(Node<FunctionCallSuffixTree> &tree) {
+            return static_cast<Derived &>(*this).visitTree(tree);
+        }
+
+        inline Result visitExprSuffix(Node<ExprSuffixTree> &tree) {
+            return static_cast<Derived &>(*this).visitTree(tree);
+        }
+
+        inline Result visitVariable(Node<VariableTree> &tree) {
+            return static_cast<Derived &>(*this).visitTree(tree);
+        }
+
+        inline Result visitPrefixExpr(Node<PrefixExprTree> &tree) {
+            return static_cast<Derived &>(*this).visitTree(tree);
+        }
+
+        inline Result visitTerm(Node<TermTree> &tree) {
+            return static_cast<Derived &>(*this).visitTree(tree);
+        }
+
+        inline Result visitForLoop(Node<ForLoopTree> &tree) {
+            return static_cast<Derived &>(*this).visitTree(tree);
+        }
+
+        inline Result visitError(Node<ErrorTree> &tree) {
+            return static_cast<Derived &>(*this).visitTree(tree);
+        }
+    };
+
+    template<typename Derived, typename Result = void>
+    using ConstTreeVisitor = TreeVisitor<Derived, Result, true>;
+
+}
+
+#endif //AUX_TREEVISITOR_H
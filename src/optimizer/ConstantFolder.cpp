@@ -0,0 +1,528 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "ConstantFolder.h"
+
+#include <cmath>
+
+using namespace aux::optimizer;
+using namespace aux::ir::hir;
+using namespace aux::semantic;
+using namespace std;
+
+namespace {
+
+    // 2^63, the first float that does not fit int64_t
+    constexpr double INTEGER_LIMIT = 9223372036854775808.0;
+
+    Constant makeInteger(int64_t value) {
+        return {.kind = HirKind::INTEGER, .integer = value};
+    }
+
+    Constant makeBoolean(bool value) {
+        return {.kind = value ? HirKind::TRUE : HirKind::FALSE};
+    }
+
+    bool isNumber(const Constant &constant) {
+        return constant.kind == HirKind::INTEGER || constant.kind == HirKind::FLOAT;
+    }
+
+    double toFloat(const Constant &constant) {
+        return constant.kind == HirKind::INTEGER ? static_cast<double>(constant.integer) : constant.number;
+    }
+
+    /**
+     * Integers and floats with exact integer values, as bitwise operations of Lua accept them
+     */
+    optional<int64_t> toInteger(const Constant &constant) {
+        if (constant.kind == HirKind::INTEGER) {
+            return constant.integer;
+        }
+        if (constant.kind == HirKind::FLOAT && floor(constant.number) == constant.number
+            && constant.number >= -INTEGER_LIMIT && constant.number < INTEGER_LIMIT) {
+            return static_cast<int64_t>(constant.number);
+        }
+        return nullopt;
+    }
+
+    /**
+     * Float results are not folded into NaN, which is not equal to itself, or into zero, which may be -0.0
+     */
+    optional<Constant> makeFloat(double value) {
+        if (isnan(value) || value == 0) {
+            return nullopt;
+        }
+        return Constant{.kind = HirKind::FLOAT, .number = value};
+    }
+
+    int64_t wrap(uint64_t value) {
+        return static_cast<int64_t>(value);
+    }
+
+    int64_t shiftLeft(int64_t value, int64_t shift) {
+        if (shift <= -64 || shift >= 64) {
+            return 0;
+        }
+        if (shift < 0) {
+            return wrap(static_cast<uint64_t>(value) >> -shift);
+        }
+        return wrap(static_cast<uint64_t>(value) << shift);
+    }
+
+    /**
+     * Compares an integer with a float without rounding the integer
+     * @return -1, 0 or 1, nullopt if the float is NaN
+     */
+    optional<int> compare(int64_t left, double right) {
+        if (isnan(right)) {
+            return nullopt;
+        }
+        if (right >= INTEGER_LIMIT) {
+            return -1;
+        }
+        if (right < -INTEGER_LIMIT) {
+            return 1;
+        }
+        auto floored = floor(right);
+        auto integral = static_cast<int64_t>(floored);
+        if (left != integral) {
+            return left < integral ? -1 : 1;
+        }
+        return floored == right ? 0 : -1;
+    }
+
+    optional<int> compareNumbers(const Constant &left, const Constant &right) {
+        if (left.kind == HirKind::INTEGER && right.kind == HirKind::INTEGER) {
+            return left.integer < right.integer ? -1 : left.integer > right.integer ? 1 : 0;
+        }
+        if (left.kind == HirKind::INTEGER) {
+            return compare(left.integer, right.number);
+        }
+        if (right.kind == HirKind::INTEGER) {
+            auto result = compare(right.integer, left.number);
+            return result ? optional<int>{-*result} : nullopt;
+        }
+        if (isnan(left.number) || isnan(right.number)) {
+            return nullopt;
+        }
+        return left.number < right.number ? -1 : left.number > right.number ? 1 : 0;
+    }
+
+    bool equals(const Constant &left, const Constant &right) {
+        if (isNumber(left) && isNumber(right)) {
+            return compareNumbers(left, right) == 0;
+        }
+        return left.kind == right.kind && left.string == right.string;
+    }
+
+    /**
+     * Numbers are compared by value and strings byte by byte, as strcoll does in the C locale
+     * @return -1, 0 or 1, nullopt if comparison raises an error or is false for every operator
+     */
+    optional<int> order(const Constant &left, const Constant &right) {
+        if (isNumber(left) && isNumber(right)) {
+            return compareNumbers(left, right);
+        }
+        if (left.kind == HirKind::STRING && right.kind == HirKind::STRING) {
+            auto result = left.string.compare(right.string);
+            return result < 0 ? -1 : result > 0 ? 1 : 0;
+        }
+        return nullopt;
+    }
+
+    optional<Constant> foldComparison(BinaryOp op, const Constant &left, const Constant &right) {
+        auto isNumeric = isNumber(left) && isNumber(right);
+        auto isString = left.kind == HirKind::STRING && right.kind == HirKind::STRING;
+        if (!isNumeric && !isString) {
+            return nullopt;
+        }
+
+        // Every ordered comparison with NaN is false
+        auto result = order(left, right);
+        switch (op) {
+            case BinaryOp::LT:
+                return makeBoolean(result && *result < 0);
+            case BinaryOp::LE:
+                return makeBoolean(result && *result <= 0);
+            case BinaryOp::GT:
+                return makeBoolean(result && *result > 0);
+            case BinaryOp::GE:
+                return makeBoolean(result && *result >= 0);
+            default:
+                return nullopt;
+        }
+    }
+
+    optional<Constant> foldIntegerArithmetic(BinaryOp op, int64_t left, int64_t right) {
+        auto unsignedLeft = static_cast<uint64_t>(left);
+        auto unsignedRight = static_cast<uint64_t>(right);
+        switch (op) {
+            case BinaryOp::ADD:
+                return makeInteger(wrap(unsignedLeft + unsignedRight));
+            case BinaryOp::SUB:
+                return makeInteger(wrap(unsignedLeft - unsignedRight));
+            case BinaryOp::MUL:
+                return makeInteger(wrap(unsignedLeft * unsignedRight));
+            case BinaryOp::FLOOR_DIV: {
+                if (right == 0) {
+                    return nullopt;
+                }
+                if (right == -1) {
+                    // Avoids overflow of INT64_MIN // -1
+                    return makeInteger(wrap(0 - unsignedLeft));
+                }
+                auto quotient = left / right;
+                if ((left ^ right) < 0 && left % right != 0) {
+                    --quotient;
+                }
+                return makeInteger(quotient);
+            }
+            case BinaryOp::MOD: {
+                if (right == 0) {
+                    return nullopt;
+                }
+                if (right == -1) {
+                    return makeInteger(0);
+                }
+                auto remainder = left % right;
+                if (remainder != 0 && (remainder ^ right) < 0) {
+                    remainder += right;
+                }
+                return makeInteger(remainder);
+            }
+            default:
+                return nullopt;
+        }
+    }
+
+    optional<Constant> foldFloatArithmetic(BinaryOp op, double left, double right) {
+        switch (op) {
+            case BinaryOp::ADD:
+                return makeFloat(left + right);
+            case BinaryOp::SUB:
+                return makeFloat(left - right);
+            case BinaryOp::MUL:
+                return makeFloat(left * right);
+            case BinaryOp::POW:
+                return makeFloat(pow(left, right));
+            default:
+                break;
+        }
+
+        // Division by zero is left to run time, as the reference compiler does
+        if (right == 0) {
+            return nullopt;
+        }
+        switch (op) {
+            case BinaryOp::DIV:
+                return makeFloat(left / right);
+            case BinaryOp::FLOOR_DIV:
+                return makeFloat(floor(left / right));
+            case BinaryOp::MOD: {
+                auto remainder = fmod(left, right);
+                if (remainder > 0 ? right < 0 : (remainder < 0 && right != remainder)) {
+                    remainder += right;
+                }
+                return makeFloat(remainder);
+            }
+            default:
+                return nullopt;
+        }
+    }
+
+    optional<Constant> foldBitwise(BinaryOp op, const Constant &left, const Constant &right) {
+        auto integerLeft = toInteger(left);
+        auto integerRight = toInteger(right);
+        if (!integerLeft || !integerRight) {
+            return nullopt;
+        }
+        switch (op) {
+            case BinaryOp::BAND:
+                return makeInteger(*integerLeft & *integerRight);
+            case BinaryOp::BOR:
+                return makeInteger(*integerLeft | *integerRight);
+            case BinaryOp::BXOR:
+                return makeInteger(*integerLeft ^ *integerRight);
+            case BinaryOp::SHL:
+                return makeInteger(shiftLeft(*integerLeft, *integerRight));
+            case BinaryOp::SHR:
+                return makeInteger(shiftLeft(*integerLeft, wrap(0 - static_cast<uint64_t>(*integerRight))));
+            default:
+                return nullopt;
+        }
+    }
+
+    optional<string> toConcatenated(const Constant &constant) {
+        switch (constant.kind) {
+            case HirKind::STRING:
+                return constant.string;
+            case HirKind::INTEGER:
+                return to_string(constant.integer);
+            case HirKind::FLOAT:
+                return toLuaString(constant.number);
+            default:
+                return nullopt;
+        }
+    }
+
+}
+
+optional<Constant> aux::optimizer::foldBinary(BinaryOp op, const Constant &left, const Constant &right) {
+    switch (op) {
+        case BinaryOp::ADD:
+        case BinaryOp::SUB:
+        case BinaryOp::MUL:
+        case BinaryOp::FLOOR_DIV:
+        case BinaryOp::MOD:
+            if (left.kind == HirKind::INTEGER && right.kind == HirKind::INTEGER) {
+                return foldIntegerArithmetic(op, left.integer, right.integer);
+            }
+            [[fallthrough]];
+        case BinaryOp::DIV:
+        case BinaryOp::POW:
+            // Strings are converted to numbers by metamethods of the string library, which may be replaced
+            if (!isNumber(left) || !isNumber(right)) {
+                return nullopt;
+            }
+            return foldFloatArithmetic(op, toFloat(left), toFloat(right));
+        case BinaryOp::CONCAT: {
+            auto concatenatedLeft = toConcatenated(left);
+            auto concatenatedRight = toConcatenated(right);
+            if (!concatenatedLeft || !concatenatedRight) {
+                return nullopt;
+            }
+            return Constant{.kind = HirKind::STRING, .string = *concatenatedLeft + *concatenatedRight};
+        }
+        case BinaryOp::EQ:
+            return makeBoolean(equals(left, right));
+        case BinaryOp::NE:
+            return makeBoolean(!equals(left, right));
+        case BinaryOp::LT:
+        case BinaryOp::LE:
+        case BinaryOp::GT:
+        case BinaryOp::GE:
+            return foldComparison(op, left, right);
+        case BinaryOp::BAND:
+        case BinaryOp::BOR:
+        case BinaryOp::BXOR:
+        case BinaryOp::SHL:
+        case BinaryOp::SHR:
+            return foldBitwise(op, left, right);
+        case BinaryOp::AND:
+        case BinaryOp::OR:
+            return nullopt;
+    }
+    return nullopt;
+}
+
+optional<Constant> aux::optimizer::foldUnary(UnaryOp op, const Constant &operand) {
+    switch (op) {
+        case UnaryOp::NEG:
+            if (operand.kind == HirKind::INTEGER) {
+                return makeInteger(wrap(0 - static_cast<uint64_t>(operand.integer)));
+            }
+            if (operand.kind == HirKind::FLOAT) {
+                return makeFloat(-operand.number);
+            }
+            return nullopt;
+        case UnaryOp::NOT:
+            return makeBoolean(!operand.isTruthy());
+        case UnaryOp::LEN:
+            if (operand.kind == HirKind::STRING) {
+                return makeInteger(static_cast<int64_t>(operand.string.size()));
+            }
+            return nullopt;
+        case UnaryOp::BNOT: {
+            auto integer = toInteger(operand);
+            return integer ? optional<Constant>{makeInteger(~*integer)} : nullopt;
+        }
+    }
+    return nullopt;
+}
+
+HirModule ConstantFolder::fold(const HirModule &module, const ScopeResolution *resolution) {
+    _module = &module;
+    _result = HirModule{};
+    _constants.assign(module.nodes.size(), nullopt);
+    _forwards.assign(module.nodes.size(), NO_NODE);
+    _foldedCount = 0;
+    _propagatedCount = 0;
+
+    // Locals that are targets of assignments anywhere, even in nested functions, keep their names
+    vector<bool> assigned(resolution ? module.nodes.size() : 0, false);
+    for (NodeId node = 0; resolution && node < module.nodes.size(); ++node) {
+        if (module[node].kind != HirKind::ASSIGN) {
+            continue;
+        }
+        for (size_t i = 0; i < module[node].split; ++i) {
+            auto target = module.getChild(node, i);
+            // The _ENV of the chunk is an upvalue without a declaration
+            if (module[target].kind == HirKind::NAME && resolution->names[target].kind != VariableKind::GLOBAL
+                && resolution->names[target].declaration != NO_NODE) {
+                assigned[resolution->names[target].declaration] = true;
+            }
+        }
+    }
+
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        evaluate(node, resolution, assigned);
+        count(node);
+    }
+
+    _result.symbols = module.symbols;
+    _result.nodes.reserve(module.nodes.size());
+    _result.children.reserve(module.children.size());
+    if (module.root != NO_NODE) {
+        _result.root = copy(module.root);
+    }
+    return std::move(_result);
+}
+
+size_t ConstantFolder::getFoldedCount() const {
+    return _foldedCount;
+}
+
+size_t ConstantFolder::getPropagatedCount() const {
+    return _propagatedCount;
+}
+
+void ConstantFolder::evaluate(NodeId node, const ScopeResolution *resolution, const vector<bool> &assigned) {
+    const auto &hirNode = (*_module)[node];
+    auto &constant = _constants[node];
+    switch (hirNode.kind) {
+        case HirKind::NIL:
+        case HirKind::TRUE:
+        case HirKind::FALSE:
+            constant = Constant{.kind = hirNode.kind};
+            return;
+        case HirKind::INTEGER:
+            constant = makeInteger(_module->integers[hirNode.value]);
+            return;
+        case HirKind::FLOAT:
+            constant = Constant{.kind = HirKind::FLOAT, .number = _module->floats[hirNode.value]};
+            return;
+        case HirKind::STRING:
+            constant = Constant{.kind = HirKind::STRING, .string = string(_module->symbols.getName(hirNode.value))};
+            return;
+        case HirKind::NAME:
+            if (resolution && resolution->names[node].kind != VariableKind::GLOBAL
+                && resolution->names[node].declaration != NO_NODE) {
+                constant = _constants[resolution->names[node].declaration];
+            }
+            return;
+        case HirKind::UNARY: {
+            const auto &operand = _constants[_module->getChild(node, 0)];
+            if (operand) {
+                constant = foldUnary(static_cast<UnaryOp>(hirNode.op), *operand);
+            }
+            return;
+        }
+        case HirKind::BINARY: {
+            auto op = static_cast<BinaryOp>(hirNode.op);
+            auto right = _module->getChild(node, 1);
+            const auto &leftConstant = _constants[_module->getChild(node, 0)];
+            const auto &rightConstant = _constants[right];
+            if (!leftConstant) {
+                return;
+            }
+            if (op != BinaryOp::AND && op != BinaryOp::OR) {
+                if (rightConstant) {
+                    constant = foldBinary(op, *leftConstant, *rightConstant);
+                }
+                return;
+            }
+
+            // 'false and x' and 'true or x' are the left operand, x is never evaluated
+            if (leftConstant->isTruthy() == (op == BinaryOp::OR)) {
+                constant = leftConstant;
+                return;
+            }
+            auto rightKind = (*_module)[right].kind;
+            if (rightConstant) {
+                constant = rightConstant;
+            } else if (rightKind != HirKind::CALL && rightKind != HirKind::METHOD_CALL && rightKind != HirKind::VARARG) {
+                _forwards[node] = right;
+            }
+            return;
+        }
+        case HirKind::LOCAL_DECL:
+            if (resolution) {
+                evaluateDeclarations(node, assigned);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+void ConstantFolder::count(NodeId node) {
+    auto kind = (*_module)[node].kind;
+    if (kind == HirKind::NAME && _constants[node]) {
+        ++_propagatedCount;
+    } else if ((kind == HirKind::UNARY || kind == HirKind::BINARY) && (_constants[node] || _forwards[node] != NO_NODE)) {
+        ++_foldedCount;
+    }
+}
+
+void ConstantFolder::evaluateDeclarations(NodeId statement, const vector<bool> &assigned) {
+    const auto &hirNode = (*_module)[statement];
+    auto valuesCount = hirNode.count - hirNode.split;
+
+    // Names without values are nil, unless the last value is a call or a vararg that gives more values
+    auto isMultipleValues = false;
+    if (valuesCount > 0) {
+        auto lastKind = (*_module)[_module->getChild(statement, hirNode.count - 1)].kind;
+        isMultipleValues = lastKind == HirKind::CALL || lastKind == HirKind::METHOD_CALL || lastKind == HirKind::VARARG;
+    }
+
+    for (size_t i = 0; i < hirNode.split; ++i) {
+        auto name = _module->getChild(statement, i);
+        if (assigned[name] || (*_module)[name].op == static_cast<uint8_t>(Attribute::CLOSE)) {
+            continue;
+        }
+        if (i < valuesCount) {
+            _constants[name] = _constants[_module->getChild(statement, hirNode.split + i)];
+        } else if (!isMultipleValues) {
+            _constants[name] = Constant{.kind = HirKind::NIL};
+        }
+    }
+}
+
+NodeId ConstantFolder::copy(NodeId node) {
+    if (_forwards[node] != NO_NODE) {
+        return copy(_forwards[node]);
+    }
+
+    const auto &hirNode = (*_module)[node];
+    if (hirNode.kind < HirKind::DECLARATION && _constants[node]) {
+        return addConstant(*_constants[node], hirNode);
+    }
+
+    vector<NodeId> nodeChildren;
+    nodeChildren.reserve(hirNode.count);
+    for (auto child: _module->getChildren(node)) {
+        nodeChildren.push_back(copy(child));
+    }
+    return _result.add(hirNode, nodeChildren);
+}
+
+NodeId ConstantFolder::addConstant(const Constant &constant, const HirNode &source) {
+    uint32_t value = 0;
+    switch (constant.kind) {
+        case HirKind::INTEGER:
+            value = static_cast<uint32_t>(_result.integers.size());
+            _result.integers.push_back(constant.integer);
+            break;
+        case HirKind::FLOAT:
+            value = static_cast<uint32_t>(_result.floats.size());
+            _result.floats.push_back(constant.number);
+            break;
+        case HirKind::STRING:
+            value = _result.symbols.intern(constant.string);
+            break;
+        default:
+            break;
+    }
+    return _result.add({constant.kind, 0, 0, value, 0, 0, source.range}, {});
+}
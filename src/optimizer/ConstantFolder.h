@@ -0,0 +1,112 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_CONSTANTFOLDER_H
+#define AUX_CONSTANTFOLDER_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../intermediate_representation/Hir.h"
+#include "../semantic/ScopeResolver.h"
+
+namespace aux::optimizer {
+
+    /**
+     * Value of a constant expression, kind is one of the literal kinds: Nil, True, False, Integer, Float or String
+     */
+    struct Constant {
+        ir::hir::HirKind kind{ir::hir::HirKind::NIL};
+        int64_t integer{0};
+        double number{0};
+        std::string string{};
+
+        [[nodiscard]]
+        inline bool isTruthy() const {
+            return kind != ir::hir::HirKind::NIL && kind != ir::hir::HirKind::FALSE;
+        }
+    };
+
+    /**
+     * Folds a binary operation over constants the same way Lua 5.4 evaluates it at run time: integers wrap
+     * around, '/' and '^' always give floats, '//' and '%' round towards minus infinity, numbers are converted
+     * to strings in concatenation, and bitwise operations accept floats with exact integer values.
+     *
+     * And/or are not folded here, their results may be operands that are not constants.
+     *
+     * @return nullopt if the operation raises an error at run time (e.g. integer division by zero, arithmetic
+     * on nil), depends on metamethods (e.g. arithmetic on strings) or gives NaN or a float zero, which lose
+     * their sign or identity as literals
+     */
+    std::optional<Constant> foldBinary(ir::hir::BinaryOp op, const Constant &left, const Constant &right);
+
+    /**
+     * @return nullopt if the operation raises an error or depends on metamethods, e.g. length of a number
+     */
+    std::optional<Constant> foldUnary(ir::hir::UnaryOp op, const Constant &operand);
+
+    /**
+     * Rewrites a @class ir::hir::HirModule with constant expressions replaced by literals:
+     * - unary and binary operations over constants are folded by @function foldBinary and @function foldUnary
+     * - and/or with a constant left operand are replaced by the operand they evaluate to, unless it is a call
+     *   or a vararg, which and/or truncate to one value
+     * - names of locals that are never assigned after their declarations are replaced by their constant
+     *   initial values, including names in nested functions
+     *
+     * Values of every node are computed in one linear walk, since children precede their parents in the module
+     * and declarations precede the names that refer to them. The module is then copied from the root, skipping
+     * operands of folded expressions, so the result is as dense as a freshly lowered one. Ids of the result
+     * differ from the source, scopes of the result have to be resolved again
+     */
+    struct ConstantFolder {
+        /**
+         * @param resolution scopes of the module, names are not propagated if it is null
+         */
+        ir::hir::HirModule fold(const ir::hir::HirModule &module, const semantic::ScopeResolution *resolution);
+
+        /**
+         * @return number of unary, binary and and/or expressions folded in the last fold, including operands
+         * of other folded expressions
+         */
+        [[nodiscard]]
+        size_t getFoldedCount() const;
+
+        /**
+         * @return number of names resolved to values of their locals in the last fold
+         */
+        [[nodiscard]]
+        size_t getPropagatedCount() const;
+
+    private:
+        const ir::hir::HirModule *_module{nullptr};
+        ir::hir::HirModule _result;
+
+        // Indexed by NodeId of the source module
+        std::vector<std::optional<Constant>> _constants;
+        std::vector<ir::hir::NodeId> _forwards;
+
+        size_t _foldedCount{0};
+        size_t _propagatedCount{0};
+
+        void evaluate(ir::hir::NodeId node, const semantic::ScopeResolution *resolution,
+                      const std::vector<bool> &assigned);
+
+        void count(ir::hir::NodeId node);
+
+        /**
+         * Values of declarations of the local list that are never assigned
+         */
+        void evaluateDeclarations(ir::hir::NodeId statement, const std::vector<bool> &assigned);
+
+        ir::hir::NodeId copy(ir::hir::NodeId node);
+
+        ir::hir::NodeId addConstant(const Constant &constant, const ir::hir::HirNode &source);
+
+    };
+
+}
+
+#endif //AUX_CONSTANTFOLDER_H
@@ -0,0 +1,303 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "DeadCodeEliminator.h"
+
+using namespace aux::optimizer;
+using namespace aux::ir::hir;
+using namespace aux::semantic;
+using namespace std;
+
+namespace {
+
+    bool isLiteral(HirKind kind) {
+        return kind == HirKind::NIL || kind == HirKind::TRUE || kind == HirKind::FALSE
+               || kind == HirKind::INTEGER || kind == HirKind::FLOAT || kind == HirKind::STRING;
+    }
+
+    bool isFalsy(HirKind kind) {
+        return kind == HirKind::NIL || kind == HirKind::FALSE;
+    }
+
+    bool isJump(HirKind kind) {
+        return kind == HirKind::RETURN || kind == HirKind::BREAK || kind == HirKind::GOTO;
+    }
+
+    size_t getByteSize(const HirModule &module) {
+        return module.nodes.size() * sizeof(HirNode)
+               + module.children.size() * sizeof(NodeId)
+               + module.integers.size() * sizeof(int64_t)
+               + module.floats.size() * sizeof(double);
+    }
+
+}
+
+HirModule DeadCodeEliminator::eliminate(const HirModule &module) {
+    const HirModule *source = &module;
+    HirModule current;
+    while (true) {
+        ScopeResolver resolver;
+        _resolution = resolver.resolve(*source);
+        _module = source;
+        countReads();
+        findKeptStores();
+
+        _result = HirModule{};
+        _result.symbols = source->symbols;
+        _result.nodes.reserve(source->nodes.size());
+        _result.children.reserve(source->children.size());
+        if (source->root != NO_NODE) {
+            _result.root = copy(source->root);
+        }
+
+        auto isChanged = _result.nodes.size() < source->nodes.size();
+        current = std::move(_result);
+        source = &current;
+        if (!isChanged) {
+            break;
+        }
+    }
+
+    _removedNodesCount = module.nodes.size() - current.nodes.size();
+    _removedBytes = getByteSize(module) - getByteSize(current);
+    return current;
+}
+
+size_t DeadCodeEliminator::getRemovedNodesCount() const {
+    return _removedNodesCount;
+}
+
+size_t DeadCodeEliminator::getRemovedBytes() const {
+    return _removedBytes;
+}
+
+void DeadCodeEliminator::countReads() {
+    const auto &module = *_module;
+    _reads.assign(module.nodes.size(), 0);
+    _isTarget.assign(module.nodes.size(), false);
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        if (module[node].kind == HirKind::ASSIGN) {
+            for (size_t i = 0; i < module[node].split; ++i) {
+                _isTarget[module.getChild(node, i)] = true;
+            }
+        }
+    }
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        const auto &name = _resolution.names[node];
+        if (module[node].kind == HirKind::NAME && !_isTarget[node] && name.kind != VariableKind::GLOBAL
+            && name.declaration != NO_NODE) {
+            ++_reads[name.declaration];
+        }
+    }
+}
+
+void DeadCodeEliminator::findKeptStores() {
+    const auto &module = *_module;
+    _hasKeptStores.assign(module.nodes.size(), false);
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        if (module[node].kind != HirKind::ASSIGN || (hasOnlyUnreadTargets(node) && areValuesDropped(node))) {
+            continue;
+        }
+        for (size_t i = 0; i < module[node].split; ++i) {
+            const auto &name = _resolution.names[module.getChild(node, i)];
+            if (name.kind != VariableKind::GLOBAL && name.declaration != NO_NODE) {
+                _hasKeptStores[name.declaration] = true;
+            }
+        }
+    }
+}
+
+NodeId DeadCodeEliminator::copy(NodeId node) {
+    auto hirNode = (*_module)[node];
+    if (hirNode.kind == HirKind::BLOCK) {
+        return copyBlock(node);
+    }
+
+    vector<NodeId> nodeChildren;
+    nodeChildren.reserve(hirNode.count);
+    for (auto child: _module->getChildren(node)) {
+        nodeChildren.push_back(copy(child));
+    }
+    if (hirNode.kind == HirKind::INTEGER) {
+        hirNode.value = static_cast<uint32_t>(_result.integers.size());
+        _result.integers.push_back(_module->integers[(*_module)[node].value]);
+    } else if (hirNode.kind == HirKind::FLOAT) {
+        hirNode.value = static_cast<uint32_t>(_result.floats.size());
+        _result.floats.push_back(_module->floats[(*_module)[node].value]);
+    }
+    return _result.add(hirNode, nodeChildren);
+}
+
+NodeId DeadCodeEliminator::copyBlock(NodeId block) {
+    auto statements = copyStatements(block);
+    return _result.add((*_module)[block], statements);
+}
+
+vector<NodeId> DeadCodeEliminator::copyStatements(NodeId block) {
+    vector<NodeId> statements;
+    auto isReachable = true;
+    for (auto statement: _module->getChildren(block)) {
+        auto kind = (*_module)[statement].kind;
+        // Gotos may jump to labels after jumps
+        if (!isReachable && kind != HirKind::LABEL) {
+            continue;
+        }
+        isReachable = !isJump(kind);
+
+        auto copied = copyStatement(statement);
+        if (copied != NO_NODE) {
+            statements.push_back(copied);
+        }
+    }
+    return statements;
+}
+
+NodeId DeadCodeEliminator::copyStatement(NodeId statement) {
+    const auto &hirNode = (*_module)[statement];
+    switch (hirNode.kind) {
+        case HirKind::BLOCK: {
+            auto statements = copyStatements(statement);
+            return statements.empty() ? NO_NODE : _result.add(hirNode, statements);
+        }
+        case HirKind::IF:
+            return copyIf(statement);
+        case HirKind::WHILE:
+            return isFalsy((*_module)[_module->getChild(statement, 0)].kind) ? NO_NODE : copy(statement);
+        case HirKind::LOCAL_DECL:
+        case HirKind::ASSIGN:
+            return copyUnreadStores(statement);
+        case HirKind::LOCAL_FUNCTION: {
+            auto declaration = _module->getChild(statement, 0);
+            return isUnread(declaration) && !_hasKeptStores[declaration] ? NO_NODE : copy(statement);
+        }
+        default:
+            return copy(statement);
+    }
+}
+
+NodeId DeadCodeEliminator::copyIf(NodeId statement) {
+    const auto &hirNode = (*_module)[statement];
+    vector<NodeId> nodeChildren;
+    auto otherwise = NO_NODE;
+    size_t i = 0;
+    for (; i + 1 < hirNode.count; i += 2) {
+        auto condition = _module->getChild(statement, i);
+        auto kind = (*_module)[condition].kind;
+        if (isFalsy(kind)) {
+            continue;
+        }
+        if (isLiteral(kind)) {
+            // Conditions after a truthy one are never evaluated
+            otherwise = _module->getChild(statement, i + 1);
+            break;
+        }
+        nodeChildren.push_back(copy(condition));
+        nodeChildren.push_back(copyBlock(_module->getChild(statement, i + 1)));
+    }
+    if (i + 1 == hirNode.count) {
+        otherwise = _module->getChild(statement, i);
+    }
+
+    if (nodeChildren.empty()) {
+        // The branch that always runs becomes a do block, which keeps the scope of its locals
+        return otherwise == NO_NODE ? NO_NODE : copyStatement(otherwise);
+    }
+    if (otherwise != NO_NODE) {
+        nodeChildren.push_back(copyBlock(otherwise));
+    }
+    return _result.add(hirNode, nodeChildren);
+}
+
+NodeId DeadCodeEliminator::copyUnreadStores(NodeId statement) {
+    if (!hasOnlyUnreadTargets(statement) || !areValuesDropped(statement)) {
+        return copy(statement);
+    }
+
+    // Values are either pure or a single call, which is kept as a statement
+    auto values = _module->getChildren(statement).subspan((*_module)[statement].split);
+    return values.size() == 1 && !isPure(values[0]) ? copy(values[0]) : NO_NODE;
+}
+
+bool DeadCodeEliminator::hasOnlyUnreadTargets(NodeId statement) const {
+    const auto &hirNode = (*_module)[statement];
+    for (size_t i = 0; i < hirNode.split; ++i) {
+        auto target = _module->getChild(statement, i);
+        if (hirNode.kind == HirKind::LOCAL_DECL) {
+            if (!isUnread(target) || _hasKeptStores[target]) {
+                return false;
+            }
+            continue;
+        }
+        const auto &name = _resolution.names[target];
+        auto isLocal = (*_module)[target].kind == HirKind::NAME && name.kind != VariableKind::GLOBAL;
+        if (!isLocal || name.declaration == NO_NODE || !isUnread(name.declaration)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DeadCodeEliminator::areValuesDropped(NodeId statement) const {
+    auto values = _module->getChildren(statement).subspan((*_module)[statement].split);
+    auto isPureValues = true;
+    for (auto value: values) {
+        isPureValues = isPureValues && isPure(value);
+    }
+    auto kind = values.size() == 1 ? (*_module)[values[0]].kind : HirKind::NIL;
+    return isPureValues || kind == HirKind::CALL || kind == HirKind::METHOD_CALL;
+}
+
+bool DeadCodeEliminator::isUnread(NodeId declaration) const {
+    // To-be-closed variables are closed even if they are never read
+    return _reads[declaration] == 0 && (*_module)[declaration].op != static_cast<uint8_t>(Attribute::CLOSE);
+}
+
+bool DeadCodeEliminator::isPure(NodeId expression) const {
+    const auto &hirNode = (*_module)[expression];
+    switch (hirNode.kind) {
+        case HirKind::NIL:
+        case HirKind::TRUE:
+        case HirKind::FALSE:
+        case HirKind::INTEGER:
+        case HirKind::FLOAT:
+        case HirKind::STRING:
+        case HirKind::VARARG:
+        case HirKind::FUNCTION:
+            return true;
+        case HirKind::NAME:
+            // Globals are read from _ENV, which may have __index
+            return _resolution.names[expression].kind != VariableKind::GLOBAL;
+        case HirKind::UNARY:
+            if (static_cast<UnaryOp>(hirNode.op) != UnaryOp::NOT) {
+                return false;
+            }
+            break;
+        case HirKind::BINARY: {
+            auto op = static_cast<BinaryOp>(hirNode.op);
+            if (op != BinaryOp::AND && op != BinaryOp::OR) {
+                return false;
+            }
+            break;
+        }
+        case HirKind::TABLE_FIELD: {
+            // Keys that may be nil fail at runtime, folded literals are never NaN
+            auto key = (*_module)[_module->getChild(expression, 0)].kind;
+            if (!isLiteral(key) || key == HirKind::NIL) {
+                return false;
+            }
+            break;
+        }
+        case HirKind::PAREN:
+        case HirKind::TABLE:
+            break;
+        default:
+            return false;
+    }
+    for (auto child: _module->getChildren(expression)) {
+        if (!isPure(child)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,110 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_DEADCODEELIMINATOR_H
+#define AUX_DEADCODEELIMINATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../intermediate_representation/Hir.h"
+#include "../semantic/ScopeResolver.h"
+
+namespace aux::optimizer {
+
+    /**
+     * Removes code of a @class ir::hir::HirModule that is never run or whose results are never read:
+     * - statements after return, break and goto, up to the next label
+     * - branches of if with literal conditions, while loops with falsy literal conditions, empty do blocks
+     * - declarations and assignments of locals that are never read, local functions that are never read
+     *
+     * Conditions are expected to be folded by @class ConstantFolder first. Expressions that may have side
+     * effects are kept: a removed declaration or assignment with a single call as its value leaves the call
+     * as a statement, and other ones are kept whole. Only literals, locals, varargs, closures, not, and/or
+     * and tables of such expressions are considered free of side effects, since reading globals, indexing
+     * and arithmetic may call metamethods or raise errors.
+     *
+     * Scopes are resolved again after every rebuild of the module, until the rebuild removes nothing, since
+     * removing a local may leave the locals read by its value unread
+     */
+    struct DeadCodeEliminator {
+        ir::hir::HirModule eliminate(const ir::hir::HirModule &module);
+
+        /**
+         * @return number of nodes removed by the last elimination
+         */
+        [[nodiscard]]
+        size_t getRemovedNodesCount() const;
+
+        /**
+         * @return bytes of nodes, children lists and literals removed by the last elimination
+         */
+        [[nodiscard]]
+        size_t getRemovedBytes() const;
+
+    private:
+        const ir::hir::HirModule *_module{nullptr};
+        ir::hir::HirModule _result;
+
+        // Indexed by NodeId of the source module
+        std::vector<uint32_t> _reads;
+        std::vector<bool> _isTarget;
+        std::vector<bool> _hasKeptStores;
+        semantic::ScopeResolution _resolution;
+
+        size_t _removedNodesCount{0};
+        size_t _removedBytes{0};
+
+        void countReads();
+
+        /**
+         * Marks declarations assigned by statements that are kept, so that the assignments are not rebound
+         * to an outer local or a global by removing the declaration
+         */
+        void findKeptStores();
+
+        ir::hir::NodeId copy(ir::hir::NodeId node);
+
+        ir::hir::NodeId copyBlock(ir::hir::NodeId block);
+
+        /**
+         * @return ids of copied statements of the block without unreachable and removed ones
+         */
+        std::vector<ir::hir::NodeId> copyStatements(ir::hir::NodeId block);
+
+        /**
+         * @return NO_NODE if the statement is removed
+         */
+        ir::hir::NodeId copyStatement(ir::hir::NodeId statement);
+
+        ir::hir::NodeId copyIf(ir::hir::NodeId statement);
+
+        /**
+         * Declarations and assignments of unread locals, first children up to the split are the locals
+         */
+        ir::hir::NodeId copyUnreadStores(ir::hir::NodeId statement);
+
+        /**
+         * @return true if every local of the declaration or assignment is unread and can be removed
+         */
+        [[nodiscard]]
+        bool hasOnlyUnreadTargets(ir::hir::NodeId statement) const;
+
+        /**
+         * @return true if values of the statement are dropped with its unread targets, calls among them are kept
+         */
+        [[nodiscard]]
+        bool areValuesDropped(ir::hir::NodeId statement) const;
+
+        [[nodiscard]]
+        bool isUnread(ir::hir::NodeId declaration) const;
+
+        [[nodiscard]]
+        bool isPure(ir::hir::NodeId expression) const;
+
+    };
+
+}
+
+#endif //AUX_DEADCODEELIMINATOR_H
@@ -0,0 +1,235 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "IncrementalParser.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include "../scanner/ModularScanner.h"
+#include "../scanner/TokenBufferScanner.h"
+#include "../scanner/input_stream/PreprocessedFileInputStream.h"
+
+using namespace aux::ir::tokens;
+using namespace aux::ir::ast;
+using namespace aux::exception;
+using namespace aux::scanner;
+using namespace aux::scanner::input_stream;
+using namespace aux::parser;
+using namespace std;
+
+namespace {
+
+    bool isAscii(const string &text) {
+        return all_of(text.begin(), text.end(), [](char c) { return isascii(c); });
+    }
+
+}
+
+IncrementalParser::IncrementalParser(string source) : _source(std::move(source)) {
+    parseFromScratch();
+}
+
+shared_ptr<BaseTree> IncrementalParser::edit(size_t offset, size_t length, const string &text) {
+    offset = min(offset, _source.size());
+    length = min(length, _source.size() - offset);
+    _lastEditIncremental = false;
+
+    bool trackable = _errors.empty() && _asciiOnly && isAscii(text)
+                     && _edits.size() < MAX_PENDING_EDITS
+                     && _lineStarts.size() < numeric_limits<uint16_t>::max();
+
+    // Regions are ordered by their END tokens, so the innermost one containing the edit
+    // is the first region that ends after the edit and begins before it
+    size_t regionIndex = _regions.size();
+    if (trackable) {
+        auto first = partition_point(_regions.begin(), _regions.end(), [&](const FunctionBodyRegion &region) {
+            return offsetOf(getSpan(*region.end)) < offset + length;
+        });
+        for (auto it = first; it != _regions.end(); ++it) {
+            if (offsetOf(getSpan(*it->begin)) < offset) {
+                regionIndex = it - _regions.begin();
+                break;
+            }
+        }
+    }
+
+    if (regionIndex == _regions.size()) {
+        replaceSource(offset, length, text);
+        return parseFromScratch();
+    }
+
+    size_t beginOffset = offsetOf(getSpan(*_regions[regionIndex].begin));
+    size_t endOffset = offsetOf(getSpan(*_regions[regionIndex].end));
+    size_t firstNestedIndex = regionIndex;
+    while (firstNestedIndex > 0 && offsetOf(getSpan(*_regions[firstNestedIndex - 1].end)) > beginOffset) {
+        --firstNestedIndex;
+    }
+
+    auto oldEnd = positionOf(offset + length);
+    replaceSource(offset, length, text);
+    _edits.push_back({oldEnd, positionOf(offset + text.size())});
+
+    auto body = reparseRegion(regionIndex, firstNestedIndex, beginOffset, endOffset + text.size() - length);
+    if (!body) {
+        return parseFromScratch();
+    }
+
+    _lastEditIncremental = true;
+    return body;
+}
+
+shared_ptr<BaseTree> IncrementalParser::getTree() const {
+    return _tree;
+}
+
+const vector<ParsingException> &IncrementalParser::getErrors() const {
+    return _errors;
+}
+
+const string &IncrementalParser::getSource() const {
+    return _source;
+}
+
+Span IncrementalParser::getSpan(const Token &token) const {
+    return translate(token.getSpan(), token.getRevision());
+}
+
+SourceRange IncrementalParser::getRange(const BaseTree &tree) const {
+    auto start = translate(tree.range.getStart(), tree.range.revision);
+    auto end = translate(tree.range.getEnd(), tree.range.revision);
+    return {start.row, start.column, end.row, end.column, static_cast<uint32_t>(_edits.size())};
+}
+
+Span IncrementalParser::translate(const Span &span, size_t revision) const {
+    uint16_t row = span.row, column = span.column;
+
+    for (size_t i = revision; i < _edits.size(); ++i) {
+        const auto &edit = _edits[i];
+        if (row < edit.oldEnd.row || (row == edit.oldEnd.row && column < edit.oldEnd.column)) {
+            continue;
+        }
+
+        if (row == edit.oldEnd.row) {
+            column = edit.newEnd.column + column - edit.oldEnd.column;
+        }
+        row = row + edit.newEnd.row - edit.oldEnd.row;
+    }
+
+    return Span{row, column};
+}
+
+bool IncrementalParser::isLastEditIncremental() const {
+    return _lastEditIncremental;
+}
+
+shared_ptr<BaseTree> IncrementalParser::parseFromScratch() {
+    _lineStarts = {0};
+    for (size_t i = 0; i < _source.size(); ++i) {
+        if (_source[i] == '\n') {
+            _lineStarts.push_back(i + 1);
+        }
+    }
+    _asciiOnly = isAscii(_source);
+
+    PreprocessedFileInputStream stream{make_unique<istringstream>(_source)};
+    Parser parser{make_shared<ModularScanner>(stream)};
+    parser.recordFunctionBodies();
+
+    _tree = parser.parse();
+    _errors = vector<ParsingException>(parser.getErrors());
+    _regions = parser.getFunctionBodies();
+    _edits.clear();
+    return _tree;
+}
+
+/**
+ * Scans the edited region from its '(' up to the END at the expected offset and parses it as a function body.
+ * The region is reused only if its END is still there and everything in between is exactly one function body,
+ * the old body node then takes the children of the new one, so parents need not be touched
+ */
+shared_ptr<BinTree> IncrementalParser::reparseRegion(
+        size_t regionIndex,
+        size_t firstNestedIndex,
+        size_t beginOffset,
+        size_t endOffset
+) {
+    static const size_t endLength = (*Keyword::END).size();
+
+    auto begin = positionOf(beginOffset);
+    PreprocessedFileInputStream stream{
+            make_unique<istringstream>(_source.substr(beginOffset, endOffset + endLength - beginOffset)),
+            static_cast<uint16_t>(begin.row - 1),
+            static_cast<uint16_t>(begin.column - 1)
+    };
+    ModularScanner scanner{stream};
+
+    auto tokens = make_shared<TokenBuffer>();
+    while (true) {
+        auto token = scanner.next();
+        if (token->getType() == TokenType::EOF_OR_UNDEFINED) {
+            return nullptr;
+        }
+
+        token->setRevision(_edits.size());
+        tokens->push_back(token);
+
+        auto tokenOffset = offsetOf(token->getSpan());
+        if (tokenOffset >= endOffset) {
+            if (tokenOffset != endOffset || token->getType() != TokenType::KEYWORD
+                || token->getRawValue() != *Keyword::END) {
+                return nullptr;
+            }
+            break;
+        }
+    }
+    tokens->push_back(make_shared<TokenEofOrUndefined>(tokens->back()->getSpan()));
+
+    Parser parser{make_shared<TokenBufferScanner>(tokens)};
+    parser.recordFunctionBodies();
+    auto body = parser.parseStandaloneFunctionBody();
+    if (!body) {
+        return nullptr;
+    }
+
+    auto oldBody = _regions[regionIndex].body;
+    oldBody->left = body->left;
+    oldBody->right = body->right;
+    oldBody->range = body->range;
+
+    auto regions = parser.getFunctionBodies();
+    regions.back().body = oldBody;
+    _regions.erase(_regions.begin() + firstNestedIndex, _regions.begin() + regionIndex + 1);
+    _regions.insert(_regions.begin() + firstNestedIndex, regions.begin(), regions.end());
+    return oldBody;
+}
+
+void IncrementalParser::replaceSource(size_t offset, size_t length, const string &text) {
+    _source.replace(offset, length, text);
+
+    // Rows starting inside the replaced range are removed, the following ones are shifted
+    auto first = upper_bound(_lineStarts.begin(), _lineStarts.end(), offset);
+    auto last = upper_bound(first, _lineStarts.end(), offset + length);
+    first = _lineStarts.erase(first, last);
+    for (auto it = first; it != _lineStarts.end(); ++it) {
+        *it = *it - length + text.size();
+    }
+
+    vector<size_t> inserted;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') {
+            inserted.push_back(offset + i + 1);
+        }
+    }
+    _lineStarts.insert(first, inserted.begin(), inserted.end());
+}
+
+Span IncrementalParser::positionOf(size_t offset) const {
+    auto row = upper_bound(_lineStarts.begin(), _lineStarts.end(), offset) - _lineStarts.begin() - 1;
+    return Span{static_cast<uint16_t>(row + 1), static_cast<uint16_t>(offset - _lineStarts[row] + 1)};
+}
+
+size_t IncrementalParser::offsetOf(const Span &span) const {
+    return _lineStarts[span.row - 1] + span.column - 1;
+}
@@ -0,0 +1,98 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_INCREMENTALPARSER_H
+#define AUX_INCREMENTALPARSER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Parser.h"
+
+namespace aux::parser {
+
+    /**
+     * Keeps the tree of an in-memory source up to date while the source is edited.
+     * An edit inside a function body reparses only the innermost such body and splices the result into the
+     * old tree in place, everything else is reused. Tokens after the edit are not touched, their spans are
+     * translated lazily by @function getSpan using the revision they were scanned at.
+     * Edits outside function bodies, sources with syntax errors or non-ASCII characters are parsed from scratch
+     */
+    struct IncrementalParser {
+
+        explicit IncrementalParser(std::string source);
+
+        /**
+         * Replaces length bytes starting at offset with text
+         * @return reparsed function body, or the whole tree if the source was parsed from scratch
+         */
+        std::shared_ptr<ir::ast::BaseTree> edit(size_t offset, size_t length, const std::string &text);
+
+        [[nodiscard]]
+        std::shared_ptr<ir::ast::BaseTree> getTree() const;
+
+        [[nodiscard]]
+        const std::vector<exception::ParsingException> &getErrors() const;
+
+        [[nodiscard]]
+        const std::string &getSource() const;
+
+        /**
+         * Span of the token in the current source
+         */
+        [[nodiscard]]
+        ir::tokens::Span getSpan(const ir::tokens::Token &token) const;
+
+        /**
+         * Range of the node in the current source, nodes enclosing an edit are translated the same way as tokens
+         */
+        [[nodiscard]]
+        ir::ast::SourceRange getRange(const ir::ast::BaseTree &tree) const;
+
+        /**
+         * @return true if the last edit was handled by reparsing a single function body
+         */
+        [[nodiscard]]
+        bool isLastEditIncremental() const;
+
+    private:
+        static constexpr size_t MAX_PENDING_EDITS = 1024;
+
+        // Positions following the edited range before and after the edit
+        struct Edit {
+            ir::tokens::Span oldEnd;
+            ir::tokens::Span newEnd;
+        };
+
+        std::string _source;
+        std::vector<size_t> _lineStarts;
+        bool _asciiOnly{true};
+
+        std::shared_ptr<ir::ast::BaseTree> _tree;
+        std::vector<exception::ParsingException> _errors;
+        std::vector<FunctionBodyRegion> _regions;
+        std::vector<Edit> _edits;
+        bool _lastEditIncremental{false};
+
+        std::shared_ptr<ir::ast::BaseTree> parseFromScratch();
+
+        std::shared_ptr<ir::ast::BinTree> reparseRegion(size_t regionIndex, size_t firstNestedIndex,
+                                                        size_t beginOffset, size_t endOffset);
+
+        void replaceSource(size_t offset, size_t length, const std::string &text);
+
+        [[nodiscard]]
+        ir::tokens::Span positionOf(size_t offset) const;
+
+        [[nodiscard]]
+        ir::tokens::Span translate(const ir::tokens::Span &span, size_t revision) const;
+
+        [[nodiscard]]
+        size_t offsetOf(const ir::tokens::Span &span) const;
+    };
+
+}
+
+#endif //AUX_INCREMENTALPARSER_H
@@ -0,0 +1,172 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "ParallelParser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+using namespace aux::ir::tokens;
+using namespace aux::ir::ast;
+using namespace aux::exception;
+using namespace aux::scanner;
+using namespace aux::parser;
+using namespace std;
+
+namespace {
+
+    bool isKeyword(const Token &token, Keyword keyword) {
+        return token.getType() == TokenType::KEYWORD && token.getRawValue() == *keyword;
+    }
+
+    bool isOperator(const Token &token, Operator op) {
+        return token.getType() == TokenType::OPERATOR && token.getRawValue() == *op;
+    }
+
+    bool opensBlock(const Token &token) {
+        return isKeyword(token, Keyword::IF) || isKeyword(token, Keyword::FUNCTION)
+               || isKeyword(token, Keyword::DO) || isKeyword(token, Keyword::REPEAT)
+               || isOperator(token, Operator::LEFT_PARENTHESIS) || isOperator(token, Operator::LEFT_BRACKET)
+               || isOperator(token, Operator::LEFT_CURLY_BRACE);
+    }
+
+    bool closesBlock(const Token &token) {
+        return isKeyword(token, Keyword::END) || isKeyword(token, Keyword::UNTIL)
+               || isOperator(token, Operator::RIGHT_PARENTHESIS) || isOperator(token, Operator::RIGHT_BRACKET)
+               || isOperator(token, Operator::RIGHT_CURLY_BRACE);
+    }
+
+    /**
+     * No expression continues after such a token with FUNCTION keyword, so FUNCTION following it starts a statement
+     */
+    bool canEndStatement(const Token &token) {
+        switch (token.getType()) {
+            case TokenType::IDENTIFIER:
+            case TokenType::NUMERIC_DECIMAL:
+            case TokenType::NUMERIC_HEX:
+            case TokenType::NUMERIC_DOUBLE:
+            case TokenType::STRING_LITERAL:
+                return true;
+            case TokenType::KEYWORD:
+                return isKeyword(token, Keyword::END) || isKeyword(token, Keyword::BREAK)
+                       || isKeyword(token, Keyword::NIL) || isKeyword(token, Keyword::TRUE)
+                       || isKeyword(token, Keyword::FALSE);
+            case TokenType::OPERATOR:
+                return isOperator(token, Operator::RIGHT_PARENTHESIS) || isOperator(token, Operator::RIGHT_BRACKET)
+                       || isOperator(token, Operator::RIGHT_CURLY_BRACE) || isOperator(token, Operator::SEMI_COLON)
+                       || isOperator(token, Operator::DOT_DOT_DOT) || isOperator(token, Operator::COLON_COLON);
+            default:
+                return false;
+        }
+    }
+
+}
+
+ParallelParser::ParallelParser(shared_ptr<const TokenBuffer> tokens, size_t threads)
+        : _tokens(std::move(tokens)),
+          _threads(threads != 0 ? threads : max<size_t>(1, thread::hardware_concurrency())) {}
+
+shared_ptr<BaseTree> ParallelParser::parse() {
+    auto ranges = splitTopLevelStatements(*_tokens);
+    if (ranges.size() < 2 || _threads < 2) {
+        return parseSequentially();
+    }
+
+    // About four tasks per thread, so that threads done with short ranges take over the remaining ones
+    size_t tokensPerTask = max<size_t>(1, _tokens->size() / (_threads * 4));
+    vector<pair<size_t, size_t>> tasks;
+    for (const auto &range: ranges) {
+        if (tasks.empty() || tasks.back().second - tasks.back().first >= tokensPerTask) {
+            tasks.push_back(range);
+        } else {
+            tasks.back().second = range.second;
+        }
+    }
+
+    vector<shared_ptr<BaseTree>> results(tasks.size());
+    vector<uint8_t> failed(tasks.size(), false);
+    atomic<size_t> nextTask{0};
+
+    auto work = [&]() {
+        for (size_t i = nextTask++; i < tasks.size(); i = nextTask++) {
+            Parser parser{make_shared<TokenBufferScanner>(_tokens, tasks[i].first, tasks[i].second)};
+            results[i] = parser.parse();
+            failed[i] = !parser.getErrors().empty();
+        }
+    };
+
+    vector<thread> workers;
+    for (size_t i = 1; i < min(_threads, tasks.size()); ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+
+    if (find(failed.begin(), failed.end(), true) != failed.end()) {
+        return parseSequentially();
+    }
+
+    auto result = make_shared<ListTree>(ListTree::Type::STATEMENTS_LIST);
+    for (const auto &tree: results) {
+        for (const auto &statement: static_pointer_cast<ListTree>(tree)->trees) {
+            result->pushBack(statement);
+        }
+    }
+
+    _errors.clear();
+    return result;
+}
+
+const vector<ParsingException> &ParallelParser::getErrors() const {
+    return _errors;
+}
+
+vector<pair<size_t, size_t>> ParallelParser::splitTopLevelStatements(const TokenBuffer &tokens) {
+    vector<pair<size_t, size_t>> result;
+    if (tokens.empty()) {
+        return result;
+    }
+
+    const size_t eof = tokens.size() - 1;
+    size_t begin = 0;
+    int64_t depth = 0;
+
+    for (size_t i = 0; i < eof; ++i) {
+        const auto &token = *tokens[i];
+
+        if (depth == 0 && i > begin) {
+            bool functionDefinition = isKeyword(token, Keyword::FUNCTION) && canEndStatement(*tokens[i - 1]);
+            bool localFunctionDefinition = isKeyword(token, Keyword::LOCAL) && isKeyword(*tokens[i + 1], Keyword::FUNCTION);
+            if (functionDefinition || localFunctionDefinition) {
+                result.emplace_back(begin, i);
+                begin = i;
+            }
+        }
+
+        // Only the last statement of a block may be return, statements after it must stay in its range to be reported
+        if (depth == 0 && isKeyword(token, Keyword::RETURN)) {
+            break;
+        }
+
+        if (opensBlock(token)) {
+            ++depth;
+        } else if (closesBlock(token) && --depth < 0) {
+            break;
+        }
+    }
+
+    result.emplace_back(begin, eof);
+    return result;
+}
+
+shared_ptr<BaseTree> ParallelParser::parseSequentially() {
+    Parser parser{make_shared<TokenBufferScanner>(_tokens)};
+    auto result = parser.parse();
+    _errors = vector<ParsingException>(parser.getErrors());
+    return result;
+}
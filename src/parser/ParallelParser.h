@@ -0,0 +1,53 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_PARALLELPARSER_H
+#define AUX_PARALLELPARSER_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Parser.h"
+#include "../scanner/TokenBufferScanner.h"
+
+namespace aux::parser {
+
+    /**
+     * Parses a scanned source on several threads. Top-level function definitions are found by matching
+     * brackets and block keywords over the token buffer, consecutive statements are grouped into ranges of
+     * similar size and each range is parsed by its own @class Parser. Results are joined in source order
+     * into one statements list, equal to the one built by @function Parser::parse.
+     * If any range has syntax errors, the whole source is parsed again on the calling thread,
+     * so that errors are reported exactly as by the sequential parser
+     */
+    struct ParallelParser {
+
+        /**
+         * @param threads number of worker threads, all available cores are used if 0
+         */
+        explicit ParallelParser(std::shared_ptr<const scanner::TokenBuffer> tokens, size_t threads = 0);
+
+        std::shared_ptr<ir::ast::BaseTree> parse();
+
+        [[nodiscard]]
+        const std::vector<exception::ParsingException> &getErrors() const;
+
+        /**
+         * Splits tokens preceding EOF into [begin, end) ranges, each one except the first starts with a
+         * top-level function definition. Splitting stops at a top-level return or unbalanced brackets and blocks
+         */
+        static std::vector<std::pair<size_t, size_t>> splitTopLevelStatements(const scanner::TokenBuffer &tokens);
+
+    private:
+        const std::shared_ptr<const scanner::TokenBuffer> _tokens;
+        const size_t _threads;
+        std::vector<exception::ParsingException> _errors;
+
+        std::shared_ptr<ir::ast::BaseTree> parseSequentially();
+    };
+
+}
+
+#endif //AUX_PARALLELPARSER_H
@@ -0,0 +1,86 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_PARSELISTENER_H
+#define AUX_PARSELISTENER_H
+
+#include <string>
+#include <vector>
+#include <optional>
+
+#include "../intermediate_representation/Token.h"
+#include "../exception/Exception.h"
+
+namespace aux::parser {
+
+    struct FunctionEvent {
+        ir::tokens::Span begin;
+        std::string name; // Dotted name of function definition, empty for anonymous functions
+        bool isLocal{false};
+    };
+
+    struct CallEvent {
+        ir::tokens::Span begin;
+        ir::tokens::Span end;
+        std::string callee; // e.g. "require", "string.format" or "obj:method", empty if callee is not a name
+        std::optional<std::string> literalArgument; // Set when the only argument is a string literal
+    };
+
+    struct TableConstructorEvent {
+        ir::tokens::Span begin;
+        ir::tokens::Span end;
+        size_t fieldsCount{0};
+    };
+
+    struct AssignmentEvent {
+        ir::tokens::Span begin;
+        ir::tokens::Span end;
+        std::vector<std::string> targets; // Dotted names of targets, empty for indexed or parenthesized ones
+    };
+
+    struct LocalDeclarationEvent {
+        ir::tokens::Span begin;
+        ir::tokens::Span end;
+        std::vector<std::string> names;
+        bool hasValues{false};
+    };
+
+    /**
+     * Receives events from @function Parser::parse(ParseListener &) in source order, nested constructs
+     * (calls in arguments, tables in fields) are reported before the construct that contains them.
+     * No tree is built in this mode, calling @function stop from any callback ends parsing right after it.
+     */
+    struct ParseListener {
+        virtual ~ParseListener() = default;
+
+        virtual void enterFunction(const FunctionEvent &/* event */) {}
+
+        virtual void exitFunction(const ir::tokens::Span &/* end */) {}
+
+        virtual void call(const CallEvent &/* event */) {}
+
+        virtual void tableConstructor(const TableConstructorEvent &/* event */) {}
+
+        virtual void assignment(const AssignmentEvent &/* event */) {}
+
+        virtual void localDeclaration(const LocalDeclarationEvent &/* event */) {}
+
+        virtual void syntaxError(const exception::ParsingException &/* error */) {}
+
+        inline void stop() {
+            _stopRequested = true;
+        }
+
+        [[nodiscard]]
+        inline bool isStopRequested() const {
+            return _stopRequested;
+        }
+
+    private:
+        bool _stopRequested{false};
+    };
+
+}
+
+#endif //AUX_PARSELISTENER_H
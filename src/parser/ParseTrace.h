@@ -0,0 +1,141 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_PARSETRACE_H
+#define AUX_PARSETRACE_H
+
+#include <vector>
+#include <cstdint>
+#include <ostream>
+
+namespace aux::parser {
+
+    struct ParseTraceEvent {
+        enum class Type : uint8_t {
+            ENTER,
+            EXIT
+        };
+
+        Type type{Type::ENTER};
+        uint16_t depth{0};
+        uint32_t tokenIndex{0};
+        const char *production{nullptr};
+    };
+
+    /**
+     * Fixed size ring buffer of production enter/exit events recorded by the Parser.
+     * Instrumentation points in Parser are compiled only when AUX_PARSER_TRACE is defined,
+     * recording itself is turned on at runtime with @function enable.
+     */
+    struct ParseTrace {
+
+        static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+        explicit ParseTrace(size_t capacity = DEFAULT_CAPACITY) : _capacity(capacity > 0 ? capacity : 1) {}
+
+        inline void enable(bool enabled = true) {
+            _enabled = enabled;
+            if (_enabled) {
+                _events.reserve(_capacity);
+            }
+        }
+
+        [[nodiscard]]
+        inline bool isEnabled() const {
+            return _enabled;
+        }
+
+        inline void enter(const char *production, uint32_t tokenIndex) {
+            if (_enabled) {
+                record({ParseTraceEvent::Type::ENTER, _depth, tokenIndex, production});
+            }
+            ++_depth;
+        }
+
+        inline void exit(const char *production, uint32_t tokenIndex) {
+            --_depth;
+            if (_enabled) {
+                record({ParseTraceEvent::Type::EXIT, _depth, tokenIndex, production});
+            }
+        }
+
+        /**
+         * @return recorded events starting from the oldest one still kept in the buffer
+         */
+        [[nodiscard]]
+        inline std::vector<ParseTraceEvent> getEvents() const {
+            std::vector<ParseTraceEvent> result;
+            result.reserve(_events.size());
+            for (size_t i = 0; i < _events.size(); ++i) {
+                result.push_back(_events[(_head + i) % _events.size()]);
+            }
+            return result;
+        }
+
+        [[nodiscard]]
+        inline uint64_t getRecordedCount() const {
+            return _recorded;
+        }
+
+        inline void clear() {
+            _events.clear();
+            _head = 0;
+            _recorded = 0;
+        }
+
+        friend std::ostream &operator<<(std::ostream &os, const ParseTrace &trace) {
+            for (const auto &event: trace.getEvents()) {
+                os << std::string(event.depth * 2, ' ')
+                   << (event.type == ParseTraceEvent::Type::ENTER ? "> " : "< ")
+                   << event.production << " @" << event.tokenIndex << "\n";
+            }
+            return os;
+        }
+
+        /**
+         * Records enter event on construction and exit event on destruction, including stack unwinding
+         */
+        struct Scope {
+            Scope(ParseTrace &trace, const char *production, const uint32_t &tokenIndex)
+                    : _trace(trace), _production(production), _tokenIndex(tokenIndex) {
+                _trace.enter(_production, _tokenIndex);
+            }
+
+            ~Scope() {
+                _trace.exit(_production, _tokenIndex);
+            }
+
+            Scope(const Scope &) = delete;
+
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            ParseTrace &_trace;
+            const char *_production;
+            const uint32_t &_tokenIndex;
+        };
+
+    private:
+        const size_t _capacity;
+        bool _enabled{false};
+        uint16_t _depth{0};
+
+        std::vector<ParseTraceEvent> _events;
+        size_t _head{0};
+        uint64_t _recorded{0};
+
+        inline void record(const ParseTraceEvent &event) {
+            ++_recorded;
+            if (_events.size() < _capacity) {
+                _events.push_back(event);
+            } else {
+                _events[_head] = event;
+                _head = (_head + 1) % _capacity;
+            }
+        }
+    };
+
+}
+
+#endif //AUX_PARSETRACE_H
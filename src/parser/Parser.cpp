@@ -2,6 +2,7 @@
 
 #include <utility>
 #include <unordered_set>
+#include <unordered_map>
 #include <glog/logging.h>
 #include "../exception/Exception.h"
 
@@ -12,24 +13,150 @@ using namespace aux::scanner;
 using namespace aux::parser;
 using namespace std;
 
-Parser::Parser(shared_ptr<IScanner> scanner) : _scanner(move(scanner)) {}
+Parser::Parser(shared_ptr<IScanner> scanner) : _cursor(move(scanner)) {}
 
 /**
  * Adapters on scanner functions:
  */
 
-shared_ptr<Token> Parser::peek() {
-    return _scanner->peek();
+shared_ptr<Token> Parser::peek(size_t k) {
+    return _cursor.peek(k);
 }
 
 shared_ptr<Token> Parser::next() {
-    return _scanner->next();
+    ++_tokenIndex;
+    auto token = _cursor.next();
+    _lastTokenRange = SourceRange::of(*token);
+    if (_listener) {
+        _lastToken = token;
+    }
+    return token;
 }
 
 void Parser::skipToken() {
     next();
 }
 
+/**
+ * Tree construction, skipped entirely when only validating:
+ */
+
+namespace {
+
+    /**
+     * Immutable stand-ins returned instead of newly allocated nodes when the tree is not built,
+     * they are never modified because @function Parser::append is a no-op in that mode
+     */
+    template<typename T>
+    struct Recognized;
+
+    template<> struct Recognized<BinTree> { static inline BinTree instance{}; };
+    template<> struct Recognized<ListTree> { static inline ListTree instance{}; };
+    template<> struct Recognized<TokenTree> { static inline TokenTree instance{nullptr}; };
+    template<> struct Recognized<ArgsTree> { static inline ArgsTree instance{shared_ptr<ListTree>{}}; };
+    template<> struct Recognized<FunctionCallSuffixTree> { static inline FunctionCallSuffixTree instance{nullptr}; };
+    template<> struct Recognized<ExprSuffixTree> { static inline ExprSuffixTree instance{shared_ptr<BaseTree>{}}; };
+    template<> struct Recognized<VariableTree> { static inline VariableTree instance{shared_ptr<BaseTree>{}, nullptr}; };
+    template<> struct Recognized<PrefixExprTree> { static inline PrefixExprTree instance{shared_ptr<BaseTree>{}, nullptr}; };
+    template<> struct Recognized<TermTree> { static inline TermTree instance{shared_ptr<Token>{}}; };
+    template<> struct Recognized<ForLoopTree> { static inline ForLoopTree instance{nullptr, nullptr, nullptr, nullptr}; };
+    template<> struct Recognized<ErrorTree> { static inline ErrorTree instance{nullptr}; };
+
+    /**
+     * Restores nesting depth of blocks and expression frames when a syntax error unwinds them
+     */
+    struct NestingScope {
+        explicit NestingScope(size_t &depth) : _depth(depth), _initial(depth) {}
+
+        ~NestingScope() {
+            _depth = _initial;
+        }
+
+    private:
+        size_t &_depth;
+        const size_t _initial;
+    };
+
+}
+
+template<typename T, typename... Args>
+shared_ptr<T> Parser::makeTree(Args &&... args) {
+    if (_buildTree) {
+        auto result = make_shared<T>(std::forward<Args>(args)...);
+        result->range = rangeOf(*result);
+        return result;
+    }
+
+    // Aliasing constructor with an empty owner: non-null, no allocation and no reference counting
+    return {shared_ptr<T>{}, &Recognized<T>::instance};
+}
+
+void Parser::append(const shared_ptr<ListTree> &list, const shared_ptr<BaseTree> &tree) const {
+    if (_buildTree) {
+        list->pushBack(tree);
+    }
+}
+
+SourceRange Parser::rangeOf(const BaseTree &tree) {
+    SourceRange result;
+    if (auto token = getOwnToken(tree)) {
+        result.cover(SourceRange::of(*token));
+    }
+    tree.forEachChild([&](const TreeChild &child) {
+        if (child.tree && !BaseTree::isEmptyList(*child.tree)) {
+            result.cover(child.tree->range);
+        } else if (child.token) {
+            result.cover(SourceRange::of(*child.token));
+        }
+    });
+
+    // Lists are built before their elements, they start at the next token and are extended by append
+    if (!result) {
+        return SourceRange::of(*peek());
+    }
+    // Error nodes start at the token on which parsing failed, which was not consumed
+    if (!_lastTokenRange.startsBefore(result)) {
+        result.cover(_lastTokenRange);
+    }
+    return result;
+}
+
+/**
+ * Reporting of parsed constructs, see ParseListener.h:
+ */
+
+namespace {
+
+    /**
+     * Unwinds the parser once the listener requested to stop, deliberately not a ParsingException
+     * so that error recovery does not intercept it
+     */
+    struct ParsingStopped {};
+
+}
+
+template<typename Event>
+void Parser::notify(void (ParseListener::*callback)(const Event &), const Event &event) {
+    (_listener->*callback)(event);
+    if (_listener->isStopRequested()) {
+        throw ParsingStopped{};
+    }
+}
+
+/**
+ * Tracing of productions, see ParseTrace.h:
+ */
+
+#ifdef AUX_PARSER_TRACE
+#define TRACE_PRODUCTION(_PRODUCTION_NAME) ParseTrace::Scope traceScope{_trace, _PRODUCTION_NAME, _tokenIndex}
+#else
+#define TRACE_PRODUCTION(_PRODUCTION_NAME)
+#endif
+
+ParseTrace &Parser::getTrace() {
+    return _trace;
+}
+
 /**
  * Exception Generation Helping Functions:
  */
@@ -81,55 +208,199 @@ void Parser::checkNextTokenTypeEquals(const TokenType &expected, bool isStatemen
  */
 
 shared_ptr<BaseTree> Parser::parse() {
+    auto result = parseBlock();
+
+    while (peek()->getType() != TokenType::EOF_OR_UNDEFINED) {
+        // Block stops at the first token that can not start a statement, e.g. unmatched 'end' or ')'
+        auto exception = ParsingException::statementErrorBuilder()
+                .addExpected("<Statement>")
+                .addExpected(*TokenType::EOF_OR_UNDEFINED)
+                .withActual(peek()->getRawValue())
+                .withSpan(peek()->getSpan())
+                .build();
+        if (auto error = recover(exception, _tokenIndex)) {
+            append(result, error);
+        }
+
+        auto rest = parseBlock();
+        for (const auto &statement: rest->trees) {
+            append(result, statement);
+        }
+    }
+
+    return result;
+}
+
+const vector<ParsingException> &Parser::validate() {
+    _buildTree = false;
+    parse();
+    _buildTree = true;
+    return _errors;
+}
+
+const vector<ParsingException> &Parser::parse(ParseListener &listener) {
+    _listener = &listener;
+    _buildTree = false;
+    try {
+        parse();
+    } catch (ParsingStopped &) {}
+    _buildTree = true;
+    _listener = nullptr;
+    _lastToken = nullptr;
+    return _errors;
+}
+
+const vector<ParsingException> &Parser::getErrors() const {
+    return _errors;
+}
+
+void Parser::recordFunctionBodies(bool record) {
+    _recordFunctionBodies = record;
+}
+
+const vector<FunctionBodyRegion> &Parser::getFunctionBodies() const {
+    return _functionBodies;
+}
+
+shared_ptr<BinTree> Parser::parseStandaloneFunctionBody() {
+    shared_ptr<BinTree> result;
     try {
-        return parseBlock();
+        result = parseFunctionBody();
     } catch (ParsingException &exception) {
-        LOG(FATAL) << exception.what() << "\n Exiting...";
+        _errors.push_back(exception);
+        return nullptr;
     }
+
+    if (!result || !_errors.empty() || peek()->getType() != TokenType::EOF_OR_UNDEFINED) {
+        return nullptr;
+    }
+    return result;
+}
+
+/**
+ * Panic-mode error recovery:
+ */
+
+bool Parser::isSynchronizingToken(const shared_ptr<Token> &token) {
+    static unordered_set<string> synchronizingTokens = {
+            *Operator::SEMI_COLON, *Operator::COLON_COLON,
+            *Keyword::BREAK, *Keyword::GOTO, *Keyword::DO, *Keyword::WHILE, *Keyword::REPEAT, *Keyword::IF,
+            *Keyword::FOR, *Keyword::FUNCTION, *Keyword::LOCAL, *Keyword::RETURN,
+            *Keyword::END, *Keyword::UNTIL, *Keyword::ELSE, *Keyword::ELSEIF
+    };
+
+    switch (token->getType()) {
+        case TokenType::EOF_OR_UNDEFINED:
+            return true;
+        case TokenType::KEYWORD:
+        case TokenType::OPERATOR:
+            return synchronizingTokens.contains(token->getRawValue());
+        default:
+            return false;
+    }
+}
+
+shared_ptr<ErrorTree> Parser::recover(const ParsingException &exception, uint32_t statementStart) {
+    // Error right at the token where the previous recovery stopped is a consequence of that recovery
+    bool isCascade = !_errors.empty() && _tokenIndex == _recoveredAt;
+
+    shared_ptr<ErrorTree> result{nullptr};
+    if (!isCascade) {
+        _errors.push_back(exception);
+        result = makeTree<ErrorTree>(peek());
+        if (_trace.isEnabled()) {
+            LOG(ERROR) << exception.what() << "Last parsed productions:\n" << _trace;
+        }
+        if (_listener) {
+            notify(&ParseListener::syntaxError, exception);
+        }
+    }
+
+    // Guarantees progress when the statement failed on its very first token
+    if (_tokenIndex == statementStart && peek()->getType() != TokenType::EOF_OR_UNDEFINED) {
+        skipToken();
+    }
+
+    while (!isSynchronizingToken(peek())) {
+        skipToken();
+    }
+
+    _recoveredAt = _tokenIndex;
+    return result;
 }
 
 
 shared_ptr<ListTree> Parser::parseBlock() {
-    LOG(INFO) << "Started Parsing Block from " + peek()->getRawValue() << " at : " << peek()->getSpan();
-    auto result = make_shared<ListTree>(ListTree::Type::STATEMENTS_LIST);
+    TRACE_PRODUCTION("Block");
+    NestingScope nesting{_nestingDepth};
+    NestingScope blockNesting{_blockDepth};
+    if (_explicitStack) {
+        enterNesting(_nestingDepth, _maxNestingDepth, "Nesting depth");
+        enterNesting(_blockDepth, MAX_BLOCK_NESTING_DEPTH, "Block nesting depth");
+    }
+
+    auto result = makeTree<ListTree>(ListTree::Type::STATEMENTS_LIST);
 
     while (true) {
-        auto statement = parseStatement();
-        if (!statement) {
-            break;
+        auto statementStart = _tokenIndex;
+        try {
+            auto firstToken = SourceRange::of(*peek());
+            auto statement = parseStatement();
+            if (!statement) {
+                break;
+            }
+            if (_buildTree) {
+                // Includes leading keywords and trailing 'end', which are not kept in the tree
+                statement->range.cover(firstToken);
+                statement->range.cover(_lastTokenRange);
+            }
+            append(result, statement);
+        } catch (ParsingException &exception) {
+            if (auto error = recover(exception, statementStart)) {
+                append(result, error);
+            }
         }
-        result->pushBack(statement);
     }
 
-    auto returnStatement = parseReturnStatement();
-    if (returnStatement) {
-        result->pushBack(returnStatement);
+    auto statementStart = _tokenIndex;
+    try {
+        auto returnStatement = parseReturnStatement();
+        if (returnStatement) {
+            if (_buildTree) {
+                returnStatement->range.cover(_lastTokenRange);
+            }
+            append(result, returnStatement);
+        }
+    } catch (ParsingException &exception) {
+        if (auto error = recover(exception, statementStart)) {
+            append(result, error);
+        }
     }
 
     return result;
 }
 
 shared_ptr<BaseTree> Parser::parseStatement() {
-    LOG(INFO) << "Started Parsing Statement from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Statement");
 
     if (peek()->getRawValue() == *Operator::SEMI_COLON || peek()->getRawValue() == *Keyword::BREAK) {
         auto op = next();
-        return make_shared<TokenTree>(op);
+        return makeTree<TokenTree>(op);
     } else if (peek()->getRawValue() == *Keyword::GOTO) {
         skipToken();
         checkNextTokenTypeEquals(TokenType::IDENTIFIER);
         auto identifier = next();
-        return make_shared<TokenTree>(TokenTree::Type::GOTO_IDENTIFIER, identifier);
+        return makeTree<TokenTree>(TokenTree::Type::GOTO_IDENTIFIER, identifier);
     } else if (peek()->getRawValue() == *Keyword::DO) {
         skipToken();
         auto block = parseBlock();
         checkNextTokenEquals(*Keyword::END), skipToken();
         return block;
     } else if (peek()->getRawValue() == *Keyword::LOCAL) {
-        skipToken();
-        auto funcDefinition = parseFunctionDefinition();
+        auto localKeyword = next();
+        auto funcDefinition = parseFunctionDefinition(true);
         if (funcDefinition) {
-            return make_shared<BinTree>(
+            return makeTree<BinTree>(
                     BinTree::Type::LOCAL_FUNCTION_DEFINITION,
                     funcDefinition->left, funcDefinition->right,
                     nullptr
@@ -144,13 +415,31 @@ shared_ptr<BaseTree> Parser::parseStatement() {
                         .withSpan(peek()->getSpan())
                         .build();
             }
-            if (peek()->getRawValue() == *Operator::EQUAL) {
+            auto names = _listener ? std::move(_lastNames) : vector<string>{};
+
+            shared_ptr<BinTree> result;
+            bool hasValues = peek()->getRawValue() == *Operator::EQUAL;
+            if (hasValues) {
                 auto op = next();
                 auto expList = parseExprList();
-                return make_shared<BinTree>(BinTree::Type::BINARY_OPERATION, attributeIdentifierList, expList, op);
+                if (!expList) {
+                    throw ParsingException::statementErrorBuilder()
+                            .addExpected("<Expression...>")
+                            .withActual(peek()->getRawValue() + " which is not valid <Expression>")
+                            .withSpan(peek()->getSpan())
+                            .build();
+                }
+                result = makeTree<BinTree>(BinTree::Type::BINARY_OPERATION, attributeIdentifierList, expList, op);
             } else {
-                return make_shared<BinTree>(BinTree::Type::BINARY_OPERATION, attributeIdentifierList, nullptr, nullptr);
+                result = makeTree<BinTree>(BinTree::Type::BINARY_OPERATION, attributeIdentifierList, nullptr, nullptr);
             }
+
+            if (_listener) {
+                notify(&ParseListener::localDeclaration, LocalDeclarationEvent{
+                        localKeyword->getSpan(), _lastToken->getSpan(), std::move(names), hasValues
+                });
+            }
+            return result;
         }
     }
     auto whileLoop = parseWhileLoop();
@@ -187,30 +476,35 @@ shared_ptr<BaseTree> Parser::parseStatement() {
 }
 
 shared_ptr<BinTree> Parser::parseAssignmentOrFunctionCall() {
-    LOG(INFO) << "Started Parsing Assignment or Function Call from " + peek()->getRawValue() << " at : "
-              << peek()->getSpan();
+    TRACE_PRODUCTION("Assignment or Function Call");
 
+    auto firstToken = peek();
     auto prefixExp = parsePrefixExpr();
     if (!prefixExp) {
         return nullptr;
     }
 
-    auto modifiersSize = prefixExp->suffixes->trees.size();
-    auto lastModifier = modifiersSize > 0 ? prefixExp->suffixes->trees[modifiersSize - 1] : nullptr;
-
-    if (lastModifier && dynamic_pointer_cast<FunctionCallSuffixTree>(lastModifier)) {
-        return make_shared<BinTree>(BinTree::Type::FUNCTION_CALL, nullptr, prefixExp, nullptr);
+    if (_prefixExprEndsWithCall) {
+        return makeTree<BinTree>(BinTree::Type::FUNCTION_CALL, nullptr, prefixExp, nullptr);
     } else {
         checkNextTokenIn({*Operator::COMMA, *Operator::EQUAL});
         if (peek()->getRawValue() == *Operator::COMMA) {
             skipToken();
         }
 
+        vector<string> targets;
+        if (_listener) {
+            targets.push_back(std::move(_lastPath));
+        }
+
         auto varList = parseVarList();
+        if (varList && _listener) {
+            targets.insert(targets.end(), _lastNames.begin(), _lastNames.end());
+        }
         if (!varList) {
-            varList = make_shared<ListTree>(ListTree::Type::VARIABLE_LIST);
-            varList->pushBack(prefixExp);
-        } else {
+            varList = makeTree<ListTree>(ListTree::Type::VARIABLE_LIST);
+            append(varList, prefixExp);
+        } else if (_buildTree) {
             varList->trees.insert(varList->trees.begin(), prefixExp);
         }
 
@@ -223,12 +517,18 @@ shared_ptr<BinTree> Parser::parseAssignmentOrFunctionCall() {
                     .withSpan(peek()->getSpan())
                     .build();
         }
-        return make_shared<BinTree>(BinTree::Type::BINARY_OPERATION, varList, exprList, op);
+
+        if (_listener) {
+            notify(&ParseListener::assignment, AssignmentEvent{
+                    firstToken->getSpan(), _lastToken->getSpan(), std::move(targets)
+            });
+        }
+        return makeTree<BinTree>(BinTree::Type::BINARY_OPERATION, varList, exprList, op);
     }
 }
 
 shared_ptr<ListTree> Parser::parseIfStatement() {
-    LOG(INFO) << "Started Parsing If Statement from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("If Statement");
 
     auto throwNoExpressionFoundError = [&]() {
         throw ParsingException::statementErrorBuilder()
@@ -243,14 +543,14 @@ shared_ptr<ListTree> Parser::parseIfStatement() {
     }
 
     skipToken();
-    auto result = make_shared<ListTree>(ListTree::Type::IF_THEN_ELSE);
+    auto result = makeTree<ListTree>(ListTree::Type::IF_THEN_ELSE);
     auto expr = parseExpr();
     if (!expr) {
         throwNoExpressionFoundError();
     }
     checkNextTokenEquals(*Keyword::THEN), skipToken();
     auto block = parseBlock();
-    result->pushBack(make_shared<BinTree>(BinTree::Type::IF_THEN, expr, block, nullptr));
+    append(result, makeTree<BinTree>(BinTree::Type::IF_THEN, expr, block, nullptr));
     while (peek()->getRawValue() == *Keyword::ELSEIF) {
         skipToken();
         expr = parseExpr();
@@ -259,13 +559,13 @@ shared_ptr<ListTree> Parser::parseIfStatement() {
         }
         checkNextTokenEquals(*Keyword::THEN), skipToken();
         block = parseBlock();
-        result->pushBack(make_shared<BinTree>(BinTree::Type::IF_THEN, expr, block, nullptr));
+        append(result, makeTree<BinTree>(BinTree::Type::IF_THEN, expr, block, nullptr));
     }
 
     if (peek()->getRawValue() == *Keyword::ELSE) {
         skipToken();
         block = parseBlock();
-        result->pushBack(make_shared<BinTree>(BinTree::Type::ELSE, nullptr, block, nullptr));
+        append(result, makeTree<BinTree>(BinTree::Type::ELSE, nullptr, block, nullptr));
     }
 
     checkNextTokenEquals(*Keyword::END), skipToken();
@@ -274,7 +574,7 @@ shared_ptr<ListTree> Parser::parseIfStatement() {
 }
 
 shared_ptr<BinTree> Parser::parseWhileLoop() {
-    LOG(INFO) << "Started Parsing While Loop from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("While Loop");
 
     auto throwNoExpressionFoundError = [&]() {
         throw ParsingException::statementErrorBuilder()
@@ -293,7 +593,7 @@ shared_ptr<BinTree> Parser::parseWhileLoop() {
         checkNextTokenEquals(*Keyword::DO), skipToken();
         auto block = parseBlock();
         checkNextTokenEquals(*Keyword::END), skipToken();
-        return make_shared<BinTree>(BinTree::Type::WHILE_LOOP, expr, block, nullptr);
+        return makeTree<BinTree>(BinTree::Type::WHILE_LOOP, expr, block, nullptr);
     } else if (peek()->getRawValue() == *Keyword::REPEAT) {
         skipToken();
         auto block = parseBlock();
@@ -302,20 +602,20 @@ shared_ptr<BinTree> Parser::parseWhileLoop() {
         if (!expr) {
             throwNoExpressionFoundError();
         }
-        return make_shared<BinTree>(BinTree::Type::REPEAT_UNTIL_LOOP, expr, block, nullptr);
+        return makeTree<BinTree>(BinTree::Type::REPEAT_UNTIL_LOOP, expr, block, nullptr);
     }
 
     return nullptr;
 }
 
-shared_ptr<BinTree> Parser::parseFunctionDefinition() {
-    LOG(INFO) << "Started Parsing Function Definition from " + peek()->getRawValue();
+shared_ptr<BinTree> Parser::parseFunctionDefinition(bool isLocal) {
+    TRACE_PRODUCTION("Function Definition");
 
     if (peek()->getRawValue() != *Keyword::FUNCTION) {
         return {nullptr};
     }
 
-    skipToken();
+    auto functionKeyword = next();
     auto identifier = parseFunctionIdentifier();
     if (!identifier) {
         throw ParsingException::statementErrorBuilder()
@@ -327,6 +627,9 @@ shared_ptr<BinTree> Parser::parseFunctionDefinition() {
                 .build();
     }
 
+    if (_listener) {
+        _functionEvent.emplace(FunctionEvent{functionKeyword->getSpan(), std::move(_lastPath), isLocal});
+    }
     auto funcBody = parseFunctionBody();
     if (!funcBody) {
         throw ParsingException::statementErrorBuilder()
@@ -336,11 +639,11 @@ shared_ptr<BinTree> Parser::parseFunctionDefinition() {
                 .build();
     }
 
-    return make_shared<BinTree>(BinTree::Type::FUNCTION_DEFINITION, identifier, funcBody, nullptr);
+    return makeTree<BinTree>(BinTree::Type::FUNCTION_DEFINITION, identifier, funcBody, nullptr);
 }
 
 shared_ptr<ForLoopTree> Parser::parseForLoop() {
-    LOG(INFO) << "Started Parsing For Loop from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("For Loop");
 
     if (peek()->getRawValue() != *Keyword::FOR) {
         return nullptr;
@@ -370,11 +673,11 @@ shared_ptr<ForLoopTree> Parser::parseForLoop() {
     auto block = parseBlock();
     checkNextTokenEquals(*Keyword::END), skipToken();
 
-    return make_shared<ForLoopTree>(identifierList, op, expList, block);
+    return makeTree<ForLoopTree>(identifierList, op, expList, block);
 }
 
 shared_ptr<BinTree> Parser::parseReturnStatement() {
-    LOG(INFO) << "Started Parsing Return statement from " + peek()->getRawValue() << " at : " << peek()->getSpan();;
+    TRACE_PRODUCTION("Return Statement");
 
     if (peek()->getRawValue() != *Keyword::RETURN) {
         return nullptr;
@@ -386,11 +689,11 @@ shared_ptr<BinTree> Parser::parseReturnStatement() {
         skipToken();
     }
 
-    return make_shared<BinTree>(BinTree::Type::BINARY_OPERATION, nullptr, exprList, returnKeyword);
+    return makeTree<BinTree>(BinTree::Type::BINARY_OPERATION, nullptr, exprList, returnKeyword);
 }
 
 shared_ptr<BinTree> Parser::parseAssignment() {
-    LOG(INFO) << "Started Parsing Assignment from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Assignment");
 
     auto varList = parseVarList();
     if (!varList) {
@@ -407,37 +710,53 @@ shared_ptr<BinTree> Parser::parseAssignment() {
                 .build();
     }
 
-    return make_shared<BinTree>(BinTree::Type::BINARY_OPERATION, varList, expressionList, tokEqual);
+    return makeTree<BinTree>(BinTree::Type::BINARY_OPERATION, varList, expressionList, tokEqual);
 }
 
 shared_ptr<ListTree> Parser::parseFunctionIdentifier() {
-    LOG(INFO) << "Started Parsing Function Identifier from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Function Identifier");
     if (peek()->getType() != TokenType::IDENTIFIER) {
         return {nullptr};
     }
 
-    auto result = make_shared<ListTree>(ListTree::Type::FUNCTION_IDENTIFIER_SEQUENCE);
-    result->pushBack(make_shared<TokenTree>(next()));
+    auto result = makeTree<ListTree>(ListTree::Type::FUNCTION_IDENTIFIER_SEQUENCE);
+    auto name = next();
+    append(result, makeTree<TokenTree>(name));
+    string path = _listener ? name->getRawValue() : "";
 
     while (peek()->getRawValue() == *Operator::DOT) {
         auto identifier = (skipToken(), checkNextTokenTypeEquals(TokenType::IDENTIFIER, STATEMENT_ERROR), next());
-        result->pushBack(make_shared<TokenTree>(TokenTree::Type::DOT_IDENTIFIER, identifier));
+        append(result, makeTree<TokenTree>(TokenTree::Type::DOT_IDENTIFIER, identifier));
+        if (_listener) {
+            path += *Operator::DOT + identifier->getRawValue();
+        }
     }
 
     if (peek()->getRawValue() == *Operator::COLON) {
         auto identifier = (skipToken(), checkNextTokenTypeEquals(TokenType::IDENTIFIER, STATEMENT_ERROR), next());
-        result->pushBack(make_shared<TokenTree>(TokenTree::Type::COLON_IDENTIFIER, identifier));
+        append(result, makeTree<TokenTree>(TokenTree::Type::COLON_IDENTIFIER, identifier));
+        if (_listener) {
+            path += *Operator::COLON + identifier->getRawValue();
+        }
     }
 
+    if (_listener) {
+        _lastPath = std::move(path);
+    }
     return result;
 
 }
 
 shared_ptr<BinTree> Parser::parseFunctionBody() {
-    LOG(INFO) << "Started Parsing Function Body from " + peek()->getRawValue() << " at : " << peek()->getSpan();;
+    TRACE_PRODUCTION("Function Body");
 
     if (peek()->getRawValue() == *Operator::LEFT_PARENTHESIS) {
-        skipToken();
+        auto leftParenthesis = next();
+        if (_listener && _functionEvent) {
+            auto event = std::move(*_functionEvent);
+            _functionEvent.reset();
+            notify(&ParseListener::enterFunction, event);
+        }
 
         auto parList = parseParList();
 
@@ -447,22 +766,30 @@ shared_ptr<BinTree> Parser::parseFunctionBody() {
         auto block = parseBlock();
 
         checkNextTokenEquals(*Keyword::END, STATEMENT_ERROR);
-        skipToken();
+        auto end = next();
+
+        if (_listener) {
+            notify(&ParseListener::exitFunction, end->getSpan());
+        }
 
-        return make_shared<BinTree>(BinTree::Type::FUNCTION_BODY, parList, block, nullptr);
+        auto result = makeTree<BinTree>(BinTree::Type::FUNCTION_BODY, parList, block, nullptr);
+        if (_recordFunctionBodies && _buildTree) {
+            _functionBodies.push_back({result, leftParenthesis, end});
+        }
+        return result;
     }
 
     return {nullptr};
 }
 
 shared_ptr<TokenTree> Parser::parseLabel() {
-    LOG(INFO) << "Started Parsing Label from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Label");
 
     if (peek()->getRawValue() == *Operator::COLON_COLON) {
         skipToken();
         checkNextTokenTypeEquals(TokenType::IDENTIFIER, STATEMENT_ERROR);
 
-        auto result = make_shared<TokenTree>(TokenTree::Type::LABEL, next());
+        auto result = makeTree<TokenTree>(TokenTree::Type::LABEL, next());
 
         checkNextTokenEquals(*Operator::COLON_COLON, STATEMENT_ERROR);
         skipToken();
@@ -473,27 +800,31 @@ shared_ptr<TokenTree> Parser::parseLabel() {
 }
 
 shared_ptr<ListTree> Parser::parseAttribIdentifierList() {
-    LOG(INFO) << "Started Parsing Attribute Identifiers List from " + peek()->getRawValue() << " at : "
-              << peek()->getSpan();
+    TRACE_PRODUCTION("Attribute Identifiers List");
     static unordered_set<string> separators = {*Operator::COMMA, *Operator::DOT_DOT_DOT};
 
     if (peek()->getType() != TokenType::IDENTIFIER) {
         return {nullptr};
     }
 
-    auto result = make_shared<ListTree>(ListTree::Type::ATTRIBUTE_IDENTIFIER_LIST);
+    auto result = makeTree<ListTree>(ListTree::Type::ATTRIBUTE_IDENTIFIER_LIST);
+    vector<string> names;
     auto parseAttributedIdentifier = [&]() {
         auto identifier = next();
+        if (_listener) {
+            names.push_back(identifier->getRawValue());
+        }
         auto attribute = parseAttribute();
         if (attribute) {
-            result->pushBack(
-                    make_shared<BinTree>(
+            append(
+                    result,
+                    makeTree<BinTree>(
                             BinTree::Type::ATTRIBUTE_IDENTIFIER,
-                            make_shared<TokenTree>(identifier), attribute, nullptr
+                            makeTree<TokenTree>(identifier), attribute, nullptr
                     )
             );
         } else {
-            result->pushBack(make_shared<TokenTree>(identifier));
+            append(result, makeTree<TokenTree>(identifier));
         }
     };
 
@@ -504,35 +835,39 @@ shared_ptr<ListTree> Parser::parseAttribIdentifierList() {
         parseAttributedIdentifier();
     }
 
+    if (_listener) {
+        _lastNames = std::move(names);
+    }
     return result;
 }
 
 shared_ptr<BaseTree> Parser::parseParList() {
-    LOG(INFO) << "Started Parsing Parameters List from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Parameters List");
     if (peek()->getRawValue() == *Operator::DOT_DOT_DOT) {
-        return make_shared<TokenTree>(TokenTree::Type::PARAMETER_LIST, next());
+        return makeTree<TokenTree>(TokenTree::Type::PARAMETER_LIST, next());
     }
 
-    return parseIdentifierList();
+    return parseIdentifierList(true);
 }
 
 shared_ptr<ListTree> Parser::parseIdentifierList(bool parseAdditionalDotDotDot) {
-    LOG(INFO) << "Started Parsing Identifier List from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Identifier List");
 
     if (peek()->getType() != TokenType::IDENTIFIER) {
         return {nullptr};
     }
 
-    auto result = make_shared<ListTree>(ListTree::Type::IDENTIFIER_LIST);
-    result->pushBack(make_shared<TokenTree>(next()));
+    auto result = makeTree<ListTree>(ListTree::Type::IDENTIFIER_LIST);
+    append(result, makeTree<TokenTree>(next()));
 
     while (peek()->getRawValue() == *Operator::COMMA) {
         skipToken();
 
         if (peek()->getType() == TokenType::IDENTIFIER) {
-            result->pushBack(make_shared<TokenTree>(next()));
+            append(result, makeTree<TokenTree>(next()));
         } else if (parseAdditionalDotDotDot && peek()->getRawValue() == *Operator::DOT_DOT_DOT) {
-            result->pushBack(make_shared<TokenTree>(TokenTree::Type::PARAMETER_LIST, next()));
+            append(result, makeTree<TokenTree>(TokenTree::Type::PARAMETER_LIST, next()));
+            break;
         } else {
             checkNextTokenIn({*Operator::DOT_DOT_DOT, *TokenType::IDENTIFIER}, STATEMENT_ERROR);
         }
@@ -542,11 +877,11 @@ shared_ptr<ListTree> Parser::parseIdentifierList(bool parseAdditionalDotDotDot)
 }
 
 shared_ptr<TokenTree> Parser::parseAttribute() {
-    LOG(INFO) << "Started Parsing Attribute from " + peek()->getRawValue();
+    TRACE_PRODUCTION("Attribute");
     if (peek()->getRawValue() == *Operator::LESS_THAN) {
         skipToken();
         checkNextTokenTypeEquals(TokenType::IDENTIFIER, STATEMENT_ERROR);
-        auto result = make_shared<TokenTree>(TokenTree::Type::ATTRIBUTE, next());
+        auto result = makeTree<TokenTree>(TokenTree::Type::ATTRIBUTE, next());
         checkNextTokenEquals(*Operator::GREATER_THAN, STATEMENT_ERROR);
         skipToken();
         return result;
@@ -555,11 +890,15 @@ shared_ptr<TokenTree> Parser::parseAttribute() {
 }
 
 shared_ptr<ListTree> Parser::parseExprList() {
-    auto expList = make_shared<ListTree>(ListTree::Type::EXPRESSION_LIST);
-
+    TRACE_PRODUCTION("Expression List");
     shared_ptr<BaseTree> exp = parseExpr();
+    if (!exp) {
+        return {nullptr};
+    }
+
+    auto expList = makeTree<ListTree>(ListTree::Type::EXPRESSION_LIST);
     while (true) {
-        expList->pushBack(exp);
+        append(expList, exp);
         if (peek()->getRawValue() == *Operator::COMMA) {
             skipToken();
             exp = parseExpr();
@@ -579,12 +918,18 @@ shared_ptr<ListTree> Parser::parseExprList() {
 }
 
 shared_ptr<BaseTree> Parser::parseExpr() {
-    LOG(INFO) << "Started Parsing Expression from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Expression");
+    if (_explicitStack) {
+        return parseExprWithExplicitStack();
+    }
 
     if (peek()->getRawValue() == *Operator::DOT_DOT_DOT) {
-        return make_shared<TokenTree>(next());
+        return makeTree<TokenTree>(next());
     } else if (peek()->getRawValue() == *Keyword::FUNCTION) {
-        skipToken();
+        auto functionKeyword = next();
+        if (_listener) {
+            _functionEvent.emplace(FunctionEvent{functionKeyword->getSpan(), "", false});
+        }
         auto functionDef = parseFunctionBody();
         if (functionDef) {
             return functionDef;
@@ -604,30 +949,594 @@ shared_ptr<BaseTree> Parser::parseExpr() {
     return {nullptr};
 }
 
+/**
+ * Expressions parsed with explicit stack, produce the same trees as their recursive counterparts:
+ */
+
+struct Parser::ExpressionFrame {
+    enum class Type : uint8_t {
+        EXPRESSION,
+        PREFIX_EXPRESSION,
+        EXPRESSION_LIST,
+        TABLE_CONSTRUCTOR
+    };
+
+    // Point to resume at once the child frame produced its result
+    enum class State : uint8_t {
+        START,
+
+        // Expression
+        AFTER_TABLE,
+        UNARY_TERM,
+        TERM,
+        AFTER_PREFIX_EXPRESSION,
+        AFTER_TERM,
+
+        // Prefix Expression
+        AFTER_PARENTHESIZED,
+        SUFFIX,
+        AFTER_INDEX,
+        AFTER_ARGUMENTS,
+        AFTER_TABLE_ARGUMENT,
+
+        // Expression List
+        AFTER_FIRST_EXPRESSION,
+        AFTER_NEXT_EXPRESSION,
+
+        // Table Constructor
+        FIELD,
+        AFTER_KEY,
+        AFTER_NAMED_VALUE,
+        AFTER_POSITIONAL_VALUE
+    };
+
+    struct PendingOperator {
+        shared_ptr<Token> token;
+        int precedence;
+    };
+
+    Type type;
+    State state{State::START};
+    // Opens a level of source nesting, counted against the limit of the parser
+    bool isNested{false};
+
+    // Expression: operands of binary operators and bases of '^' awaiting their right-hand side
+    vector<shared_ptr<BaseTree>> operands;
+    vector<PendingOperator> operators;
+    vector<shared_ptr<BaseTree>> exponentBases;
+    vector<shared_ptr<Token>> carets;
+    shared_ptr<Token> unaryOperator;
+
+    // Prefix Expression, Expression List and Table Constructor
+    shared_ptr<Token> token;
+    shared_ptr<BaseTree> expression;
+    shared_ptr<ListTree> list;
+
+    // Call arguments of Prefix Expression
+    shared_ptr<Token> method;
+    shared_ptr<Token> firstArgument;
+    uint32_t argumentsStart{0};
+
+    // Table fields
+    shared_ptr<Token> fieldOperator;
+    uint32_t fieldStart{0};
+    size_t fieldsCount{0};
+
+    // Dotted name tracked for the listener
+    bool isName{false};
+    string path;
+
+    explicit ExpressionFrame(Type type) : type(type) {}
+};
+
+namespace {
+
+    /**
+     * Precedence of binary operators matching the chain of recursive productions, all of them are left associative
+     * @return 0 if the token is not a binary operator
+     */
+    int binaryPrecedence(const shared_ptr<Token> &token) {
+        static unordered_map<string, int> precedence = {
+                {*Keyword::OR,           1},
+                {*Keyword::AND,          2},
+                {*Operator::LESS_THAN,   3}, {*Operator::GREATER_THAN, 3}, {*Operator::LT_EQUAL,    3},
+                {*Operator::GT_EQUAL,    3}, {*Operator::TILDA_EQUAL,  3}, {*Operator::EQUAL_EQUAL, 3},
+                {*Operator::VERTICAL_BAR, 4},
+                {*Operator::TILDA,       5},
+                {*Operator::AMPERSAND,   6},
+                {*Operator::LT_LT,       7}, {*Operator::GT_GT,        7},
+                {*Operator::DOT_DOT,     8},
+                {*Operator::PLUS,        9}, {*Operator::MINUS,        9},
+                {*Operator::ASTERISK,    10}, {*Operator::SLASH,       10},
+                {*Operator::SLASH_SLASH, 10}, {*Operator::PERCENT,     10}
+        };
+
+        auto it = precedence.find(token->getRawValue());
+        return it != precedence.end() ? it->second : 0;
+    }
+
+    bool isTerminal(const shared_ptr<Token> &token) {
+        static unordered_set<string> terminalKeywords = {*Keyword::NIL, *Keyword::TRUE, *Keyword::FALSE};
+
+        switch (token->getType()) {
+            case TokenType::NUMERIC_DOUBLE:
+            case TokenType::NUMERIC_HEX:
+            case TokenType::NUMERIC_DECIMAL:
+            case TokenType::STRING_LITERAL:
+                return true;
+            default:
+                return terminalKeywords.contains(token->getRawValue());
+        }
+    }
+
+}
+
+void Parser::useExplicitStack(size_t maxNestingDepth) {
+    _explicitStack = true;
+    _maxNestingDepth = maxNestingDepth;
+}
+
+void Parser::enterNesting(size_t &depth, size_t maxDepth, const string &name) {
+    if (depth >= maxDepth) {
+        throw ParsingException::statementErrorBuilder()
+                .addExpected("<" + name + " of at most " + to_string(maxDepth) + ">")
+                .withActual(peek()->getRawValue() + ", which is nested deeper")
+                .withSpan(peek()->getSpan())
+                .build();
+    }
+    ++depth;
+}
+
+void Parser::pushFrame(vector<ExpressionFrame> &stack, ExpressionFrame frame, bool isNested) {
+    if (isNested) {
+        enterNesting(_nestingDepth, _maxNestingDepth, "Nesting depth");
+    }
+    frame.isNested = isNested;
+    stack.push_back(std::move(frame));
+}
+
+void Parser::popFrame(vector<ExpressionFrame> &stack) {
+    if (stack.back().isNested) {
+        --_nestingDepth;
+    }
+    stack.pop_back();
+}
+
+shared_ptr<BaseTree> Parser::parseExprWithExplicitStack() {
+    using FrameType = ExpressionFrame::Type;
+
+    NestingScope nesting{_nestingDepth};
+    shared_ptr<BaseTree> result;
+
+    vector<ExpressionFrame> stack;
+    pushFrame(stack, ExpressionFrame{FrameType::EXPRESSION});
+    while (!stack.empty()) {
+        switch (stack.back().type) {
+            case FrameType::EXPRESSION:
+                stepExpression(stack, result);
+                break;
+            case FrameType::PREFIX_EXPRESSION:
+                stepPrefixExpression(stack, result);
+                break;
+            case FrameType::EXPRESSION_LIST:
+                stepExpressionList(stack, result);
+                break;
+            case FrameType::TABLE_CONSTRUCTOR:
+                stepTableConstructor(stack, result);
+                break;
+        }
+    }
+
+    return result;
+}
+
+void Parser::stepExpression(vector<ExpressionFrame> &stack, shared_ptr<BaseTree> &result) {
+    using FrameType = ExpressionFrame::Type;
+    using FrameState = ExpressionFrame::State;
+    static unordered_set<string> unaryOperators = {
+            *Keyword::NOT, *Operator::SHARP, *Operator::MINUS, *Operator::TILDA
+    };
+
+    auto &frame = stack.back();
+    shared_ptr<BaseTree> term;
+
+    while (true) {
+        switch (frame.state) {
+            case FrameState::START:
+                if (peek()->getRawValue() == *Operator::DOT_DOT_DOT) {
+                    result = makeTree<TokenTree>(next());
+                    return popFrame(stack);
+                } else if (peek()->getRawValue() == *Keyword::FUNCTION) {
+                    auto functionKeyword = next();
+                    if (_listener) {
+                        _functionEvent.emplace(FunctionEvent{functionKeyword->getSpan(), "", false});
+                    }
+                    result = parseFunctionBody();
+                    return popFrame(stack);
+                } else if (peek()->getRawValue() == *Operator::LEFT_CURLY_BRACE) {
+                    frame.state = FrameState::AFTER_TABLE;
+                    return pushFrame(stack, ExpressionFrame{FrameType::TABLE_CONSTRUCTOR}, true);
+                }
+                frame.state = FrameState::UNARY_TERM;
+                break;
+
+            case FrameState::AFTER_TABLE:
+                return popFrame(stack);
+
+            case FrameState::UNARY_TERM:
+                if (unaryOperators.contains(peek()->getRawValue())) {
+                    frame.unaryOperator = next();
+                }
+                frame.state = FrameState::TERM;
+                break;
+
+            case FrameState::TERM:
+                if (isTerminal(peek())) {
+                    term = makeTree<TermTree>(next());
+                } else if (peek()->getRawValue() == *Operator::LEFT_PARENTHESIS
+                           || peek()->getType() == TokenType::IDENTIFIER) {
+                    frame.state = FrameState::AFTER_PREFIX_EXPRESSION;
+                    return pushFrame(stack, ExpressionFrame{FrameType::PREFIX_EXPRESSION});
+                } else {
+                    term = nullptr;
+                }
+                frame.state = FrameState::AFTER_TERM;
+                break;
+
+            case FrameState::AFTER_PREFIX_EXPRESSION:
+                term = makeTree<TermTree>(static_pointer_cast<PrefixExprTree>(std::move(result)));
+                result = nullptr;
+                frame.state = FrameState::AFTER_TERM;
+                break;
+
+            case FrameState::AFTER_TERM: {
+                if (term && peek()->getRawValue() == *Operator::CARET) {
+                    frame.exponentBases.push_back(term);
+                    frame.carets.push_back(next());
+                    frame.state = FrameState::TERM;
+                    break;
+                }
+
+                // exponentTerm ::= term ['^' exponentTerm], folded from the innermost one
+                shared_ptr<BinTree> exponent;
+                if (term) {
+                    exponent = makeTree<BinTree>(BinTree::Type::BINARY_OPERATION, term, nullptr, nullptr);
+                } else if (!frame.exponentBases.empty()) {
+                    exponent = makeTree<BinTree>(
+                            BinTree::Type::BINARY_OPERATION,
+                            frame.exponentBases.back(), nullptr, frame.carets.back()
+                    );
+                    frame.exponentBases.pop_back(), frame.carets.pop_back();
+                }
+                while (!frame.exponentBases.empty()) {
+                    exponent = makeTree<BinTree>(
+                            BinTree::Type::BINARY_OPERATION,
+                            frame.exponentBases.back(), exponent, frame.carets.back()
+                    );
+                    frame.exponentBases.pop_back(), frame.carets.pop_back();
+                }
+
+                shared_ptr<BaseTree> operand = exponent;
+                if (frame.unaryOperator) {
+                    if (!exponent) {
+                        throw ParsingException::expressionErrorBuilder()
+                                .addExpected("<Expression>")
+                                .withActual("<Undefined>")
+                                .withSpan(frame.unaryOperator->getSpan())
+                                .build();
+                    }
+                    operand = makeTree<BinTree>(BinTree::Type::UNARY_OPERATION, nullptr, exponent, frame.unaryOperator);
+                    frame.unaryOperator = nullptr;
+                }
+
+                // Only the leftmost operand may be missing, as it is in the recursive productions
+                if (!operand && !frame.operators.empty()) {
+                    throw ParsingException::expressionErrorBuilder()
+                            .addExpected("<Expression>")
+                            .withActual("<Undefined>")
+                            .withSpan(frame.operators.back().token->getSpan())
+                            .build();
+                }
+                frame.operands.push_back(operand);
+
+                auto precedence = binaryPrecedence(peek());
+                while (!frame.operators.empty() && frame.operators.back().precedence >= precedence) {
+                    auto right = std::move(frame.operands.back());
+                    frame.operands.pop_back();
+                    auto left = std::move(frame.operands.back());
+                    frame.operands.pop_back();
+                    frame.operands.push_back(makeTree<BinTree>(
+                            BinTree::Type::BINARY_OPERATION,
+                            left, right, frame.operators.back().token
+                    ));
+                    frame.operators.pop_back();
+                }
+
+                if (precedence > 0) {
+                    frame.operators.push_back({next(), precedence});
+                    frame.state = FrameState::UNARY_TERM;
+                    term = nullptr;
+                    break;
+                }
+
+                result = frame.operands.front();
+                return popFrame(stack);
+            }
+
+            default:
+                LOG(FATAL) << "Unexpected state of expression frame";
+        }
+    }
+}
+
+void Parser::stepPrefixExpression(vector<ExpressionFrame> &stack, shared_ptr<BaseTree> &result) {
+    using FrameType = ExpressionFrame::Type;
+    using FrameState = ExpressionFrame::State;
+
+    auto &frame = stack.back();
+
+    auto completeCall = [&](const shared_ptr<ArgsTree> &args, optional<string> literalArgument) {
+        append(frame.list, makeTree<FunctionCallSuffixTree>(args, static_pointer_cast<TokenIdentifier>(frame.method)));
+        if (_listener) {
+            auto method = frame.method ? *Operator::COLON + frame.method->getRawValue() : "";
+            notify(&ParseListener::call, CallEvent{
+                    frame.token->getSpan(), _lastToken->getSpan(),
+                    frame.isName ? frame.path + method : "", std::move(literalArgument)
+            });
+        }
+        frame.isName = false;
+        frame.state = FrameState::SUFFIX;
+    };
+
+    while (true) {
+        switch (frame.state) {
+            case FrameState::START:
+                frame.list = makeTree<ListTree>(ListTree::Type::PE_SUFFIX_LIST);
+                frame.token = next();
+                if (frame.token->getRawValue() == *Operator::LEFT_PARENTHESIS) {
+                    frame.state = FrameState::AFTER_PARENTHESIZED;
+                    return pushFrame(stack, ExpressionFrame{FrameType::EXPRESSION}, true);
+                }
+                frame.isName = _listener != nullptr;
+                frame.path = frame.isName ? frame.token->getRawValue() : "";
+                frame.state = FrameState::SUFFIX;
+                break;
+
+            case FrameState::AFTER_PARENTHESIZED:
+                frame.expression = std::move(result);
+                checkNextTokenEquals(*Operator::RIGHT_PARENTHESIS);
+                skipToken();
+                frame.state = FrameState::SUFFIX;
+                break;
+
+            case FrameState::AFTER_INDEX:
+                checkNextTokenEquals(*Operator::RIGHT_BRACKET);
+                skipToken();
+                append(frame.list, makeTree<ExprSuffixTree>(std::move(result)));
+                frame.state = FrameState::SUFFIX;
+                break;
+
+            case FrameState::AFTER_ARGUMENTS: {
+                auto arguments = result ? static_pointer_cast<ListTree>(std::move(result))
+                                        : makeTree<ListTree>(ListTree::Type::EXPRESSION_LIST);
+                checkNextTokenEquals(*Operator::RIGHT_PARENTHESIS);
+                skipToken();
+
+                optional<string> literalArgument;
+                if (_listener && frame.firstArgument->getType() == TokenType::STRING_LITERAL
+                    && _tokenIndex == frame.argumentsStart + 2) {
+                    literalArgument = frame.firstArgument->getRawValue();
+                }
+                completeCall(makeTree<ArgsTree>(arguments), std::move(literalArgument));
+                break;
+            }
+
+            case FrameState::AFTER_TABLE_ARGUMENT:
+                completeCall(makeTree<ArgsTree>(static_pointer_cast<ListTree>(std::move(result))), nullopt);
+                break;
+
+            case FrameState::SUFFIX:
+                if (peek()->getRawValue() == *Operator::LEFT_BRACKET) {
+                    skipToken();
+                    frame.isName = false;
+                    frame.state = FrameState::AFTER_INDEX;
+                    return pushFrame(stack, ExpressionFrame{FrameType::EXPRESSION}, true);
+                } else if (peek()->getRawValue() == *Operator::DOT) {
+                    skipToken();
+                    checkNextTokenTypeEquals(TokenType::IDENTIFIER);
+                    auto identifier = next();
+                    append(frame.list, makeTree<ExprSuffixTree>(static_pointer_cast<TokenIdentifier>(identifier)));
+                    if (frame.isName) {
+                        frame.path += *Operator::DOT + identifier->getRawValue();
+                    }
+                    break;
+                } else if (peek()->getType() != TokenType::EOF_OR_UNDEFINED) {
+                    frame.method = nullptr;
+                    if (peek()->getRawValue() == *Operator::COLON) {
+                        skipToken();
+                        checkNextTokenTypeEquals(TokenType::IDENTIFIER);
+                        frame.method = next();
+                    }
+
+                    if (peek()->getRawValue() == *Operator::LEFT_PARENTHESIS) {
+                        skipToken();
+                        frame.argumentsStart = _tokenIndex;
+                        frame.firstArgument = peek();
+                        frame.state = FrameState::AFTER_ARGUMENTS;
+                        return pushFrame(stack, ExpressionFrame{FrameType::EXPRESSION_LIST}, true);
+                    } else if (peek()->getType() == TokenType::STRING_LITERAL) {
+                        auto literal = next();
+                        completeCall(
+                                makeTree<ArgsTree>(static_pointer_cast<TokenStringLiteral>(literal)),
+                                _listener ? make_optional(literal->getRawValue()) : nullopt
+                        );
+                        break;
+                    } else if (peek()->getRawValue() == *Operator::LEFT_CURLY_BRACE) {
+                        frame.state = FrameState::AFTER_TABLE_ARGUMENT;
+                        return pushFrame(stack, ExpressionFrame{FrameType::TABLE_CONSTRUCTOR}, true);
+                    }
+                }
+
+                if (frame.expression) {
+                    result = makeTree<PrefixExprTree>(frame.expression, frame.list);
+                } else {
+                    result = makeTree<PrefixExprTree>(static_pointer_cast<TokenIdentifier>(frame.token), frame.list);
+                }
+                return popFrame(stack);
+
+            default:
+                LOG(FATAL) << "Unexpected state of prefix expression frame";
+        }
+    }
+}
+
+void Parser::stepExpressionList(vector<ExpressionFrame> &stack, shared_ptr<BaseTree> &result) {
+    using FrameType = ExpressionFrame::Type;
+    using FrameState = ExpressionFrame::State;
+
+    auto &frame = stack.back();
+
+    switch (frame.state) {
+        case FrameState::START:
+            frame.state = FrameState::AFTER_FIRST_EXPRESSION;
+            return pushFrame(stack, ExpressionFrame{FrameType::EXPRESSION});
+
+        case FrameState::AFTER_FIRST_EXPRESSION:
+            if (!result) {
+                return popFrame(stack);
+            }
+            frame.list = makeTree<ListTree>(ListTree::Type::EXPRESSION_LIST);
+            break;
+
+        case FrameState::AFTER_NEXT_EXPRESSION:
+            if (!result) {
+                throw ParsingException::expressionErrorBuilder()
+                        .addExpected("<, Expression>")
+                        .withActual("<, None>")
+                        .withSpan(peek()->getSpan())
+                        .build();
+            }
+            break;
+
+        default:
+            LOG(FATAL) << "Unexpected state of expression list frame";
+    }
+
+    append(frame.list, result);
+    if (peek()->getRawValue() == *Operator::COMMA) {
+        skipToken();
+        frame.state = FrameState::AFTER_NEXT_EXPRESSION;
+        return pushFrame(stack, ExpressionFrame{FrameType::EXPRESSION});
+    }
+
+    result = frame.list;
+    popFrame(stack);
+}
+
+void Parser::stepTableConstructor(vector<ExpressionFrame> &stack, shared_ptr<BaseTree> &result) {
+    using FrameType = ExpressionFrame::Type;
+    using FrameState = ExpressionFrame::State;
+    static unordered_set<string> separators = {*Operator::COMMA, *Operator::SEMI_COLON};
+
+    auto &frame = stack.back();
+    shared_ptr<BinTree> field;
+
+    switch (frame.state) {
+        case FrameState::START:
+            frame.token = next();
+            frame.list = makeTree<ListTree>(ListTree::Type::TABLE_FIELD_LIST);
+            if (peek()->getRawValue() == *Operator::RIGHT_CURLY_BRACE) {
+                skipToken();
+                break;
+            }
+            frame.state = FrameState::FIELD;
+            [[fallthrough]];
+
+        case FrameState::FIELD:
+            frame.fieldStart = _tokenIndex;
+            if (peek()->getRawValue() == *Operator::LEFT_BRACKET) {
+                skipToken();
+                frame.state = FrameState::AFTER_KEY;
+            } else if (atNamedTableField()) {
+                frame.expression = makeTree<TokenTree>(next());
+                checkNextTokenEquals(*Operator::EQUAL);
+                frame.fieldOperator = next();
+                frame.state = FrameState::AFTER_NAMED_VALUE;
+            } else {
+                frame.state = FrameState::AFTER_POSITIONAL_VALUE;
+            }
+            return pushFrame(stack, ExpressionFrame{FrameType::EXPRESSION},
+                             frame.state == FrameState::AFTER_KEY);
+
+        case FrameState::AFTER_KEY:
+            frame.expression = std::move(result);
+            checkNextTokenEquals(*Operator::RIGHT_BRACKET);
+            skipToken();
+            checkNextTokenEquals(*Operator::EQUAL);
+            frame.fieldOperator = next();
+            frame.state = FrameState::AFTER_NAMED_VALUE;
+            return pushFrame(stack, ExpressionFrame{FrameType::EXPRESSION});
+
+        case FrameState::AFTER_NAMED_VALUE:
+            field = makeTree<BinTree>(
+                    BinTree::Type::TABLE_FIELD_DECLARATION,
+                    frame.expression, result, frame.fieldOperator
+            );
+            break;
+
+        case FrameState::AFTER_POSITIONAL_VALUE:
+            field = makeTree<BinTree>(BinTree::Type::TABLE_FIELD_DECLARATION, result, nullptr, nullptr);
+            break;
+
+        default:
+            LOG(FATAL) << "Unexpected state of table constructor frame";
+    }
+
+    if (field) {
+        append(frame.list, field);
+        // Trailing separator is followed by an empty field
+        frame.fieldsCount += frame.fieldsCount == 0 || _tokenIndex != frame.fieldStart;
+
+        if (separators.contains(peek()->getRawValue())) {
+            skipToken();
+            frame.state = FrameState::FIELD;
+            return;
+        }
+
+        checkNextTokenEquals(*Operator::RIGHT_CURLY_BRACE);
+        skipToken();
+    }
+
+    if (_listener) {
+        notify(&ParseListener::tableConstructor, TableConstructorEvent{
+                frame.token->getSpan(), _lastToken->getSpan(), frame.fieldsCount
+        });
+    }
+    result = frame.list;
+    popFrame(stack);
+}
+
 shared_ptr<PrefixExprTree> Parser::parseFunctionCall() {
-    LOG(INFO) << "Started Parsing Function Call from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Function Call");
     auto prefixExpr = parsePrefixExpr();
-
-    auto &suffixes = prefixExpr->suffixes->trees;
-    if (suffixes.empty()) {
+    if (!prefixExpr) {
         return {nullptr};
     }
 
-    auto &lastSuffix = suffixes[suffixes.size() - 1];
-    if (dynamic_pointer_cast<FunctionCallSuffixTree>(lastSuffix)) {
+    if (_prefixExprEndsWithCall) {
         return prefixExpr;
     } else {
         throw ParsingException::expressionErrorBuilder()
                 .addExpected("(<List of Arguments>)")
-                .withActual(lastSuffix->getPrintValue()) // todo: change?
-                        // todo: add Span
+                .withActual(peek()->getRawValue())
+                .withSpan(peek()->getSpan())
                 .build();
     }
 
 }
 
 shared_ptr<PrefixExprTree> Parser::parsePrefixExpr() {
-    LOG(INFO) << "Started Parsing Prefix Expression from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Prefix Expression");
     auto token = peek();
     shared_ptr<BaseTree> expression{nullptr};
     if (token->getRawValue() == *Operator::LEFT_PARENTHESIS) {
@@ -642,38 +1551,67 @@ shared_ptr<PrefixExprTree> Parser::parsePrefixExpr() {
         token = next();
     }
 
-    auto suffixes = make_shared<ListTree>(ListTree::Type::PE_SUFFIX_LIST);
+    auto suffixes = makeTree<ListTree>(ListTree::Type::PE_SUFFIX_LIST);
+    bool endsWithCall = false;
+
+    // Dotted name of the expression as long as it consists of identifiers only, e.g. "string.format"
+    bool isName = _listener && !expression;
+    string path = isName ? token->getRawValue() : "";
+
     while (true) {
+        bool isDotSuffix = isName && peek()->getRawValue() == *Operator::DOT;
         auto peTree = parsePrefixExprSuffix();
         if (peTree) {
-            suffixes->pushBack(peTree);
+            append(suffixes, peTree);
+            endsWithCall = false;
+            if (isDotSuffix) {
+                path += *Operator::DOT + _lastToken->getRawValue();
+            } else {
+                isName = false;
+            }
         } else {
             auto funcCall = parseFuncCallSuffix();
             if (funcCall) {
-                suffixes->pushBack(funcCall);
+                append(suffixes, funcCall);
+                endsWithCall = true;
+                if (_listener) {
+                    notify(&ParseListener::call, CallEvent{
+                            token->getSpan(), _lastToken->getSpan(),
+                            isName ? path + _lastMethod : "", _lastLiteralArgument
+                    });
+                }
+                isName = false;
             } else {
                 break;
             }
         }
     }
+    _prefixExprEndsWithCall = endsWithCall;
+    if (_listener) {
+        _lastPath = isName ? std::move(path) : "";
+    }
 
     if (expression) {
-        return make_shared<PrefixExprTree>(expression, suffixes);
+        return makeTree<PrefixExprTree>(expression, suffixes);
     } else {
-        return make_shared<PrefixExprTree>(static_pointer_cast<TokenIdentifier>(token), suffixes);
+        return makeTree<PrefixExprTree>(static_pointer_cast<TokenIdentifier>(token), suffixes);
     }
 }
 
 shared_ptr<ListTree> Parser::parseVarList() {
-    LOG(INFO) << "Started Parsing Variable List from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Variable List");
 
     auto var = parseVariable();
     if (!var) {
         return nullptr;
     }
 
-    auto result = make_shared<ListTree>(ListTree::Type::VARIABLE_LIST);
-    result->pushBack(var);
+    auto result = makeTree<ListTree>(ListTree::Type::VARIABLE_LIST);
+    append(result, var);
+    vector<string> paths;
+    if (_listener) {
+        paths.push_back(std::move(_lastPath));
+    }
     while (peek()->getRawValue() == *Operator::COMMA) {
         var = (skipToken(), parseVariable());
         if (!var) {
@@ -683,14 +1621,20 @@ shared_ptr<ListTree> Parser::parseVarList() {
                     .withSpan(peek()->getSpan())
                     .build();
         }
-        result->pushBack(var);
+        append(result, var);
+        if (_listener) {
+            paths.push_back(std::move(_lastPath));
+        }
     }
 
+    if (_listener) {
+        _lastNames = std::move(paths);
+    }
     return result;
 }
 
 shared_ptr<VariableTree> Parser::parseVariable() {
-    LOG(INFO) << "Started Parsing Variable from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Variable");
     auto token = peek();
     shared_ptr<BaseTree> expression{nullptr};
 
@@ -705,39 +1649,53 @@ shared_ptr<VariableTree> Parser::parseVariable() {
         token = next();
     }
 
-    auto suffix = make_shared<ListTree>(ListTree::Type::PE_SUFFIX_LIST);
-    shared_ptr<ExprSuffixTree> peTree;
-    while ((peTree = parsePrefixExprSuffix())) {
-        suffix->pushBack(peTree);
+    auto suffix = makeTree<ListTree>(ListTree::Type::PE_SUFFIX_LIST);
+    bool isName = _listener && !expression;
+    string path = isName ? token->getRawValue() : "";
+
+    while (true) {
+        bool isDotSuffix = isName && peek()->getRawValue() == *Operator::DOT;
+        auto peTree = parsePrefixExprSuffix();
+        if (!peTree) {
+            break;
+        }
+        append(suffix, peTree);
+        if (isDotSuffix) {
+            path += *Operator::DOT + _lastToken->getRawValue();
+        } else {
+            isName = false;
+        }
+    }
+    if (_listener) {
+        _lastPath = isName ? std::move(path) : "";
     }
 
     if (expression) {
-        return make_shared<VariableTree>(expression, suffix);
+        return makeTree<VariableTree>(expression, suffix);
     } else {
-        return make_shared<VariableTree>(static_pointer_cast<TokenIdentifier>(token), suffix);
+        return makeTree<VariableTree>(static_pointer_cast<TokenIdentifier>(token), suffix);
     }
 }
 
 shared_ptr<ExprSuffixTree> Parser::parsePrefixExprSuffix() {
-    LOG(INFO) << "Started Parsing Prefix Expression Suffix from " + peek()->getRawValue() << " at : "
-              << peek()->getSpan();
+    TRACE_PRODUCTION("Prefix Expression Suffix");
     if (peek()->getRawValue() == *Operator::LEFT_BRACKET) {
         skipToken();
         auto exp = parseExpr();
         checkNextTokenEquals(*Operator::RIGHT_BRACKET);
         skipToken();
-        return make_shared<ExprSuffixTree>(exp);
+        return makeTree<ExprSuffixTree>(exp);
     } else if (peek()->getRawValue() == *Operator::DOT) {
         skipToken();
         checkNextTokenTypeEquals(TokenType::IDENTIFIER);
-        return make_shared<ExprSuffixTree>(static_pointer_cast<TokenIdentifier>(next()));
+        return makeTree<ExprSuffixTree>(static_pointer_cast<TokenIdentifier>(next()));
     }
 
     return {nullptr};
 }
 
 shared_ptr<FunctionCallSuffixTree> Parser::parseFuncCallSuffix() {
-    LOG(INFO) << "Started Parsing Function Call Suffix from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Function Call Suffix");
 
     if (peek()->getType() == TokenType::EOF_OR_UNDEFINED) {
         return {nullptr};
@@ -752,27 +1710,47 @@ shared_ptr<FunctionCallSuffixTree> Parser::parseFuncCallSuffix() {
 
     auto args = parseArgs();
     if (args) {
-        return make_shared<FunctionCallSuffixTree>(args, static_pointer_cast<TokenIdentifier>(identifier));
+        if (_listener) {
+            _lastMethod = identifier ? *Operator::COLON + identifier->getRawValue() : "";
+        }
+        return makeTree<FunctionCallSuffixTree>(args, static_pointer_cast<TokenIdentifier>(identifier));
     } else {
         return {nullptr};
     }
 }
 
 shared_ptr<ArgsTree> Parser::parseArgs() {
-    LOG(INFO) << "Started Parsing Args from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Args");
 
     if (peek()->getRawValue() == *Operator::LEFT_PARENTHESIS) {
         skipToken();
+        auto argumentsStart = _tokenIndex;
+        auto firstArgument = peek();
         auto result = parseExprList();
+        if (!result) {
+            result = makeTree<ListTree>(ListTree::Type::EXPRESSION_LIST);
+        }
         checkNextTokenEquals(*Operator::RIGHT_PARENTHESIS);
         skipToken();
-        return make_shared<ArgsTree>(result);
+        if (_listener) {
+            bool isSingleLiteral = firstArgument->getType() == TokenType::STRING_LITERAL
+                                   && _tokenIndex == argumentsStart + 2;
+            _lastLiteralArgument = isSingleLiteral ? make_optional(firstArgument->getRawValue()) : nullopt;
+        }
+        return makeTree<ArgsTree>(result);
     } else if (peek()->getType() == TokenType::STRING_LITERAL) {
-        return make_shared<ArgsTree>(dynamic_pointer_cast<TokenStringLiteral>(next()));
+        auto literal = next();
+        if (_listener) {
+            _lastLiteralArgument = literal->getRawValue();
+        }
+        return makeTree<ArgsTree>(static_pointer_cast<TokenStringLiteral>(literal));
     } else {
         auto tableConstructor = parseTableConstructor();
         if (tableConstructor) {
-            return make_shared<ArgsTree>(tableConstructor);
+            if (_listener) {
+                _lastLiteralArgument = nullopt;
+            }
+            return makeTree<ArgsTree>(tableConstructor);
         } else {
             return {nullptr};
         }
@@ -781,18 +1759,26 @@ shared_ptr<ArgsTree> Parser::parseArgs() {
 }
 
 shared_ptr<ListTree> Parser::parseTableConstructor() {
-    LOG(INFO) << "Started Parsing Table Constructor from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Table Constructor");
     if (peek()->getRawValue() == *Operator::LEFT_CURLY_BRACE) {
-        skipToken();
+        auto leftBrace = next();
 
+        shared_ptr<ListTree> result;
         if (peek()->getRawValue() == *Operator::RIGHT_CURLY_BRACE) {
             skipToken();
-            return make_shared<ListTree>(ListTree::Type::TABLE_FIELD_LIST);
+            result = makeTree<ListTree>(ListTree::Type::TABLE_FIELD_LIST);
+            _lastFieldsCount = 0;
+        } else {
+            result = parseTableFieldList();
+            checkNextTokenEquals(*Operator::RIGHT_CURLY_BRACE);
+            skipToken();
         }
 
-        auto result = parseTableFieldList();
-        checkNextTokenEquals(*Operator::RIGHT_CURLY_BRACE);
-        skipToken();
+        if (_listener) {
+            notify(&ParseListener::tableConstructor, TableConstructorEvent{
+                    leftBrace->getSpan(), _lastToken->getSpan(), _lastFieldsCount
+            });
+        }
         return result;
     }
 
@@ -800,20 +1786,25 @@ shared_ptr<ListTree> Parser::parseTableConstructor() {
 }
 
 shared_ptr<ListTree> Parser::parseTableFieldList() {
-    LOG(INFO) << "Started Parsing Table Field List from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Table Field List");
     static unordered_set<string> separators = {*Operator::COMMA, *Operator::SEMI_COLON};
 
-    auto result = make_shared<ListTree>(ListTree::Type::TABLE_FIELD_LIST);
-    result->pushBack(parseTableField());
+    auto result = makeTree<ListTree>(ListTree::Type::TABLE_FIELD_LIST);
+    append(result, parseTableField());
+    size_t fieldsCount = 1;
     while (true) {
         if (separators.contains(peek()->getRawValue())) {
             skipToken();
+            auto fieldStart = _tokenIndex;
             auto field = parseTableField();
-            result->pushBack(field);
+            append(result, field);
+            // Trailing separator is followed by an empty field
+            fieldsCount += _tokenIndex != fieldStart;
         } else {
             break;
         }
     }
+    _lastFieldsCount = fieldsCount;
 
     if (separators.contains(peek()->getRawValue())) {
         skipToken();
@@ -823,7 +1814,7 @@ shared_ptr<ListTree> Parser::parseTableFieldList() {
 }
 
 shared_ptr<BinTree> Parser::parseTableField() {
-    LOG(INFO) << "Started Parsing Table Field from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Table Field");
     if (peek()->getRawValue() == *Operator::LEFT_BRACKET) {
         skipToken();
         auto left = parseExpr();
@@ -835,34 +1826,40 @@ shared_ptr<BinTree> Parser::parseTableField() {
         auto opToken = next();
         auto right = parseExpr();
 
-        return make_shared<BinTree>(BinTree::Type::TABLE_FIELD_DECLARATION, left, right, opToken);
-    } else if (peek()->getType() == TokenType::IDENTIFIER) {
-        shared_ptr<BaseTree> identifier = make_shared<TokenTree>(_scanner->next());
+        return makeTree<BinTree>(BinTree::Type::TABLE_FIELD_DECLARATION, left, right, opToken);
+    } else if (atNamedTableField()) {
+        shared_ptr<BaseTree> identifier = makeTree<TokenTree>(next());
         checkNextTokenEquals(*Operator::EQUAL);
         auto op = next();
         auto right = parseExpr();
 
-        return make_shared<BinTree>(
+        return makeTree<BinTree>(
                 BinTree::Type::TABLE_FIELD_DECLARATION,
                 identifier, right, op
         );
     } else {
-        return make_shared<BinTree>(
+        return makeTree<BinTree>(
                 BinTree::Type::TABLE_FIELD_DECLARATION,
                 parseExpr(), nullptr, nullptr
         );
     }
 }
 
+bool Parser::atNamedTableField() {
+    return peek()->getType() == TokenType::IDENTIFIER
+           && peek(1)->getType() == TokenType::OPERATOR
+           && peek(1)->getRawValue() == *Operator::EQUAL;
+}
+
 shared_ptr<BinTree> Parser::parseArlExpr() {
-    LOG(INFO) << "Started Parsing Logical Or Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Logical Or Term");
 
     auto result = parseLogicalAndTerm();
     while (peek()->getRawValue() == *Keyword::OR) {
         auto op = next();
         auto right = parseLogicalAndTerm();
         if (right) {
-            result = make_shared<BinTree>(
+            result = makeTree<BinTree>(
                     BinTree::Type::BINARY_OPERATION,
                     result, right, op
             );
@@ -880,14 +1877,14 @@ shared_ptr<BinTree> Parser::parseArlExpr() {
 
 
 shared_ptr<BinTree> Parser::parseLogicalAndTerm() {
-    LOG(INFO) << "Started Parsing Logical And Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Logical And Term");
 
     auto result = parseRelationalTerm();
     while (peek()->getRawValue() == *Keyword::AND) {
         auto op = next();
         auto right = parseRelationalTerm();
         if (right) {
-            result = make_shared<BinTree>(
+            result = makeTree<BinTree>(
                     BinTree::Type::BINARY_OPERATION,
                     result, right, op
             );
@@ -904,7 +1901,7 @@ shared_ptr<BinTree> Parser::parseLogicalAndTerm() {
 }
 
 shared_ptr<BinTree> Parser::parseRelationalTerm() {
-    LOG(INFO) << "Started Parsing Relational Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Relational Term");
     static unordered_set<string> relationalOperators = {
             *Operator::LESS_THAN, *Operator::GREATER_THAN, *Operator::LT_EQUAL,
             *Operator::GT_EQUAL, *Operator::TILDA_EQUAL, *Operator::EQUAL_EQUAL
@@ -915,7 +1912,7 @@ shared_ptr<BinTree> Parser::parseRelationalTerm() {
         auto op = next();
         auto right = parseBitwiseOrTerm();
         if (right) {
-            result = make_shared<BinTree>(
+            result = makeTree<BinTree>(
                     BinTree::Type::BINARY_OPERATION,
                     result, right, op
             );
@@ -932,14 +1929,14 @@ shared_ptr<BinTree> Parser::parseRelationalTerm() {
 }
 
 shared_ptr<BinTree> Parser::parseBitwiseOrTerm() {
-    LOG(INFO) << "Started Parsing Bitwise Or Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Bitwise Or Term");
 
     auto result = parseBitwiseXorTerm();
     while (peek()->getRawValue() == *Operator::VERTICAL_BAR) {
         auto op = next();
         auto right = parseBitwiseXorTerm();
         if (right) {
-            result = make_shared<BinTree>(
+            result = makeTree<BinTree>(
                     BinTree::Type::BINARY_OPERATION,
                     result, right, op
             );
@@ -956,14 +1953,14 @@ shared_ptr<BinTree> Parser::parseBitwiseOrTerm() {
 }
 
 shared_ptr<BinTree> Parser::parseBitwiseXorTerm() {
-    LOG(INFO) << "Started Parsing Bitwise Xor Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Bitwise Xor Term");
 
     auto result = parseBitwiseAndTerm();
     while (peek()->getRawValue() == *Operator::TILDA) {
         auto op = next();
         auto right = parseBitwiseAndTerm();
         if (right) {
-            result = make_shared<BinTree>(
+            result = makeTree<BinTree>(
                     BinTree::Type::BINARY_OPERATION,
                     result, right, op
             );
@@ -980,14 +1977,14 @@ shared_ptr<BinTree> Parser::parseBitwiseXorTerm() {
 }
 
 shared_ptr<BinTree> Parser::parseBitwiseAndTerm() {
-    LOG(INFO) << "Started Parsing Bitwise And Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Bitwise And Term");
 
     auto result = parseShiftedTerm();
     while (peek()->getRawValue() == *Operator::AMPERSAND) {
         auto op = next();
         auto right = parseShiftedTerm();
         if (right) {
-            result = make_shared<BinTree>(
+            result = makeTree<BinTree>(
                     BinTree::Type::BINARY_OPERATION,
                     result, right, op
             );
@@ -1004,7 +2001,7 @@ shared_ptr<BinTree> Parser::parseBitwiseAndTerm() {
 }
 
 shared_ptr<BinTree> Parser::parseShiftedTerm() {
-    LOG(INFO) << "Started Parsing Shifted Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Shifted Term");
     static unordered_set<string> shiftOperators = {*Operator::LT_LT, *Operator::GT_GT};
 
     auto result = parseStringConcatenationTerm();
@@ -1012,7 +2009,7 @@ shared_ptr<BinTree> Parser::parseShiftedTerm() {
         auto op = next();
         auto right = parseStringConcatenationTerm();
         if (right) {
-            result = make_shared<BinTree>(
+            result = makeTree<BinTree>(
                     BinTree::Type::BINARY_OPERATION,
                     result, right, op
             );
@@ -1029,14 +2026,14 @@ shared_ptr<BinTree> Parser::parseShiftedTerm() {
 }
 
 shared_ptr<BinTree> Parser::parseStringConcatenationTerm() {
-    LOG(INFO) << "Started Parsing Concatenation Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Concatenation Term");
 
     auto result = parseSummationTerm();
     while (peek()->getRawValue() == *Operator::DOT_DOT) {
         auto op = next();
         auto right = parseSummationTerm();
         if (right) {
-            result = make_shared<BinTree>(
+            result = makeTree<BinTree>(
                     BinTree::Type::BINARY_OPERATION,
                     result, right, op
             );
@@ -1053,7 +2050,7 @@ shared_ptr<BinTree> Parser::parseStringConcatenationTerm() {
 }
 
 shared_ptr<BinTree> Parser::parseSummationTerm() {
-    LOG(INFO) << "Started Parsing Summation Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Summation Term");
     static unordered_set<string> summationOperators = {*Operator::PLUS, *Operator::MINUS};
 
     auto result = parseProductTerm();
@@ -1061,7 +2058,7 @@ shared_ptr<BinTree> Parser::parseSummationTerm() {
         auto op = next();
         auto right = parseProductTerm();
         if (right) {
-            result = make_shared<BinTree>(
+            result = makeTree<BinTree>(
                     BinTree::Type::BINARY_OPERATION,
                     result, right, op
             );
@@ -1078,7 +2075,7 @@ shared_ptr<BinTree> Parser::parseSummationTerm() {
 }
 
 shared_ptr<BinTree> Parser::parseProductTerm() {
-    LOG(INFO) << "Started Parsing Product Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Product Term");
     static unordered_set<string> productOperators = {
             *Operator::ASTERISK, *Operator::SLASH, *Operator::SLASH_SLASH, *Operator::PERCENT
     };
@@ -1088,7 +2085,7 @@ shared_ptr<BinTree> Parser::parseProductTerm() {
         auto op = next();
         auto right = parseUnaryTerm();
         if (right) {
-            result = make_shared<BinTree>(
+            result = makeTree<BinTree>(
                     BinTree::Type::BINARY_OPERATION,
                     result, right, op
             );
@@ -1105,7 +2102,7 @@ shared_ptr<BinTree> Parser::parseProductTerm() {
 }
 
 shared_ptr<BinTree> Parser::parseUnaryTerm() {
-    LOG(INFO) << "Started Parsing Unary Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Unary Term");
     static unordered_set<string> unaryOperators = {
             *Keyword::NOT, *Operator::SHARP, *Operator::MINUS, *Operator::TILDA
     };
@@ -1114,7 +2111,7 @@ shared_ptr<BinTree> Parser::parseUnaryTerm() {
         auto token = next();
         auto exponentTerm = parseExponentTerm();
         if (exponentTerm) {
-            return make_shared<BinTree>(
+            return makeTree<BinTree>(
                     BinTree::Type::UNARY_OPERATION,
                     nullptr, exponentTerm, token
             );
@@ -1131,7 +2128,7 @@ shared_ptr<BinTree> Parser::parseUnaryTerm() {
 }
 
 shared_ptr<BinTree> Parser::parseExponentTerm() {
-    LOG(INFO) << "Started Parsing Exponent Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Exponent Term");
     auto left = parseTerm();
     if (!left) {
         return {nullptr};
@@ -1140,13 +2137,13 @@ shared_ptr<BinTree> Parser::parseExponentTerm() {
     if (peek()->getRawValue() == *Operator::CARET) {
         auto caret = next();
         auto right = parseExponentTerm();
-        return make_shared<BinTree>(
+        return makeTree<BinTree>(
                 BinTree::Type::BINARY_OPERATION,
                 left, right, caret
         );
     }
 
-    return make_shared<BinTree>(
+    return makeTree<BinTree>(
             BinTree::Type::BINARY_OPERATION,
             left, nullptr, nullptr
     );
@@ -1154,7 +2151,7 @@ shared_ptr<BinTree> Parser::parseExponentTerm() {
 }
 
 shared_ptr<TermTree> Parser::parseTerm() {
-    LOG(INFO) << "Started Parsing Term from " + peek()->getRawValue() << " at : " << peek()->getSpan();
+    TRACE_PRODUCTION("Term");
     static auto isTerminal = [](const shared_ptr<Token> &t) -> bool {
         static unordered_set<string> terminalKeywordsAndOperators = {
                 *Keyword::NIL, *Keyword::TRUE, *Keyword::FALSE
@@ -1170,11 +2167,11 @@ shared_ptr<TermTree> Parser::parseTerm() {
     };
 
     if (isTerminal(peek())) {
-        return make_shared<TermTree>(next());
+        return makeTree<TermTree>(next());
     } else {
         auto prefixExpr = parsePrefixExpr();
         if (prefixExpr) {
-            return make_shared<TermTree>(prefixExpr);
+            return makeTree<TermTree>(prefixExpr);
         } else {
             return {nullptr};
         }
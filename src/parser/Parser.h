@@ -6,21 +6,146 @@
 #define AUX_PARSER_H
 
 #include <variant>
+#include <optional>
 #include <unordered_set>
 
+#include "ParseTrace.h"
+#include "ParseListener.h"
 #include "../scanner/IScanner.h"
+#include "../scanner/TokenCursor.h"
+#include "../exception/Exception.h"
 #include "../intermediate_representation/Tree.h"
 
 namespace aux::parser {
 
+    struct FunctionBodyRegion {
+        std::shared_ptr<ir::ast::BinTree> body;
+        std::shared_ptr<ir::tokens::Token> begin; // '(' of parameters list
+        std::shared_ptr<ir::tokens::Token> end;   // END keyword
+    };
+
     struct Parser {
 
+        static constexpr size_t DEFAULT_MAX_NESTING_DEPTH = 4096;
+
+        // Blocks are parsed by native recursion in every mode, the reference compiler allows as many nested C calls
+        static constexpr size_t MAX_BLOCK_NESTING_DEPTH = 200;
+
         explicit Parser(std::shared_ptr<scanner::IScanner> scanner);
 
+        /**
+         * Expressions and table constructors are parsed keeping their state on a heap allocated stack instead of
+         * native recursion, so that deeply nested generated sources do not overflow the call stack.
+         * Source nesting deeper than maxNestingDepth is reported as a syntax error, every block, parenthesized
+         * expression, index, list of arguments and table constructor is one level of it. Blocks and function bodies
+         * are still parsed recursively, so at most MAX_BLOCK_NESTING_DEPTH of them may be nested
+         */
+        void useExplicitStack(size_t maxNestingDepth = DEFAULT_MAX_NESTING_DEPTH);
+
+        /**
+         * Statements with syntax errors are replaced by @class ir::ast::ErrorTree and parsing continues
+         * from the next token that can start a statement, errors are available via @function getErrors
+         */
         std::shared_ptr<ir::ast::BaseTree> parse();
 
+        /**
+         * Runs the same grammar as @function parse without allocating any tree nodes
+         * @return syntax errors, empty if the source is valid
+         */
+        const std::vector<exception::ParsingException> &validate();
+
+        /**
+         * Runs the same grammar as @function parse without building a tree, reporting parsed constructs
+         * to the listener instead. Parsing ends early once the listener requests to stop
+         * @return syntax errors found so far, also reported via @function ParseListener::syntaxError
+         */
+        const std::vector<exception::ParsingException> &parse(ParseListener &listener);
+
+        [[nodiscard]]
+        const std::vector<exception::ParsingException> &getErrors() const;
+
+        /**
+         * Makes @function parse record every function body with its first and last token,
+         * bodies are available via @function getFunctionBodies, inner ones before the outer
+         */
+        void recordFunctionBodies(bool record = true);
+
+        [[nodiscard]]
+        const std::vector<FunctionBodyRegion> &getFunctionBodies() const;
+
+        /**
+         * funcBody ::= '(' [parList] ')' block END
+         * Parses the whole input as a single function body, used to reparse a function after an edit
+         * @return nullptr if the input is not exactly one function body
+         */
+        std::shared_ptr<ir::ast::BinTree> parseStandaloneFunctionBody();
+
+        /**
+         * Events are recorded only if the build defines AUX_PARSER_TRACE and the trace is enabled
+         */
+        ParseTrace &getTrace();
+
     private:
-        std::shared_ptr<scanner::IScanner> _scanner;
+        scanner::TokenCursor _cursor;
+        uint32_t _tokenIndex{0};
+        ParseTrace _trace;
+        std::vector<exception::ParsingException> _errors;
+        uint32_t _recoveredAt{0};
+
+        bool _buildTree{true};
+        bool _prefixExprEndsWithCall{false};
+        // Range of the last consumed token, ends of ranges of built nodes
+        ir::ast::SourceRange _lastTokenRange;
+
+        bool _recordFunctionBodies{false};
+        std::vector<FunctionBodyRegion> _functionBodies;
+
+        // Details of the last parsed production, tracked only for the listener
+        ParseListener *_listener{nullptr};
+        std::shared_ptr<ir::tokens::Token> _lastToken;
+        std::string _lastPath;
+        std::string _lastMethod;
+        std::vector<std::string> _lastNames;
+        std::optional<std::string> _lastLiteralArgument;
+        size_t _lastFieldsCount{0};
+        std::optional<FunctionEvent> _functionEvent;
+
+        template<typename Event>
+        void notify(void (ParseListener::*callback)(const Event &), const Event &event);
+
+        bool _explicitStack{false};
+        size_t _maxNestingDepth{DEFAULT_MAX_NESTING_DEPTH};
+        size_t _nestingDepth{0};
+        size_t _blockDepth{0};
+
+        struct ExpressionFrame;
+
+        void enterNesting(size_t &depth, size_t maxDepth, const std::string &name);
+
+        /**
+         * @param isNested true if the frame opens a level of source nesting, e.g. parenthesized expression
+         */
+        void pushFrame(std::vector<ExpressionFrame> &stack, ExpressionFrame frame, bool isNested = false);
+
+        void popFrame(std::vector<ExpressionFrame> &stack);
+
+        template<typename T, typename... Args>
+        std::shared_ptr<T> makeTree(Args &&... args);
+
+        void append(const std::shared_ptr<ir::ast::ListTree> &list, const std::shared_ptr<ir::ast::BaseTree> &tree) const;
+
+        /**
+         * Range of a node built of already parsed children, ending at the last consumed token
+         */
+        ir::ast::SourceRange rangeOf(const ir::ast::BaseTree &tree);
+
+        static bool isSynchronizingToken(const std::shared_ptr<ir::tokens::Token> &token);
+
+        /**
+         * Records the error and skips tokens until the one that can start or terminate a statement.
+         * Returns nullptr for errors caused by the previous recovery, those are not reported
+         */
+        std::shared_ptr<ir::ast::ErrorTree> recover(const exception::ParsingException &exception, uint32_t statementStart);
 
         void checkNextTokenEquals(const std::string &expected, bool isStatement);
 
@@ -28,7 +153,11 @@ namespace aux::parser {
 
         void checkNextTokenTypeEquals(const ir::tokens::TokenType &expected, bool isStatement);
 
-        std::shared_ptr<ir::tokens::Token> peek();
+        /**
+         * @return k-th token ahead, for productions decided by a bounded lookahead such as named table fields.
+         * Assignments and calls still parse their prefix expression first, it may be of any length
+         */
+        std::shared_ptr<ir::tokens::Token> peek(size_t k = 0);
 
         std::shared_ptr<ir::tokens::Token> next();
 
@@ -64,7 +193,7 @@ namespace aux::parser {
         /**
          * functionDefinition ::= [LOCAL] FUNCTION funcIdentifier funcBody
          */
-        std::shared_ptr<ir::ast::BinTree> parseFunctionDefinition();
+        std::shared_ptr<ir::ast::BinTree> parseFunctionDefinition(bool isLocal = false);
 
         /**
          * forLoop ::= FOR IdentifierList ('=' | In) expList DO block END
@@ -126,6 +255,20 @@ namespace aux::parser {
          */
         std::shared_ptr<ir::ast::BaseTree> parseExpr();
 
+        /**
+         * Same grammar as @function parseExpr, nested expressions, prefix expressions, expression lists
+         * and table constructors are kept as frames on explicit stack, function bodies are parsed recursively
+         */
+        std::shared_ptr<ir::ast::BaseTree> parseExprWithExplicitStack();
+
+        void stepExpression(std::vector<ExpressionFrame> &stack, std::shared_ptr<ir::ast::BaseTree> &result);
+
+        void stepPrefixExpression(std::vector<ExpressionFrame> &stack, std::shared_ptr<ir::ast::BaseTree> &result);
+
+        void stepExpressionList(std::vector<ExpressionFrame> &stack, std::shared_ptr<ir::ast::BaseTree> &result);
+
+        void stepTableConstructor(std::vector<ExpressionFrame> &stack, std::shared_ptr<ir::ast::BaseTree> &result);
+
         /**
          * functionCall ::= prefixExpr funcCallSuffix
          */
@@ -176,6 +319,11 @@ namespace aux::parser {
          */
         std::shared_ptr<ir::ast::BinTree> parseTableField();
 
+        /**
+         * Identifier '=' of a named field, decided by two tokens of lookahead since exp can start with Identifier too
+         */
+        bool atNamedTableField();
+
         /**
          * arlExpression ::= logicalAndTerm {OR logicalOrTerm}
          */
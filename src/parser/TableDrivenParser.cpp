@@ -0,0 +1,154 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "TableDrivenParser.h"
+
+#include <algorithm>
+#include <cctype>
+
+using namespace aux::ir::tokens;
+using namespace aux::exception;
+using namespace aux::scanner;
+using namespace aux::parser;
+using namespace aux::parser::grammar;
+using namespace std;
+
+namespace {
+
+    const string IDENTIFIER = "Identifier";
+    const string NUMERAL = "Numeral";
+    const string LITERAL_STRING = "LiteralString";
+
+    bool isKeywordTerminal(const string &terminal) {
+        return all_of(terminal.begin(), terminal.end(), [](char c) { return isupper(c) || c == '_'; });
+    }
+
+    /**
+     * Value of a keyword or an operator token matching the terminal, e.g. "end" for END or "(" for '('
+     */
+    string rawValueOf(const string &terminal) {
+        if (terminal.size() > 2 && terminal.front() == '\'' && terminal.back() == '\'') {
+            return terminal.substr(1, terminal.size() - 2);
+        }
+
+        string result;
+        transform(terminal.begin(), terminal.end(), back_inserter(result), [](char c) { return tolower(c); });
+        return result;
+    }
+
+    string displayNameOf(const string &terminal, uint16_t index) {
+        if (index == 0) {
+            return *TokenType::EOF_OR_UNDEFINED;
+        } else if (terminal == IDENTIFIER) {
+            return *TokenType::IDENTIFIER;
+        } else if (terminal == LITERAL_STRING) {
+            return *TokenType::STRING_LITERAL;
+        } else if (terminal == NUMERAL) {
+            return "<Numeral>";
+        }
+        return rawValueOf(terminal);
+    }
+
+}
+
+TableDrivenParser::TableDrivenParser(shared_ptr<IScanner> scanner, const ParseTables &tables)
+        : _cursor(std::move(scanner)), _tables(tables) {
+    _unknown = _identifier = _numeral = _literalString = static_cast<uint16_t>(_tables.terminals.size());
+
+    for (uint16_t i = 1; i < _tables.terminals.size(); ++i) {
+        const auto &terminal = _tables.terminals[i];
+        if (terminal == IDENTIFIER) {
+            _identifier = i;
+        } else if (terminal == NUMERAL) {
+            _numeral = i;
+        } else if (terminal == LITERAL_STRING) {
+            _literalString = i;
+        } else if (terminal.front() == '\'' || isKeywordTerminal(terminal)) {
+            _keywordsAndOperators[rawValueOf(terminal)] = i;
+        }
+    }
+}
+
+/**
+ * Expands the non-terminal on top of the stack with the production chosen by the table for the current token,
+ * or matches the terminal on top with the token
+ */
+const vector<ParsingException> &TableDrivenParser::validate() {
+    const auto terminalsCount = static_cast<uint16_t>(_tables.terminals.size());
+
+    _errors.clear();
+    _stack.assign({0, terminalsCount});
+
+    auto token = _cursor.next();
+    auto terminal = terminalOf(*token);
+
+    while (!_stack.empty()) {
+        auto symbol = _stack.back();
+        _stack.pop_back();
+
+        if (symbol < terminalsCount) {
+            if (symbol != terminal) {
+                reportError(*token, {symbol});
+                break;
+            }
+            if (symbol == 0) {
+                break;
+            }
+            token = _cursor.next();
+            terminal = terminalOf(*token);
+            continue;
+        }
+
+        auto nonTerminal = static_cast<uint16_t>(symbol - terminalsCount);
+        auto production = _tables.productionFor(nonTerminal, terminal, [this]() {
+            return terminalOf(*_cursor.peek());
+        });
+        if (production < 0) {
+            vector<uint16_t> expected;
+            for (uint16_t t = 0; t < terminalsCount; ++t) {
+                if (_tables.productionFor(nonTerminal, t) >= 0) {
+                    expected.push_back(t);
+                }
+            }
+            reportError(*token, expected);
+            break;
+        }
+
+        auto begin = _tables.productionSymbols.begin() + _tables.productionOffsets[production];
+        auto end = _tables.productionSymbols.begin() + _tables.productionOffsets[production + 1];
+        _stack.insert(_stack.end(), make_reverse_iterator(end), make_reverse_iterator(begin));
+    }
+
+    return _errors;
+}
+
+const vector<ParsingException> &TableDrivenParser::getErrors() const {
+    return _errors;
+}
+
+uint16_t TableDrivenParser::terminalOf(const Token &token) const {
+    switch (token.getType()) {
+        case TokenType::IDENTIFIER:
+            return _identifier;
+        case TokenType::NUMERIC_DECIMAL:
+        case TokenType::NUMERIC_HEX:
+        case TokenType::NUMERIC_DOUBLE:
+            return _numeral;
+        case TokenType::STRING_LITERAL:
+            return _literalString;
+        case TokenType::EOF_OR_UNDEFINED:
+            return 0;
+        default:
+            auto result = _keywordsAndOperators.find(token.getRawValue());
+            return result == _keywordsAndOperators.end() ? _unknown : result->second;
+    }
+}
+
+void TableDrivenParser::reportError(const Token &token, const vector<uint16_t> &expected) {
+    auto builder = ParsingException::statementErrorBuilder();
+    for (auto terminal: expected) {
+        builder.addExpected(displayNameOf(_tables.terminals[terminal], terminal));
+    }
+    _errors.push_back(builder.withActual(token.getRawValue()).withSpan(token.getSpan()).build());
+}
@@ -0,0 +1,59 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_TABLEDRIVENPARSER_H
+#define AUX_TABLEDRIVENPARSER_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../scanner/IScanner.h"
+#include "../scanner/TokenCursor.h"
+#include "../exception/Exception.h"
+#include "grammar/ParseTables.h"
+#include "generated/LuaParseTables.h"
+
+namespace aux::parser {
+
+    /**
+     * LL(1) parser driven by tables generated from resources/syntax.ebnf, looks at the second token only where
+     * the tables say so. Keeps expected symbols on an explicit stack instead of recursion. Recognizes the same
+     * language as @function Parser::validate, but does not recover from errors, parsing stops at the first one
+     */
+    struct TableDrivenParser {
+
+        explicit TableDrivenParser(
+                std::shared_ptr<scanner::IScanner> scanner,
+                const grammar::ParseTables &tables = generated::luaParseTables()
+        );
+
+        /**
+         * @return the syntax error, empty if the source is valid
+         */
+        const std::vector<exception::ParsingException> &validate();
+
+        [[nodiscard]]
+        const std::vector<exception::ParsingException> &getErrors() const;
+
+    private:
+        scanner::TokenCursor _cursor;
+        const grammar::ParseTables &_tables;
+
+        std::unordered_map<std::string, uint16_t> _keywordsAndOperators;
+        uint16_t _identifier, _numeral, _literalString, _unknown;
+
+        std::vector<uint16_t> _stack;
+        std::vector<exception::ParsingException> _errors;
+
+        [[nodiscard]]
+        uint16_t terminalOf(const ir::tokens::Token &token) const;
+
+        void reportError(const ir::tokens::Token &token, const std::vector<uint16_t> &expected);
+    };
+
+}
+
+#endif //AUX_TABLEDRIVENPARSER_H
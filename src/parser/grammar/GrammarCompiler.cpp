@@ -0,0 +1,512 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "GrammarCompiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace aux::parser::grammar;
+using namespace std;
+
+struct GrammarCompiler::Expression {
+    enum class Type {
+        SYMBOL,
+        SEQUENCE,
+        ALTERNATIVES,
+        OPTION,
+        REPETITION
+    };
+
+    Type type{Type::SEQUENCE};
+    string symbol;
+    vector<Expression> children;
+};
+
+namespace {
+
+    const string DEFINITION = "::=";
+    const string END_OF_INPUT = "$";
+
+    bool isNonTerminal(const string &symbol) {
+        return islower(static_cast<unsigned char>(symbol[0]));
+    }
+
+    vector<string> lex(istream &ebnf) {
+        vector<string> result;
+        char c;
+        while (ebnf.get(c)) {
+            if (isspace(static_cast<unsigned char>(c))) {
+                continue;
+            }
+
+            if (c == '#') {
+                string comment;
+                getline(ebnf, comment);
+            } else if (c == '\'') {
+                string terminal = "'";
+                while (ebnf.get(c) && c != '\'') {
+                    terminal += c;
+                }
+                if (c != '\'' || terminal.size() == 1) {
+                    throw invalid_argument("Unterminated terminal " + terminal + " in grammar");
+                }
+                result.push_back(terminal + "'");
+            } else if (c == ':' && ebnf.peek() == ':') {
+                ebnf.get(c);
+                if (!ebnf.get(c) || c != '=') {
+                    throw invalid_argument("Expected " + DEFINITION + " in grammar");
+                }
+                result.push_back(DEFINITION);
+            } else if (isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                string name(1, c);
+                while (isalnum(ebnf.peek()) || ebnf.peek() == '_') {
+                    name += static_cast<char>(ebnf.get());
+                }
+                result.push_back(name);
+            } else if (string("|{}[]()").find(c) != string::npos) {
+                result.emplace_back(1, c);
+            } else {
+                throw invalid_argument("Unexpected character [" + string(1, c) + "] in grammar");
+            }
+        }
+        return result;
+    }
+
+    /**
+     * alternatives ::= sequence {'|' sequence}
+     * sequence ::= {symbol | '(' alternatives ')' | '[' alternatives ']' | '{' alternatives '}'}
+     */
+    struct ExpressionReader {
+        using Expression = GrammarCompiler::Expression;
+
+        const vector<string> &tokens;
+        size_t position{0};
+
+        [[nodiscard]]
+        bool atRuleStart() const {
+            return position + 1 < tokens.size() && tokens[position + 1] == DEFINITION;
+        }
+
+        Expression readAlternatives() {
+            Expression result{Expression::Type::ALTERNATIVES, "", {}};
+            result.children.push_back(readSequence());
+            while (position < tokens.size() && tokens[position] == "|") {
+                ++position;
+                result.children.push_back(readSequence());
+            }
+            return result;
+        }
+
+        Expression readSequence() {
+            static const unordered_map<string, pair<string, Expression::Type>> groups = {
+                    {"(", {")", Expression::Type::ALTERNATIVES}},
+                    {"[", {"]", Expression::Type::OPTION}},
+                    {"{", {"}", Expression::Type::REPETITION}}
+            };
+
+            Expression result{Expression::Type::SEQUENCE, "", {}};
+            while (position < tokens.size() && !atRuleStart()) {
+                const auto &token = tokens[position];
+                if (auto group = groups.find(token); group != groups.end()) {
+                    ++position;
+                    auto alternatives = readAlternatives();
+                    if (position == tokens.size() || tokens[position] != group->second.first) {
+                        throw invalid_argument("Expected " + group->second.first + " in grammar");
+                    }
+                    ++position;
+
+                    if (group->second.second == Expression::Type::ALTERNATIVES) {
+                        result.children.push_back(std::move(alternatives));
+                    } else {
+                        result.children.push_back({group->second.second, "", {std::move(alternatives)}});
+                    }
+                } else if (token.size() == 1 && string("|)]}").find(token) != string::npos) {
+                    break;
+                } else {
+                    result.children.push_back({Expression::Type::SYMBOL, token, {}});
+                    ++position;
+                }
+            }
+            return result;
+        }
+    };
+
+}
+
+GrammarCompiler::GrammarCompiler(istream &ebnf) {
+    auto tokens = lex(ebnf);
+    ExpressionReader reader{tokens};
+
+    while (reader.position < tokens.size()) {
+        if (!reader.atRuleStart() || !isNonTerminal(tokens[reader.position])) {
+            throw invalid_argument("Expected rule definition at [" + tokens[reader.position] + "] in grammar");
+        }
+        auto name = tokens[reader.position];
+        reader.position += 2;
+        desugar(name, reader.readAlternatives());
+    }
+
+    if (_rules.empty()) {
+        throw invalid_argument("Grammar has no rules");
+    }
+}
+
+void GrammarCompiler::desugar(const string &ruleName, const Expression &alternatives) {
+    size_t helpersCount = 0;
+    for (const auto &sequence: alternatives.children) {
+        Rule rule{ruleName, {}};
+        for (const auto &item: sequence.children) {
+            rule.symbols.push_back(desugarItem(ruleName, item, helpersCount));
+        }
+        _rules.push_back(std::move(rule));
+    }
+}
+
+/**
+ * Options, repetitions and groups are replaced with helper rules named after the rule they appear in:
+ * [x] becomes h ::= x | <empty>, {x} becomes h ::= x h | <empty>, (x | y) becomes h ::= x | y
+ */
+string GrammarCompiler::desugarItem(const string &ruleName, const Expression &item, size_t &helpersCount) {
+    if (item.type == Expression::Type::SYMBOL) {
+        return item.symbol;
+    }
+
+    auto helperName = ruleName + "." + to_string(++helpersCount);
+    switch (item.type) {
+        case Expression::Type::ALTERNATIVES:
+            desugar(helperName, item);
+            break;
+        case Expression::Type::OPTION:
+            desugar(helperName, item.children[0]);
+            _rules.push_back({helperName, {}});
+            break;
+        case Expression::Type::REPETITION:
+            desugarRepetition(helperName, item.children[0]);
+            break;
+        default:
+            throw invalid_argument("Unexpected sequence in rule " + ruleName);
+    }
+    return helperName;
+}
+
+void GrammarCompiler::desugarRepetition(const string &helperName, const Expression &alternatives) {
+    auto firstRule = _rules.size();
+    desugar(helperName, alternatives);
+    for (auto i = firstRule; i < _rules.size(); ++i) {
+        if (_rules[i].name == helperName) {
+            _rules[i].symbols.push_back(helperName);
+        }
+    }
+    _rules.push_back({helperName, {}});
+}
+
+ParseTables GrammarCompiler::compile() {
+    _conflicts.clear();
+
+    // Only rules reachable from the first one, numbered in order of definition:
+    unordered_map<string, vector<size_t>> rulesByName;
+    for (size_t i = 0; i < _rules.size(); ++i) {
+        rulesByName[_rules[i].name].push_back(i);
+    }
+
+    unordered_set<string> reachable{_rules[0].name};
+    vector<string> pending{_rules[0].name};
+    while (!pending.empty()) {
+        auto name = pending.back();
+        pending.pop_back();
+        for (auto ruleIndex: rulesByName[name]) {
+            for (const auto &symbol: _rules[ruleIndex].symbols) {
+                if (!isNonTerminal(symbol) || reachable.contains(symbol)) {
+                    continue;
+                }
+                if (!rulesByName.contains(symbol)) {
+                    throw invalid_argument("Rule " + symbol + " used in " + name + " is not defined");
+                }
+                reachable.insert(symbol);
+                pending.push_back(symbol);
+            }
+        }
+    }
+
+    ParseTables result;
+    unordered_map<string, uint16_t> terminals{{END_OF_INPUT, 0}}, nonTerminals;
+    result.terminals.push_back(END_OF_INPUT);
+    vector<const Rule *> productions;
+    for (const auto &rule: _rules) {
+        if (!reachable.contains(rule.name)) {
+            continue;
+        }
+        productions.push_back(&rule);
+        if (nonTerminals.emplace(rule.name, nonTerminals.size()).second) {
+            result.nonTerminals.push_back(rule.name);
+        }
+        for (const auto &symbol: rule.symbols) {
+            if (!isNonTerminal(symbol) && terminals.emplace(symbol, terminals.size()).second) {
+                result.terminals.push_back(symbol);
+            }
+        }
+    }
+
+    const size_t terminalsCount = result.terminals.size(), nonTerminalsCount = result.nonTerminals.size();
+    if (terminalsCount + nonTerminalsCount > numeric_limits<uint16_t>::max()
+        || 2 * productions.size() > static_cast<size_t>(numeric_limits<int16_t>::max())) {
+        throw invalid_argument("Grammar is too large");
+    }
+
+    vector<uint16_t> lhs;
+    for (const auto *rule: productions) {
+        lhs.push_back(nonTerminals[rule->name]);
+        result.productionOffsets.push_back(result.productionSymbols.size());
+        for (const auto &symbol: rule->symbols) {
+            result.productionSymbols.push_back(
+                    isNonTerminal(symbol) ? terminalsCount + nonTerminals[symbol] : terminals[symbol]
+            );
+        }
+    }
+    result.productionOffsets.push_back(result.productionSymbols.size());
+
+    auto rhs = [&](size_t production) {
+        return make_pair(result.productionSymbols.begin() + result.productionOffsets[production],
+                         result.productionSymbols.begin() + result.productionOffsets[production + 1]);
+    };
+
+    // Nullable non-terminals and FIRST sets, until nothing changes:
+    vector<bool> nullable(nonTerminalsCount);
+    vector<vector<bool>> first(nonTerminalsCount, vector<bool>(terminalsCount));
+
+    // Adds FIRST of the sequence to the set, returns true if the whole sequence is nullable
+    auto addFirst = [&](auto begin, auto end, vector<bool> &set, bool &changed) {
+        for (auto it = begin; it != end; ++it) {
+            if (*it < terminalsCount) {
+                changed |= !set[*it];
+                set[*it] = true;
+                return false;
+            }
+            for (size_t t = 0; t < terminalsCount; ++t) {
+                if (first[*it - terminalsCount][t] && !set[t]) {
+                    set[t] = changed = true;
+                }
+            }
+            if (!nullable[*it - terminalsCount]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t p = 0; p < productions.size(); ++p) {
+            auto [begin, end] = rhs(p);
+            if (addFirst(begin, end, first[lhs[p]], changed) && !nullable[lhs[p]]) {
+                nullable[lhs[p]] = changed = true;
+            }
+        }
+    }
+
+    vector<vector<bool>> follow(nonTerminalsCount, vector<bool>(terminalsCount));
+    follow[0][0] = true;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t p = 0; p < productions.size(); ++p) {
+            auto [begin, end] = rhs(p);
+            for (auto it = begin; it != end; ++it) {
+                if (*it < terminalsCount) {
+                    continue;
+                }
+                auto &set = follow[*it - terminalsCount];
+                if (addFirst(it + 1, end, set, changed)) {
+                    for (size_t t = 0; t < terminalsCount; ++t) {
+                        if (follow[lhs[p]][t] && !set[t]) {
+                            set[t] = changed = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // E.g. Identifier '=' exp, such alternatives are told apart from the others by the second token
+    auto startsWithTwoTerminals = [&](int16_t production) {
+        if (static_cast<size_t>(production) >= productions.size()) {
+            return false;
+        }
+        auto [begin, end] = rhs(production);
+        return end - begin >= 2 && begin[0] < terminalsCount && begin[1] < terminalsCount;
+    };
+
+    vector<int16_t> table(nonTerminalsCount * terminalsCount, -1);
+    for (size_t p = 0; p < productions.size(); ++p) {
+        auto [begin, end] = rhs(p);
+        vector<bool> lookahead(terminalsCount);
+        bool unused = false;
+        if (addFirst(begin, end, lookahead, unused)) {
+            for (size_t t = 0; t < terminalsCount; ++t) {
+                lookahead[t] = lookahead[t] || follow[lhs[p]][t];
+            }
+        }
+
+        for (size_t t = 0; t < terminalsCount; ++t) {
+            auto &entry = table[lhs[p] * terminalsCount + t];
+            if (!lookahead[t]) {
+                continue;
+            }
+            if (entry == -1) {
+                entry = static_cast<int16_t>(p);
+            } else if (startsWithTwoTerminals(entry) && (begin == end || *begin != t)) {
+                // Alternative written first is chosen if the second token matches,
+                // the other one is assumed to never start with the same two terminals
+                auto choice = productions.size() + result.secondTokenChoices.size() / 3;
+                result.secondTokenChoices.insert(result.secondTokenChoices.end(), {
+                        *(rhs(entry).first + 1), static_cast<uint16_t>(entry), static_cast<uint16_t>(p)
+                });
+                entry = static_cast<int16_t>(choice);
+            } else {
+                auto conflict = result.nonTerminals[lhs[p]] + " on " + result.terminals[t];
+                if (find(_conflicts.begin(), _conflicts.end(), conflict) == _conflicts.end()) {
+                    _conflicts.push_back(conflict);
+                }
+            }
+        }
+    }
+
+    compress(table, result);
+    return result;
+}
+
+/**
+ * Rows are placed densest first, each at the lowest offset where its entries do not overlap already placed ones
+ */
+void GrammarCompiler::compress(const vector<int16_t> &table, ParseTables &tables) {
+    const size_t terminalsCount = tables.terminals.size(), nonTerminalsCount = tables.nonTerminals.size();
+    const auto unused = numeric_limits<uint16_t>::max();
+
+    vector<vector<uint16_t>> rows(nonTerminalsCount);
+    for (size_t row = 0; row < nonTerminalsCount; ++row) {
+        for (size_t t = 0; t < terminalsCount; ++t) {
+            if (table[row * terminalsCount + t] >= 0) {
+                rows[row].push_back(t);
+            }
+        }
+    }
+
+    vector<size_t> order(nonTerminalsCount);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return rows[lhs].size() > rows[rhs].size();
+    });
+
+    tables.rowOffsets.assign(nonTerminalsCount, 0);
+    for (auto row: order) {
+        size_t offset = 0;
+        auto fits = [&]() {
+            return all_of(rows[row].begin(), rows[row].end(), [&](uint16_t t) {
+                return offset + t >= tables.entryOwners.size() || tables.entryOwners[offset + t] == unused;
+            });
+        };
+        while (!fits()) {
+            ++offset;
+        }
+
+        if (offset + terminalsCount > tables.entryOwners.size()) {
+            tables.entryOwners.resize(offset + terminalsCount, unused);
+            tables.entries.resize(offset + terminalsCount, 0);
+        }
+        tables.rowOffsets[row] = offset;
+        for (auto t: rows[row]) {
+            tables.entryOwners[offset + t] = row;
+            tables.entries[offset + t] = table[row * terminalsCount + t];
+        }
+    }
+
+    // Slots past the last used one are never owned, lookups beyond the end are treated as errors
+    while (!tables.entryOwners.empty() && tables.entryOwners.back() == unused) {
+        tables.entryOwners.pop_back();
+        tables.entries.pop_back();
+    }
+}
+
+const vector<string> &GrammarCompiler::getConflicts() const {
+    return _conflicts;
+}
+
+namespace {
+
+    template<typename T>
+    void writeValues(ostream &out, const vector<T> &values, size_t valuesPerRow) {
+        out << "{";
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i % valuesPerRow == 0) {
+                out << "\n                        ";
+            }
+            out << values[i];
+            if (i + 1 != values.size()) {
+                out << ((i + 1) % valuesPerRow == 0 ? "," : ", ");
+            }
+        }
+        out << "\n                }";
+    }
+
+    string quoted(const string &value) {
+        string result = "\"";
+        for (char c: value) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result + "\"";
+    }
+
+}
+
+void GrammarCompiler::writeHeader(ostream &out, const ParseTables &tables) {
+    vector<string> terminals, nonTerminals;
+    transform(tables.terminals.begin(), tables.terminals.end(), back_inserter(terminals), quoted);
+    transform(tables.nonTerminals.begin(), tables.nonTerminals.end(), back_inserter(nonTerminals), quoted);
+
+    out << "//\n"
+           "// Generated from resources/syntax.ebnf by aux_parse_tables_generator, do not edit.\n"
+           "//\n"
+           "\n"
+           "#ifndef AUX_LUAPARSETABLES_H\n"
+           "#define AUX_LUAPARSETABLES_H\n"
+           "\n"
+           "#include \"grammar/ParseTables.h\"\n"
+           "\n"
+           "namespace aux::parser::generated {\n"
+           "\n"
+           "    inline const grammar::ParseTables &luaParseTables() {\n"
+           "        static const grammar::ParseTables tables{\n"
+           "                ";
+    writeValues(out, terminals, 8);
+    out << ",\n                ";
+    writeValues(out, nonTerminals, 4);
+    out << ",\n                ";
+    writeValues(out, tables.productionOffsets, 20);
+    out << ",\n                ";
+    writeValues(out, tables.productionSymbols, 20);
+    out << ",\n                ";
+    writeValues(out, tables.rowOffsets, 20);
+    out << ",\n                ";
+    writeValues(out, tables.entries, 20);
+    out << ",\n                ";
+    writeValues(out, tables.entryOwners, 20);
+    out << ",\n                ";
+    writeValues(out, tables.secondTokenChoices, 20);
+    out << "\n"
+           "        };\n"
+           "        return tables;\n"
+           "    }\n"
+           "\n"
+           "}\n"
+           "\n"
+           "#endif //AUX_LUAPARSETABLES_H\n";
+}
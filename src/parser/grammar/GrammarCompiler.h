@@ -0,0 +1,68 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_GRAMMARCOMPILER_H
+#define AUX_GRAMMARCOMPILER_H
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ParseTables.h"
+
+namespace aux::parser::grammar {
+
+    /**
+     * Compiles EBNF of resources/syntax.ebnf into LL(1) parse tables. Non-terminals are camelCase,
+     * terminals are PascalCase token types, CAPS keywords or quoted operators, '#' starts a comment.
+     * Options, repetitions and groups become helper non-terminals, only rules reachable from the first one are kept.
+     * An LL(1) conflict with an alternative starting with two terminals is decided by the second token,
+     * the same lookahead the hand-written @class Parser uses for table fields. Other conflicts are resolved
+     * in favour of the alternative written first, so repetitions and options are greedy
+     */
+    struct GrammarCompiler {
+
+        struct Expression;
+
+        /**
+         * @throws std::invalid_argument if the grammar is malformed or refers to undefined rules
+         */
+        explicit GrammarCompiler(std::istream &ebnf);
+
+        [[nodiscard]]
+        ParseTables compile();
+
+        /**
+         * Conflicts resolved by the last @function compile in favour of the first alternative, e.g. "prefixexp.2 on '('"
+         */
+        [[nodiscard]]
+        const std::vector<std::string> &getConflicts() const;
+
+        /**
+         * Writes tables as a C++ header defining aux::parser::generated::luaParseTables()
+         */
+        static void writeHeader(std::ostream &out, const ParseTables &tables);
+
+    private:
+        struct Rule {
+            std::string name;
+            std::vector<std::string> symbols;
+        };
+
+        std::vector<Rule> _rules;
+        std::vector<std::string> _conflicts;
+
+        void desugar(const std::string &ruleName, const Expression &alternatives);
+
+        std::string desugarItem(const std::string &ruleName, const Expression &item, size_t &helpersCount);
+
+        void desugarRepetition(const std::string &helperName, const Expression &alternatives);
+
+        static void compress(const std::vector<int16_t> &table, ParseTables &tables);
+    };
+
+}
+
+#endif //AUX_GRAMMARCOMPILER_H
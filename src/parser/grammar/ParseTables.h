@@ -0,0 +1,64 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_PARSETABLES_H
+#define AUX_PARSETABLES_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace aux::parser::grammar {
+
+    /**
+     * LL(1) parse tables of a grammar, a few entries of which look at the second token. Symbols below
+     * terminals.size() are terminals, the rest are non-terminals shifted by terminals.size().
+     * Terminal 0 is the end of input and non-terminal 0 is the start symbol
+     */
+    struct ParseTables {
+        std::vector<std::string> terminals;     // As written in the grammar, e.g. Identifier, END or '('
+        std::vector<std::string> nonTerminals;
+        std::vector<uint16_t> productionOffsets; // Right side of production i is [offsets[i], offsets[i + 1])
+        std::vector<uint16_t> productionSymbols;
+
+        // nonTerminals x terminals table of productions to expand, compressed by row displacement:
+        // the entry of a non-terminal row is at rowOffsets[row] + terminal if that slot is owned by the row
+        std::vector<uint16_t> rowOffsets;
+        std::vector<uint16_t> entries;
+        std::vector<uint16_t> entryOwners;
+
+        // Entries past the last production refer to choices decided by the second token of lookahead,
+        // stored as triples of (second terminal, production if it matches, production otherwise)
+        std::vector<uint16_t> secondTokenChoices;
+
+        bool operator==(const ParseTables &other) const = default;
+
+        /**
+         * @return entry of the table, a production or a second token choice, or -1 if it is a syntax error
+         */
+        [[nodiscard]]
+        inline int32_t productionFor(uint16_t nonTerminal, uint16_t terminal) const {
+            size_t slot = rowOffsets[nonTerminal] + terminal;
+            return slot < entries.size() && entryOwners[slot] == nonTerminal ? entries[slot] : -1;
+        }
+
+        /**
+         * @param secondTerminal returns terminal of the token after the current one, called only if it is needed
+         * @return production expanding the non-terminal on the two terminals, or -1 if it is a syntax error
+         */
+        template<typename SecondTerminal>
+        inline int32_t productionFor(uint16_t nonTerminal, uint16_t terminal, SecondTerminal &&secondTerminal) const {
+            auto entry = productionFor(nonTerminal, terminal);
+            auto productionsCount = static_cast<int32_t>(productionOffsets.size()) - 1;
+            if (entry < productionsCount) {
+                return entry;
+            }
+            auto choice = secondTokenChoices.begin() + 3 * (entry - productionsCount);
+            return secondTerminal() == choice[0] ? choice[1] : choice[2];
+        }
+    };
+
+}
+
+#endif //AUX_PARSETABLES_H
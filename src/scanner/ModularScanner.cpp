@@ -33,6 +33,10 @@ std::shared_ptr<Token> aux::scanner::ModularScanner::next() const {
         _stream.get();
     }
 
+    if (_stream.peek() == std::char_traits<char>::eof()) {
+        return std::make_shared<TokenEofOrUndefined>(constructSpan(_stream.getRow() + 1, _stream.getColumn() + 1));
+    }
+
     char startingChar = _stream.peek();
     Span span = constructSpan(_stream.getRow() + 1, _stream.getColumn() + 1);
     std::vector<std::shared_ptr<std::runtime_error>> errors;
@@ -0,0 +1,46 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "TokenBufferScanner.h"
+
+using namespace aux::scanner;
+using namespace aux::ir::tokens;
+
+std::shared_ptr<const TokenBuffer> TokenBufferScanner::scanAll(const IScanner &scanner) {
+    auto result = std::make_shared<TokenBuffer>();
+    while (true) {
+        auto token = scanner.next();
+        result->push_back(token);
+        if (token->getType() == TokenType::EOF_OR_UNDEFINED) {
+            return result;
+        }
+    }
+}
+
+TokenBufferScanner::TokenBufferScanner(std::shared_ptr<const TokenBuffer> tokens)
+        : TokenBufferScanner(tokens, 0, tokens->size() - 1) {}
+
+TokenBufferScanner::TokenBufferScanner(std::shared_ptr<const TokenBuffer> tokens, size_t begin, size_t end)
+        : _tokens(std::move(tokens)),
+          _end(end),
+          _eof(std::make_shared<TokenEofOrUndefined>((*_tokens)[end]->getSpan())),
+          _position(begin) {}
+
+std::shared_ptr<Token> TokenBufferScanner::next() const {
+    if (_position < _end) {
+        return (*_tokens)[_position++];
+    }
+    return _eof;
+}
+
+std::shared_ptr<Token> TokenBufferScanner::peek() const {
+    if (_position < _end) {
+        return (*_tokens)[_position];
+    }
+    return _eof;
+}
+
+size_t TokenBufferScanner::getPosition() const {
+    return _position;
+}
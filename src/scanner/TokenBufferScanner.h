@@ -0,0 +1,50 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_TOKENBUFFERSCANNER_H
+#define AUX_TOKENBUFFERSCANNER_H
+
+#include <vector>
+#include <memory>
+#include "IScanner.h"
+
+namespace aux::scanner {
+
+    using TokenBuffer = std::vector<std::shared_ptr<ir::tokens::Token>>;
+
+    /**
+     * Replays tokens that were already scanned, possibly only a [begin, end) slice of them.
+     * Tokens are shared, so several scanners may replay different slices of one buffer concurrently
+     */
+    struct TokenBufferScanner : IScanner {
+
+        /**
+         * Scans everything up to the end of file, the last token of the result is always EOF
+         */
+        static std::shared_ptr<const TokenBuffer> scanAll(const IScanner &scanner);
+
+        explicit TokenBufferScanner(std::shared_ptr<const TokenBuffer> tokens);
+
+        TokenBufferScanner(std::shared_ptr<const TokenBuffer> tokens, size_t begin, size_t end);
+
+        [[nodiscard]]
+        std::shared_ptr<ir::tokens::Token> next() const override;
+
+        [[nodiscard]]
+        std::shared_ptr<ir::tokens::Token> peek() const override;
+
+        [[nodiscard]]
+        size_t getPosition() const;
+
+    private:
+        const std::shared_ptr<const TokenBuffer> _tokens;
+        const size_t _end;
+        const std::shared_ptr<ir::tokens::Token> _eof;
+
+        mutable size_t _position;
+    };
+
+}
+
+#endif //AUX_TOKENBUFFERSCANNER_H
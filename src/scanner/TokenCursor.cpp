@@ -0,0 +1,68 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "TokenCursor.h"
+
+#include <cassert>
+
+using namespace aux::scanner;
+using namespace aux::ir::tokens;
+
+TokenCursor::TokenCursor(std::shared_ptr<IScanner> scanner)
+        : _scanner(std::move(scanner)), _ring(INITIAL_CAPACITY) {}
+
+std::shared_ptr<Token> TokenCursor::next() {
+    auto result = peek();
+    ++_position;
+    discardPassed();
+    return result;
+}
+
+const std::shared_ptr<Token> &TokenCursor::peek(size_t k) {
+    fill(_position + k);
+    return _ring[(_position + k) & (_ring.size() - 1)];
+}
+
+TokenCursor::Mark TokenCursor::mark() {
+    _marks.push_back(_position);
+    return _position;
+}
+
+void TokenCursor::reset(Mark mark) {
+    _position = mark;
+    release(mark);
+}
+
+void TokenCursor::release(Mark mark) {
+    assert(!_marks.empty() && _marks.back() == mark && "Marks should be released in reverse order");
+    _marks.pop_back();
+    discardPassed();
+}
+
+size_t TokenCursor::getPosition() const {
+    return _position;
+}
+
+void TokenCursor::fill(size_t position) {
+    while (_end <= position) {
+        if (_end - _begin == _ring.size()) {
+            // Ring is full, tokens keep their positions in a twice larger one
+            std::vector<std::shared_ptr<Token>> ring(_ring.size() * 2);
+            for (auto i = _begin; i < _end; ++i) {
+                ring[i & (ring.size() - 1)] = std::move(_ring[i & (_ring.size() - 1)]);
+            }
+            _ring = std::move(ring);
+        }
+        _ring[_end & (_ring.size() - 1)] = _scanner->next();
+        ++_end;
+    }
+}
+
+void TokenCursor::discardPassed() {
+    auto oldestNeeded = _marks.empty() ? _position : _marks.front();
+    while (_begin < oldestNeeded && _begin < _end) {
+        _ring[_begin & (_ring.size() - 1)].reset();
+        ++_begin;
+    }
+}
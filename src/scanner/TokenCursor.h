@@ -0,0 +1,73 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_TOKENCURSOR_H
+#define AUX_TOKENCURSOR_H
+
+#include <vector>
+#include <memory>
+#include "IScanner.h"
+
+namespace aux::scanner {
+
+    /**
+     * Reads tokens of a scanner through a ring buffer, so that any number of tokens can be looked ahead
+     * and the cursor can go back to a marked position without scanning the tokens again.
+     * Tokens are buffered only while they are ahead of the cursor or after the oldest active mark
+     */
+    struct TokenCursor {
+
+        using Mark = size_t;
+
+        explicit TokenCursor(std::shared_ptr<IScanner> scanner);
+
+        std::shared_ptr<ir::tokens::Token> next();
+
+        /**
+         * @return k-th token after the cursor, peek(0) is the token @function next returns
+         */
+        const std::shared_ptr<ir::tokens::Token> &peek(size_t k = 0);
+
+        /**
+         * Starts keeping tokens from the current position until the mark is passed to @function reset or
+         * @function release. Marks are released in reverse order of their creation
+         */
+        Mark mark();
+
+        /**
+         * Moves the cursor back to the mark and releases it
+         */
+        void reset(Mark mark);
+
+        /**
+         * Releases the mark keeping the cursor where it is
+         */
+        void release(Mark mark);
+
+        /**
+         * @return number of tokens returned by @function next since the beginning
+         */
+        [[nodiscard]]
+        size_t getPosition() const;
+
+    private:
+        static constexpr size_t INITIAL_CAPACITY = 16;
+
+        const std::shared_ptr<IScanner> _scanner;
+
+        // Tokens at positions [_begin, _end) are at index (position & (_ring.size() - 1))
+        std::vector<std::shared_ptr<ir::tokens::Token>> _ring;
+        size_t _begin{0};
+        size_t _end{0};
+        size_t _position{0};
+        std::vector<Mark> _marks;
+
+        void fill(size_t position);
+
+        void discardPassed();
+    };
+
+}
+
+#endif //AUX_TOKENCURSOR_H
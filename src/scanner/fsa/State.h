@@ -7,6 +7,7 @@
 
 #include <istream>
 #include <map>
+#include <vector>
 #include <memory>
 #include <functional>
 #include "../../exception/Exception.h"
@@ -32,7 +33,11 @@ namespace aux::fsa {
         State(
                 scanner::input_stream::IIndexedStream<CharT, Traits> &stream,
                 std::map<Predicate<CharT>, std::shared_ptr<ConformingStateType>> &transitionTable
-        ) : _stream(stream), _transitionTable(transitionTable) {}
+        ) : _stream(stream), _transitionTable(transitionTable) {
+            for (const auto &[input, state]: transitionTable) {
+                _transitionOrder.push_back(input);
+            }
+        }
 
         explicit State(scanner::input_stream::IIndexedStream<CharT, Traits> &stream)
                 : _stream(stream), _transitionTable({}) {}
@@ -42,6 +47,7 @@ namespace aux::fsa {
                 return false;
             } else {
                 _transitionTable[input] = state;
+                _transitionOrder.push_back(input);
                 return true;
             }
         }
@@ -63,6 +69,7 @@ namespace aux::fsa {
         inline bool removeTransition(Predicate<CharT> input) {
             if (_transitionTable.contains(input)) {
                 _transitionTable.erase(input);
+                std::erase(_transitionOrder, input);
                 return true;
             } else {
                 return false;
@@ -74,8 +81,9 @@ namespace aux::fsa {
             CharT curr;
 
             get(&curr);
-            for (const auto&[matcher, nextState]: _transitionTable) {
+            for (const auto &matcher: _transitionOrder) {
                 if (matcher(curr)) {
+                    const auto &nextState = _transitionTable[matcher];
 
                     if (_mixinTable.contains(matcher)) {
                         result += _mixinTable[matcher](curr);
@@ -97,6 +105,7 @@ namespace aux::fsa {
         // todo: maybe use bare pointers and RAII
         // TODO: there are cyclic dependencies are here
         std::map<Predicate<CharT>, std::shared_ptr<ConformingStateType>> _transitionTable;
+        std::vector<Predicate<CharT>> _transitionOrder; // transitions are tried in the order they were added
         std::map<Predicate<CharT>, Function<CharT, ResultType>> _mixinTable;
         scanner::input_stream::IIndexedStream<CharT, Traits> &_stream;
 
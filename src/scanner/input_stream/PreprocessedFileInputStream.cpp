@@ -4,11 +4,18 @@
 
 #include "PreprocessedFileInputStream.h"
 #include <iostream>
+#include <limits>
 #include <unordered_set>
 
 aux::scanner::input_stream::PreprocessedFileInputStream::PreprocessedFileInputStream(const std::string &inputFile)
         : _stream(std::make_unique<std::basic_ifstream<char>>(inputFile, std::ios::in)), rows(1) {}
 
+aux::scanner::input_stream::PreprocessedFileInputStream::PreprocessedFileInputStream(
+        std::unique_ptr<std::istream> stream,
+        uint16_t firstRow,
+        uint16_t firstColumn
+) : _stream(std::move(stream)), _firstRow(firstRow), _firstColumn(firstColumn), rows(1) {}
+
 char aux::scanner::input_stream::PreprocessedFileInputStream::peek() {
     return _stream->peek();
 }
@@ -29,6 +36,9 @@ char aux::scanner::input_stream::PreprocessedFileInputStream::get() {
         rowSizes.push_back(col);
         col = 0;
         ++row;
+    } else if (col == std::numeric_limits<uint16_t>::max()) {
+        // Column saturates on very long rows, wrapping it to 0 would look like the beginning of a row
+        rows[row].push_back(curr);
     } else {
         if (isascii(curr)) {
             ++col;
@@ -81,11 +91,11 @@ void aux::scanner::input_stream::PreprocessedFileInputStream::unget() {
 }
 
 uint16_t aux::scanner::input_stream::PreprocessedFileInputStream::getRow() {
-    return row;
+    return _firstRow + row;
 }
 
 uint16_t aux::scanner::input_stream::PreprocessedFileInputStream::getColumn() {
-    return col;
+    return row == 0 ? _firstColumn + col : col;
 }
 
 std::string aux::scanner::input_stream::PreprocessedFileInputStream::skipToTheEndOfCurrRow() {
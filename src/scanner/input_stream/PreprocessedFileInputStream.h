@@ -17,6 +17,16 @@ namespace aux::scanner::input_stream {
 
         explicit PreprocessedFileInputStream(const std::string& inputFile);
 
+        /**
+         * Reads already opened stream, e.g. std::istringstream with in-memory source.
+         * firstRow and firstColumn are 0-based position of the stream beginning within the whole source
+         */
+        explicit PreprocessedFileInputStream(
+                std::unique_ptr<std::istream> stream,
+                uint16_t firstRow = 0,
+                uint16_t firstColumn = 0
+        );
+
         char get() override;
 
         char peek() override;
@@ -30,12 +40,13 @@ namespace aux::scanner::input_stream {
         std::string skipToTheEndOfCurrRow() override;
 
     private:
-        const std::unique_ptr<std::basic_ifstream<char>> _stream;
+        const std::unique_ptr<std::istream> _stream;
 
         char _prevReturned{};
         bool _prevReturnSubstituted{false};
         bool incrementedOnPrevNonAsciiChar{false};
 
+        const uint16_t _firstRow{0}, _firstColumn{0};
         uint16_t row{0}, col{0};
         std::vector<uint16_t> rowSizes;
         std::vector<std::string> rows;
@@ -0,0 +1,215 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "CaptureAnalyzer.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+using namespace aux::semantic;
+using namespace aux::ir::hir;
+using namespace std;
+
+namespace {
+
+    bool isLoop(HirKind kind) {
+        return kind == HirKind::WHILE || kind == HirKind::REPEAT
+               || kind == HirKind::NUMERIC_FOR || kind == HirKind::GENERIC_FOR;
+    }
+
+}
+
+bool CaptureAnalyzer::Capture::operator<(const Capture &other) const {
+    return declaration != other.declaration ? declaration < other.declaration : function < other.function;
+}
+
+CaptureAnalysis CaptureAnalyzer::analyze(const HirModule &module, const ScopeResolution &resolution) {
+    _module = &module;
+    _resolution = &resolution;
+    _result = CaptureAnalysis{};
+    _result.modes.assign(module.nodes.size(), CaptureMode::NONE);
+    _result.escapes.assign(module.nodes.size(), false);
+    _captures.clear();
+
+    _parents.assign(module.nodes.size(), NO_NODE);
+    _starts.resize(module.nodes.size());
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        _starts[node] = node;
+        for (auto child: module.getChildren(node)) {
+            _parents[child] = node;
+            _starts[node] = min(_starts[node], _starts[child]);
+        }
+    }
+
+    findEscapes();
+    findBackwardGotos();
+    findModes();
+    return std::move(_result);
+}
+
+void CaptureAnalyzer::findEscapes() {
+    const auto &module = *_module;
+    vector<NodeId> bindings(module.nodes.size(), NO_NODE);
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        if (module[node].kind != HirKind::FUNCTION) {
+            continue;
+        }
+        auto parent = _parents[node];
+        if (parent != NO_NODE && module[parent].kind == HirKind::CALL && module.getChild(parent, 0) == node) {
+            continue;
+        }
+        auto declaration = findBinding(node);
+        if (declaration == NO_NODE) {
+            _result.escapes[node] = true;
+        } else {
+            bindings[declaration] = node;
+        }
+    }
+    if (module.root != NO_NODE) {
+        _result.escapes[module.root] = true;
+    }
+
+    // Any use of a bound closure other than a call from its own scope lets it escape, assignments included.
+    // So does a tail call, which drops the frame of the caller before the closure runs
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        if (module[node].kind != HirKind::NAME || _resolution->names[node].kind == VariableKind::GLOBAL) {
+            continue;
+        }
+        auto declaration = _resolution->names[node].declaration;
+        if (declaration == NO_NODE || bindings[declaration] == NO_NODE) {
+            continue;
+        }
+        auto function = bindings[declaration];
+        auto parent = _parents[node];
+        auto owner = _resolution->owners[node];
+        auto isCall = parent != NO_NODE && module[parent].kind == HirKind::CALL && module.getChild(parent, 0) == node;
+        auto isTailCall = isCall && _parents[parent] != NO_NODE && module[_parents[parent]].kind == HirKind::RETURN
+                          && module[_parents[parent]].count == 1;
+        if (!isCall || isTailCall || (owner != _resolution->owners[declaration] && owner != function)) {
+            _result.escapes[function] = true;
+        }
+    }
+}
+
+NodeId CaptureAnalyzer::findBinding(NodeId function) const {
+    auto parent = _parents[function];
+    if (parent == NO_NODE) {
+        return NO_NODE;
+    }
+    const auto &hirNode = (*_module)[parent];
+    if (hirNode.kind == HirKind::LOCAL_FUNCTION) {
+        return _module->getChild(parent, 0);
+    }
+    if (hirNode.kind != HirKind::LOCAL_DECL) {
+        return NO_NODE;
+    }
+    for (size_t i = hirNode.split; i < hirNode.count; ++i) {
+        if (_module->getChild(parent, i) == function && i - hirNode.split < hirNode.split) {
+            return _module->getChild(parent, i - hirNode.split);
+        }
+    }
+    return NO_NODE;
+}
+
+void CaptureAnalyzer::findBackwardGotos() {
+    const auto &module = *_module;
+    _hasBackwardGotos.assign(module.nodes.size(), false);
+
+    // Ids of leaves grow in the order of the source, a goto is backward if a label of its function precedes it
+    unordered_map<uint64_t, NodeId> labels;
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        auto kind = module[node].kind;
+        if (kind != HirKind::LABEL && kind != HirKind::GOTO) {
+            continue;
+        }
+        auto owner = _resolution->owners[node];
+        auto key = static_cast<uint64_t>(owner) << 32 | module[node].value;
+        if (kind == HirKind::LABEL) {
+            labels.try_emplace(key, node);
+        } else if (labels.contains(key)) {
+            _hasBackwardGotos[owner] = true;
+        }
+    }
+}
+
+void CaptureAnalyzer::findModes() {
+    const auto &module = *_module;
+    vector<bool> captured(module.nodes.size(), false);
+    vector<bool> escaping(module.nodes.size(), false);
+    vector<bool> written(module.nodes.size(), false);
+
+    // Every function between a closure and the declaring function has the local as its upvalue
+    for (const auto &function: _resolution->functions) {
+        for (const auto &upvalue: function.upvalues) {
+            if (upvalue.declaration == NO_NODE) {
+                continue;
+            }
+            captured[upvalue.declaration] = true;
+            if (_result.escapes[function.function]) {
+                escaping[upvalue.declaration] = true;
+            }
+            if (function.parent == _resolution->owners[upvalue.declaration]) {
+                _captures.push_back({upvalue.declaration, function.function});
+            }
+        }
+    }
+    sort(_captures.begin(), _captures.end());
+
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        if (module[node].kind != HirKind::ASSIGN) {
+            continue;
+        }
+        for (size_t i = 0; i < module[node].split; ++i) {
+            auto target = module.getChild(node, i);
+            const auto &name = _resolution->names[target];
+            if (module[target].kind != HirKind::NAME || name.kind == VariableKind::GLOBAL
+                || name.declaration == NO_NODE || !captured[name.declaration]) {
+                continue;
+            }
+            if (name.kind == VariableKind::UPVALUE || isAfterCapture(node, name.declaration)) {
+                written[name.declaration] = true;
+            }
+        }
+    }
+
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        if (!captured[node]) {
+            continue;
+        }
+        if (!written[node]) {
+            _result.modes[node] = CaptureMode::VALUE;
+        } else {
+            _result.modes[node] = escaping[node] ? CaptureMode::BOX : CaptureMode::FRAME;
+        }
+    }
+}
+
+bool CaptureAnalyzer::isAfterCapture(NodeId assignment, NodeId declaration) const {
+    if (_hasBackwardGotos[_resolution->owners[declaration]]) {
+        return true;
+    }
+
+    auto [begin, end] = equal_range(_captures.begin(), _captures.end(), Capture{declaration, 0},
+                                    [](const Capture &left, const Capture &right) {
+                                        return left.declaration < right.declaration;
+                                    });
+    for (auto capture = begin; capture != end; ++capture) {
+        if (capture->function < assignment) {
+            return true;
+        }
+    }
+
+    // Loops inside the scope of the local repeat the assignment after closures created on earlier iterations
+    for (auto node = _parents[assignment]; node != NO_NODE && _starts[node] > declaration; node = _parents[node]) {
+        if (!isLoop((*_module)[node].kind)) {
+            continue;
+        }
+        for (auto capture = begin; capture != end; ++capture) {
+            if (_starts[node] <= capture->function && capture->function <= node) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,111 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_CAPTUREANALYZER_H
+#define AUX_CAPTUREANALYZER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "ScopeResolver.h"
+
+namespace aux::semantic {
+
+    /**
+     * How closures get a local of an enclosing function
+     */
+    enum class CaptureMode : uint8_t {
+        // Not captured, the local stays in its slot
+        NONE,
+        // Never written after a closure captures it, closures copy its value
+        VALUE,
+        // Written after capture, but no capturing closure outlives the enclosing function, so closures
+        // refer to the slot in the frame of the enclosing function
+        FRAME,
+        // Written after capture by closures that may outlive the enclosing function, the local is a heap cell
+        BOX
+    };
+
+    /**
+     * Results of @class CaptureAnalyzer, vectors are indexed by NodeId of the module
+     */
+    struct CaptureAnalysis {
+        // For DECLARATION nodes
+        std::vector<CaptureMode> modes;
+
+        // For FUNCTION nodes, false if the closure is only called while its enclosing function runs
+        std::vector<bool> escapes;
+
+        [[nodiscard]]
+        inline CaptureMode getMode(ir::hir::NodeId declaration) const {
+            return modes[declaration];
+        }
+
+        [[nodiscard]]
+        inline bool isEscaping(ir::hir::NodeId function) const {
+            return escapes[function];
+        }
+    };
+
+    /**
+     * Finds which locals of a resolved @class ir::hir::HirModule are captured by closures, whether they are
+     * written after capture and whether the closures escape, so that only locals of the @enum CaptureMode BOX
+     * need heap cells.
+     *
+     * A closure does not escape if it is called right away, or if it is bound to a local that is never
+     * assigned and only called, either by the enclosing function or recursively by the closure itself.
+     *
+     * A local is written after capture if a closure assigns it, or if the enclosing function assigns it
+     * after creating a capturing closure: later in the source, in a loop that creates the closure on another
+     * iteration, or anywhere if the function has backward gotos
+     */
+    struct CaptureAnalyzer {
+        CaptureAnalysis analyze(const ir::hir::HirModule &module, const ScopeResolution &resolution);
+
+    private:
+        struct Capture {
+            ir::hir::NodeId declaration;
+            ir::hir::NodeId function;
+
+            bool operator<(const Capture &other) const;
+        };
+
+        const ir::hir::HirModule *_module{nullptr};
+        const ScopeResolution *_resolution{nullptr};
+        CaptureAnalysis _result;
+
+        // Indexed by NodeId, subtrees take ids from their starts to their roots
+        std::vector<ir::hir::NodeId> _parents;
+        std::vector<ir::hir::NodeId> _starts;
+
+        // Closures created by the functions that declare the captured locals
+        std::vector<Capture> _captures;
+
+        // Indexed by NodeId of FUNCTION nodes
+        std::vector<bool> _hasBackwardGotos;
+
+        void findEscapes();
+
+        /**
+         * @return DECLARATION the closure is bound to, NO_NODE if it is used in another way
+         */
+        [[nodiscard]]
+        ir::hir::NodeId findBinding(ir::hir::NodeId function) const;
+
+        void findBackwardGotos();
+
+        void findModes();
+
+        /**
+         * @return true if the assignment of a local in its own function may run after a closure captures it.
+         * Closures created by the assignment itself count as created before it, since values are stored last
+         */
+        [[nodiscard]]
+        bool isAfterCapture(ir::hir::NodeId assignment, ir::hir::NodeId declaration) const;
+
+    };
+
+}
+
+#endif //AUX_CAPTUREANALYZER_H
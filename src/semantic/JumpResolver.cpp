@@ -0,0 +1,202 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "JumpResolver.h"
+
+#include <algorithm>
+
+using namespace aux::semantic;
+using namespace aux::ir::hir;
+using namespace aux::exception;
+using namespace std;
+
+JumpResolution JumpResolver::resolve(const HirModule &module) {
+    _module = &module;
+    _result = JumpResolution{};
+    _result.targets.resize(module.nodes.size());
+    _errors.clear();
+
+    // Labels are not visible in nested functions, so every function is walked on its own
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        if (module[node].kind == HirKind::FUNCTION) {
+            resolveFunction(node);
+        }
+    }
+    return std::move(_result);
+}
+
+const vector<SemanticException> &JumpResolver::getErrors() const {
+    return _errors;
+}
+
+void JumpResolver::resolveFunction(NodeId function) {
+    _locals.clear();
+    _labels.clear();
+    _gotos.clear();
+    _firstGoto = 0;
+    _loops.clear();
+    for (size_t i = 0; i < (*_module)[function].split; ++i) {
+        _locals.push_back(_module->getChild(function, i));
+    }
+
+    resolveBlock(_module->getFunctionBody(function), false);
+    for (const auto &pending: _gotos) {
+        reportError(pending.jump, "no visible label '"
+                                  + string(_module->symbols.getName((*_module)[pending.jump].value)) + "' for goto");
+    }
+}
+
+void JumpResolver::resolveBlock(NodeId block, bool isRepeat) {
+    auto labelsCount = _labels.size();
+    auto firstGoto = _firstGoto;
+    _firstGoto = _gotos.size();
+    auto level = static_cast<uint32_t>(_locals.size());
+
+    // Trailing labels are at the end of the block, where its locals are no longer visible
+    auto statements = _module->getChildren(block);
+    auto trailingLabels = statements.size();
+    while (trailingLabels > 0 && (*_module)[statements[trailingLabels - 1]].kind == HirKind::LABEL) {
+        --trailingLabels;
+    }
+    for (uint32_t i = 0; i < statements.size(); ++i) {
+        resolveStatement(block, i, !isRepeat && i >= trailingLabels, level);
+    }
+
+    _labels.resize(labelsCount);
+    leaveScope(level);
+    _firstGoto = firstGoto;
+}
+
+void JumpResolver::resolveStatement(NodeId block, uint32_t index, bool isLast, uint32_t blockLevel) {
+    auto statement = _module->getChild(block, index);
+    const auto &hirNode = (*_module)[statement];
+    switch (hirNode.kind) {
+        case HirKind::LOCAL_DECL:
+            for (size_t i = 0; i < hirNode.split; ++i) {
+                _locals.push_back(_module->getChild(statement, i));
+            }
+            return;
+        case HirKind::LOCAL_FUNCTION:
+            _locals.push_back(_module->getChild(statement, 0));
+            return;
+        case HirKind::BLOCK:
+            resolveBlock(statement, false);
+            return;
+        case HirKind::IF:
+            for (auto child: _module->getChildren(statement)) {
+                if ((*_module)[child].kind == HirKind::BLOCK) {
+                    resolveBlock(child, false);
+                }
+            }
+            return;
+        case HirKind::WHILE:
+            resolveLoopBody(statement, block, index, _module->getChild(statement, 1), 0, false);
+            return;
+        case HirKind::REPEAT:
+            resolveLoopBody(statement, block, index, _module->getChild(statement, 0), 0, true);
+            return;
+        case HirKind::NUMERIC_FOR:
+            resolveLoopBody(statement, block, index, _module->getChild(statement, 4), 1, false);
+            return;
+        case HirKind::GENERIC_FOR:
+            resolveLoopBody(statement, block, index, _module->getChild(statement, hirNode.count - 1),
+                            hirNode.split, false);
+            return;
+        case HirKind::LABEL:
+            resolveLabel(block, index, isLast ? blockLevel : static_cast<uint32_t>(_locals.size()));
+            return;
+        case HirKind::GOTO:
+            resolveGoto(statement);
+            return;
+        case HirKind::BREAK:
+            resolveBreak(statement);
+            return;
+        default:
+            return;
+    }
+}
+
+void JumpResolver::resolveLoopBody(NodeId loop, NodeId block, uint32_t index, NodeId body,
+                                   size_t declarationsCount, bool isRepeat) {
+    auto level = static_cast<uint32_t>(_locals.size());
+    _loops.push_back({loop, block, index + 1, level});
+    for (size_t i = 0; i < declarationsCount; ++i) {
+        _locals.push_back(_module->getChild(loop, i));
+    }
+
+    resolveBlock(body, isRepeat);
+    leaveScope(level);
+    _loops.pop_back();
+}
+
+void JumpResolver::leaveScope(uint32_t level) {
+    for (auto i = _firstGoto; i < _gotos.size(); ++i) {
+        auto &pending = _gotos[i];
+        if (pending.level > level) {
+            pending.closed = _locals[level];
+            pending.level = level;
+        }
+    }
+    _locals.resize(level);
+}
+
+void JumpResolver::resolveLabel(NodeId block, uint32_t index, uint32_t level) {
+    auto label = _module->getChild(block, index);
+    auto symbol = (*_module)[label].value;
+    auto name = string(_module->symbols.getName(symbol));
+    auto repeated = find_if(_labels.begin(), _labels.end(), [&](const Label &visible) {
+        return visible.symbol == symbol;
+    });
+    if (repeated != _labels.end()) {
+        reportError(label, "label '" + name + "' already defined on line "
+                           + to_string((*_module)[repeated->label].range.startRow));
+        return;
+    }
+    _labels.push_back({symbol, label, block, index, level});
+
+    auto resolved = remove_if(_gotos.begin() + static_cast<ptrdiff_t>(_firstGoto), _gotos.end(),
+                              [&](const PendingGoto &pending) {
+        if ((*_module)[pending.jump].value != symbol) {
+            return false;
+        }
+        if (pending.level < level) {
+            auto local = (*_module)[_locals[pending.level]].value;
+            reportError(pending.jump, "goto '" + name + "' jumps into the scope of local '"
+                                      + string(_module->symbols.getName(local)) + "'");
+            return true;
+        }
+        _result.targets[pending.jump] = {block, index + 1, label, pending.closed};
+        return true;
+    });
+    _gotos.erase(resolved, _gotos.end());
+}
+
+void JumpResolver::resolveGoto(NodeId jump) {
+    auto symbol = (*_module)[jump].value;
+    auto label = find_if(_labels.rbegin(), _labels.rend(), [&](const Label &visible) {
+        return visible.symbol == symbol;
+    });
+    if (label == _labels.rend()) {
+        _gotos.push_back({jump, static_cast<uint32_t>(_locals.size()), NO_NODE});
+        return;
+    }
+    _result.targets[jump] = {label->block, label->index + 1, label->label, getClosed(label->level)};
+}
+
+void JumpResolver::resolveBreak(NodeId jump) {
+    if (_loops.empty()) {
+        reportError(jump, "break outside a loop");
+        return;
+    }
+    const auto &loop = _loops.back();
+    _result.targets[jump] = {loop.block, loop.index, loop.loop, getClosed(loop.level)};
+}
+
+NodeId JumpResolver::getClosed(uint32_t level) const {
+    return level < _locals.size() ? _locals[level] : NO_NODE;
+}
+
+void JumpResolver::reportError(NodeId node, const string &message) {
+    _errors.emplace_back((*_module)[node].range.getStart(), message);
+}
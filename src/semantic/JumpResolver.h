@@ -0,0 +1,137 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_JUMPRESOLVER_H
+#define AUX_JUMPRESOLVER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../intermediate_representation/Hir.h"
+#include "../exception/Exception.h"
+
+namespace aux::semantic {
+
+    /**
+     * Where a goto or a break continues: the statement at the index of the block, which is the count of its
+     * statements if the jump goes to the end of the block
+     */
+    struct JumpTarget {
+        ir::hir::NodeId block{ir::hir::NO_NODE};
+        uint32_t index{0};
+
+        // The label of a goto or the loop of a break
+        ir::hir::NodeId target{ir::hir::NO_NODE};
+
+        // Outermost DECLARATION whose scope the jump leaves, the jump closes its upvalues and to-be-closed
+        // variables and those of the locals declared after it. NO_NODE if the jump leaves no scopes of locals
+        ir::hir::NodeId closed{ir::hir::NO_NODE};
+    };
+
+    /**
+     * Results of @class JumpResolver, indexed by NodeId of GOTO and BREAK nodes, jumps with errors keep
+     * NO_NODE as their blocks
+     */
+    struct JumpResolution {
+        std::vector<JumpTarget> targets;
+
+        [[nodiscard]]
+        inline const JumpTarget &getTarget(ir::hir::NodeId jump) const {
+            return targets[jump];
+        }
+    };
+
+    /**
+     * Resolves gotos and breaks of a @class ir::hir::HirModule to the positions they jump to, in one walk over
+     * the statements of every function, following the rules of Lua 5.4:
+     * - a goto jumps to a visible label: one of its block or of an enclosing block of the same function
+     * - a forward goto may not jump into the scope of a local, unless the label is the last statement of its
+     *   block other than labels, and the block is not the body of repeat, whose locals are visible in the
+     *   condition
+     * - a label may not have the name of a visible label
+     * - a break jumps after the innermost enclosing loop
+     *
+     * As in the reference compiler, backward gotos are resolved when they are met, forward gotos wait in
+     * a list of their block, and the gotos left when a block ends move to the enclosing block
+     */
+    struct JumpResolver {
+        JumpResolution resolve(const ir::hir::HirModule &module);
+
+        /**
+         * @return errors found while resolving, e.g. gotos without visible labels or breaks outside of loops
+         */
+        [[nodiscard]]
+        const std::vector<exception::SemanticException> &getErrors() const;
+
+    private:
+        struct Label {
+            ir::hir::SymbolId symbol;
+            ir::hir::NodeId label;
+            ir::hir::NodeId block;
+            uint32_t index;
+            // Count of active locals at the label
+            uint32_t level;
+        };
+
+        struct PendingGoto {
+            ir::hir::NodeId jump;
+            uint32_t level;
+            ir::hir::NodeId closed;
+        };
+
+        struct Loop {
+            ir::hir::NodeId loop;
+            ir::hir::NodeId block;
+            uint32_t index;
+            uint32_t level;
+        };
+
+        const ir::hir::HirModule *_module{nullptr};
+        JumpResolution _result;
+        std::vector<exception::SemanticException> _errors;
+
+        // State of the function being walked
+        std::vector<ir::hir::NodeId> _locals;
+        std::vector<Label> _labels;
+        std::vector<PendingGoto> _gotos;
+        // Gotos of the current block start here, earlier gotos wait for labels of enclosing blocks
+        size_t _firstGoto{0};
+        std::vector<Loop> _loops;
+
+        void resolveFunction(ir::hir::NodeId function);
+
+        /**
+         * @param isRepeat true for the body of repeat, whose scope lasts until the end of the condition
+         */
+        void resolveBlock(ir::hir::NodeId block, bool isRepeat);
+
+        void resolveStatement(ir::hir::NodeId block, uint32_t index, bool isLast, uint32_t blockLevel);
+
+        void resolveLoopBody(ir::hir::NodeId loop, ir::hir::NodeId block, uint32_t index, ir::hir::NodeId body,
+                             size_t declarationsCount, bool isRepeat);
+
+        /**
+         * Pops locals above the level, pending gotos of the current block leave their scopes
+         */
+        void leaveScope(uint32_t level);
+
+        void resolveLabel(ir::hir::NodeId block, uint32_t index, uint32_t level);
+
+        void resolveGoto(ir::hir::NodeId jump);
+
+        void resolveBreak(ir::hir::NodeId jump);
+
+        /**
+         * @return the outermost local above the level, NO_NODE if there are none
+         */
+        [[nodiscard]]
+        ir::hir::NodeId getClosed(uint32_t level) const;
+
+        void reportError(ir::hir::NodeId node, const std::string &message);
+
+    };
+
+}
+
+#endif //AUX_JUMPRESOLVER_H
@@ -0,0 +1,257 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "ScopeResolver.h"
+
+#include <algorithm>
+
+using namespace aux::semantic;
+using namespace aux::ir::hir;
+using namespace aux::exception;
+using namespace std;
+
+ScopeResolution ScopeResolver::resolve(const HirModule &module) {
+    _module = &module;
+    _result = ScopeResolution{};
+    _result.names.resize(module.nodes.size());
+    _result.slots.assign(module.nodes.size(), NO_SLOT);
+    _result.owners.assign(module.nodes.size(), NO_NODE);
+    _result.functionIndices.assign(module.nodes.size(), UINT32_MAX);
+    _bindings.clear();
+    _innermost.assign(module.symbols.size(), NO_BINDING);
+    _functions.clear();
+    _environmentSymbol = module.symbols.find("_ENV");
+    _errors.clear();
+
+    if (module.root != NO_NODE) {
+        resolveFunction(module.root);
+    }
+    return std::move(_result);
+}
+
+const vector<SemanticException> &ScopeResolver::getErrors() const {
+    return _errors;
+}
+
+void ScopeResolver::resolveNode(NodeId node) {
+    const auto &hirNode = (*_module)[node];
+    _result.owners[node] = _functions.empty() ? NO_NODE : _result.functions[_functions.back().index].function;
+    switch (hirNode.kind) {
+        case HirKind::NAME: {
+            auto &resolution = _result.names[node];
+            if (resolveVariable(hirNode.value, node, resolution.kind, resolution.index, resolution.declaration)) {
+                return;
+            }
+            if (hirNode.value == _environmentSymbol) {
+                resolution.kind = VariableKind::UPVALUE;
+                resolution.index = findUpvalue(_functions.size() - 1, NO_BINDING, node);
+                return;
+            }
+
+            resolution.kind = VariableKind::GLOBAL;
+            resolution.index = hirNode.value;
+            if (_environmentSymbol == NO_SYMBOL || !resolveVariable(
+                    _environmentSymbol, node, resolution.environmentKind, resolution.environment, resolution.declaration
+            )) {
+                resolution.environmentKind = VariableKind::UPVALUE;
+                resolution.environment = findUpvalue(_functions.size() - 1, NO_BINDING, node);
+            }
+            return;
+        }
+        case HirKind::FUNCTION:
+            resolveFunction(node);
+            return;
+        case HirKind::BLOCK: {
+            auto mark = openScope();
+            resolveStatements(node);
+            closeScope(mark);
+            return;
+        }
+        case HirKind::LOCAL_DECL:
+            // Values are evaluated before the names are visible, e.g. local x = x
+            resolveChildren(node, hirNode.split, hirNode.count);
+            for (size_t i = 0; i < hirNode.split; ++i) {
+                declare(_module->getChild(node, i));
+            }
+            return;
+        case HirKind::LOCAL_FUNCTION:
+            // The name is visible in the function, so that it can call itself
+            declare(_module->getChild(node, 0));
+            resolveNode(_module->getChild(node, 1));
+            return;
+        case HirKind::ASSIGN:
+            resolveAssignment(node);
+            return;
+        case HirKind::REPEAT: {
+            // Locals of the body are visible in the condition
+            auto mark = openScope();
+            resolveStatements(_module->getChild(node, 0));
+            resolveNode(_module->getChild(node, 1));
+            closeScope(mark);
+            return;
+        }
+        case HirKind::NUMERIC_FOR:
+            // Start, limit and step are kept in hidden locals
+            resolveForLoop(node, 3, 1);
+            return;
+        case HirKind::GENERIC_FOR:
+            // Iterator function, state, control variable and closing value are kept in hidden locals
+            resolveForLoop(node, 4, hirNode.split);
+            return;
+        default:
+            resolveChildren(node, 0, hirNode.count);
+            return;
+    }
+}
+
+void ScopeResolver::resolveChildren(NodeId node, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        resolveNode(_module->getChild(node, i));
+    }
+}
+
+void ScopeResolver::resolveFunction(NodeId function) {
+    auto index = static_cast<uint32_t>(_result.functions.size());
+    auto parent = _functions.empty() ? NO_NODE : _result.functions[_functions.back().index].function;
+    _result.functions.push_back({function, parent, 0, {}});
+    _result.functionIndices[function] = index;
+    if (_functions.empty()) {
+        _result.functions.back().upvalues.push_back({_environmentSymbol, true, 0, NO_NODE});
+    }
+
+    _functions.push_back({index, 0});
+    auto mark = openScope();
+    const auto &hirNode = (*_module)[function];
+    for (size_t i = 0; i < hirNode.split; ++i) {
+        declare(_module->getChild(function, i));
+    }
+    auto body = _module->getFunctionBody(function);
+    _result.owners[body] = function;
+    resolveStatements(body);
+    closeScope(mark);
+    _functions.pop_back();
+}
+
+void ScopeResolver::resolveStatements(NodeId block) {
+    _result.owners[block] = _result.functions[_functions.back().index].function;
+    resolveChildren(block, 0, (*_module)[block].count);
+}
+
+void ScopeResolver::resolveAssignment(NodeId assignment) {
+    const auto &hirNode = (*_module)[assignment];
+    resolveChildren(assignment, 0, hirNode.count);
+    for (size_t i = 0; i < hirNode.split; ++i) {
+        auto target = _module->getChild(assignment, i);
+        if ((*_module)[target].kind != HirKind::NAME) {
+            continue;
+        }
+        const auto &resolution = _result.names[target];
+        // The _ENV of the chunk is an upvalue without a declaration
+        if (resolution.kind != VariableKind::GLOBAL && resolution.declaration != NO_NODE
+            && (*_module)[resolution.declaration].op != static_cast<uint8_t>(Attribute::NONE)) {
+            reportError(target, "attempt to assign to const variable '"
+                                + string(_module->symbols.getName((*_module)[target].value)) + "'");
+        }
+    }
+}
+
+void ScopeResolver::resolveForLoop(NodeId loop, uint32_t hiddenSlots, size_t declarationsCount) {
+    const auto &hirNode = (*_module)[loop];
+    resolveChildren(loop, declarationsCount, hirNode.count - 1);
+
+    auto mark = openScope();
+    reserveSlots(hiddenSlots, loop);
+    for (size_t i = 0; i < declarationsCount; ++i) {
+        declare(_module->getChild(loop, i));
+    }
+    resolveNode(_module->getChild(loop, hirNode.count - 1));
+    closeScope(mark);
+}
+
+ScopeResolver::ScopeMark ScopeResolver::openScope() const {
+    return {_bindings.size(), _functions.back().slotsCount};
+}
+
+void ScopeResolver::closeScope(const ScopeMark &mark) {
+    while (_bindings.size() > mark.bindingsCount) {
+        _innermost[_bindings.back().symbol] = _bindings.back().shadowed;
+        _bindings.pop_back();
+    }
+    _functions.back().slotsCount = mark.slotsCount;
+}
+
+void ScopeResolver::reserveSlots(uint32_t count, NodeId node) {
+    auto &active = _functions.back();
+    auto &function = _result.functions[active.index];
+    if (active.slotsCount <= MAX_LOCALS && active.slotsCount + count > MAX_LOCALS) {
+        reportError(node, "too many local variables (limit is " + to_string(MAX_LOCALS) + ")");
+    }
+    active.slotsCount += count;
+    function.slotsCount = max(function.slotsCount, active.slotsCount);
+}
+
+void ScopeResolver::declare(NodeId declaration) {
+    auto symbol = (*_module)[declaration].value;
+    auto slot = _functions.back().slotsCount;
+    reserveSlots(1, declaration);
+    _result.slots[declaration] = slot;
+    _result.owners[declaration] = _result.functions[_functions.back().index].function;
+
+    auto level = static_cast<uint32_t>(_functions.size() - 1);
+    _bindings.push_back({symbol, declaration, slot, level, _innermost[symbol]});
+    _innermost[symbol] = static_cast<uint32_t>(_bindings.size() - 1);
+}
+
+bool ScopeResolver::resolveVariable(SymbolId symbol, NodeId node, VariableKind &kind, uint32_t &index,
+                                    NodeId &declaration) {
+    auto binding = _innermost[symbol];
+    if (binding == NO_BINDING) {
+        return false;
+    }
+
+    declaration = _bindings[binding].declaration;
+    if (_bindings[binding].level == _functions.size() - 1) {
+        kind = VariableKind::LOCAL;
+        index = _bindings[binding].slot;
+    } else {
+        kind = VariableKind::UPVALUE;
+        index = findUpvalue(_functions.size() - 1, binding, node);
+    }
+    return true;
+}
+
+uint32_t ScopeResolver::findUpvalue(size_t level, uint32_t binding, NodeId node) {
+    auto declaration = binding == NO_BINDING ? NO_NODE : _bindings[binding].declaration;
+    auto functionIndex = _functions[level].index;
+    const auto &upvalues = _result.functions[functionIndex].upvalues;
+    auto existing = find_if(upvalues.begin(), upvalues.end(), [&](const Upvalue &upvalue) {
+        return upvalue.declaration == declaration;
+    });
+    if (existing != upvalues.end()) {
+        return static_cast<uint32_t>(existing - upvalues.begin());
+    }
+
+    // The _ENV of the chunk is found at level 0, so the binding is a local of an enclosing function here
+    Upvalue upvalue{_environmentSymbol, false, 0, declaration};
+    if (binding != NO_BINDING) {
+        upvalue.name = _bindings[binding].symbol;
+    }
+    if (binding != NO_BINDING && _bindings[binding].level == level - 1) {
+        upvalue.isParentLocal = true;
+        upvalue.index = _bindings[binding].slot;
+    } else {
+        upvalue.index = findUpvalue(level - 1, binding, node);
+    }
+
+    auto &function = _result.functions[functionIndex];
+    if (function.upvalues.size() == MAX_UPVALUES) {
+        reportError(node, "too many upvalues (limit is " + to_string(MAX_UPVALUES) + ")");
+    }
+    function.upvalues.push_back(upvalue);
+    return static_cast<uint32_t>(function.upvalues.size() - 1);
+}
+
+void ScopeResolver::reportError(NodeId node, const string &message) {
+    _errors.emplace_back((*_module)[node].range.getStart(), message);
+}
@@ -0,0 +1,184 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_SCOPERESOLVER_H
+#define AUX_SCOPERESOLVER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../intermediate_representation/Hir.h"
+#include "../exception/Exception.h"
+
+namespace aux::semantic {
+
+    inline constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    // Same limits as the reference implementation of Lua 5.4
+    inline constexpr uint32_t MAX_LOCALS = 200;
+    inline constexpr uint32_t MAX_UPVALUES = 255;
+
+    enum class VariableKind : uint8_t {
+        LOCAL,
+        UPVALUE,
+        GLOBAL
+    };
+
+    /**
+     * Where the value of a name is: a register slot of the function, an upvalue of the function,
+     * or a field of _ENV, which is itself a local or an upvalue
+     */
+    struct NameResolution {
+        VariableKind kind{VariableKind::GLOBAL};
+        VariableKind environmentKind{VariableKind::UPVALUE};
+
+        // Slot for locals, index in FunctionScope::upvalues for upvalues, symbol of the name for globals
+        uint32_t index{0};
+
+        // Slot or upvalue index of _ENV for globals
+        uint32_t environment{0};
+
+        // DECLARATION of the local, or of the _ENV declared by the program for globals. NO_NODE for
+        // the _ENV of the chunk
+        ir::hir::NodeId declaration{ir::hir::NO_NODE};
+    };
+
+    /**
+     * Upvalue of a function: either a local of the enclosing function or an upvalue of it
+     */
+    struct Upvalue {
+        ir::hir::SymbolId name;
+        bool isParentLocal;
+        uint32_t index;
+        ir::hir::NodeId declaration;
+    };
+
+    struct FunctionScope {
+        ir::hir::NodeId function;
+        ir::hir::NodeId parent;
+
+        // Registers taken by locals that are alive at once, including hidden state of for loops
+        uint32_t slotsCount{0};
+
+        // The chunk has _ENV as its upvalue 0, other functions get upvalues in the order of their first uses
+        std::vector<Upvalue> upvalues;
+    };
+
+    /**
+     * Results of @class ScopeResolver, vectors are indexed by NodeId of the module
+     */
+    struct ScopeResolution {
+        // For NAME nodes
+        std::vector<NameResolution> names;
+
+        // For DECLARATION nodes, NO_SLOT for other nodes
+        std::vector<uint32_t> slots;
+
+        // Function each node belongs to, the FUNCTION nodes belong to their enclosing functions
+        std::vector<ir::hir::NodeId> owners;
+
+        // Index in @var functions for FUNCTION nodes
+        std::vector<uint32_t> functionIndices;
+
+        // Functions in pre-order, the chunk is the first one
+        std::vector<FunctionScope> functions;
+
+        [[nodiscard]]
+        inline const FunctionScope &getFunction(ir::hir::NodeId function) const {
+            return functions[functionIndices[function]];
+        }
+    };
+
+    /**
+     * Resolves every name of a @class ir::hir::HirModule in one walk, following the scoping rules of Lua 5.4:
+     * locals are visible after their declarations, in nested blocks and in nested functions as upvalues,
+     * the body of repeat is visible in its condition, and other names are fields of _ENV.
+     *
+     * Visible locals are kept in one flat table of all enclosing functions. Each entry refers to the entry
+     * of the same symbol it shadows, and the innermost entry of every symbol is kept in a vector indexed by
+     * the symbol, so a name is resolved in constant time without comparing strings
+     */
+    struct ScopeResolver {
+        ScopeResolution resolve(const ir::hir::HirModule &module);
+
+        /**
+         * @return errors found while resolving, e.g. assignments to const variables
+         */
+        [[nodiscard]]
+        const std::vector<exception::SemanticException> &getErrors() const;
+
+    private:
+        static constexpr uint32_t NO_BINDING = UINT32_MAX;
+
+        struct Binding {
+            ir::hir::SymbolId symbol;
+            ir::hir::NodeId declaration;
+            uint32_t slot;
+            uint32_t level;
+            uint32_t shadowed;
+        };
+
+        struct ActiveFunction {
+            uint32_t index;
+            uint32_t slotsCount;
+        };
+
+        struct ScopeMark {
+            size_t bindingsCount;
+            uint32_t slotsCount;
+        };
+
+        const ir::hir::HirModule *_module{nullptr};
+        ScopeResolution _result;
+        std::vector<Binding> _bindings;
+        std::vector<uint32_t> _innermost;
+        std::vector<ActiveFunction> _functions;
+        ir::hir::SymbolId _environmentSymbol{ir::hir::NO_SYMBOL};
+        std::vector<exception::SemanticException> _errors;
+
+        void resolveNode(ir::hir::NodeId node);
+
+        void resolveChildren(ir::hir::NodeId node, size_t begin, size_t end);
+
+        void resolveFunction(ir::hir::NodeId function);
+
+        /**
+         * Resolves statements of the block in the current scope
+         */
+        void resolveStatements(ir::hir::NodeId block);
+
+        void resolveAssignment(ir::hir::NodeId assignment);
+
+        void resolveForLoop(ir::hir::NodeId loop, uint32_t hiddenSlots, size_t declarationsCount);
+
+        [[nodiscard]]
+        ScopeMark openScope() const;
+
+        void closeScope(const ScopeMark &mark);
+
+        void reserveSlots(uint32_t count, ir::hir::NodeId node);
+
+        void declare(ir::hir::NodeId declaration);
+
+        /**
+         * Resolves the symbol to a local or an upvalue of the current function
+         * @return false if the symbol is not declared in enclosing scopes
+         */
+        bool resolveVariable(ir::hir::SymbolId symbol, ir::hir::NodeId node, VariableKind &kind, uint32_t &index,
+                             ir::hir::NodeId &declaration);
+
+        /**
+         * @return index of the upvalue of the function at the level that refers to the binding, NO_BINDING
+         * for the _ENV of the chunk. The upvalue is added to the function and to the functions between them
+         * if it is new
+         */
+        uint32_t findUpvalue(size_t level, uint32_t binding, ir::hir::NodeId node);
+
+        void reportError(ir::hir::NodeId node, const std::string &message);
+
+    };
+
+}
+
+#endif //AUX_SCOPERESOLVER_H
@@ -0,0 +1,467 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#include "TypeInferrer.h"
+
+using namespace aux::semantic;
+using namespace aux::ir::hir;
+using namespace std;
+
+namespace {
+
+    // Only nil and false are falsy, but booleans are not told apart
+    constexpr ValueType FALSY = ValueType::NIL | ValueType::BOOLEAN;
+    constexpr ValueType TRUTHY = static_cast<ValueType>(0xff & ~static_cast<uint8_t>(ValueType::NIL));
+
+    bool isMultipleValues(HirKind kind) {
+        return kind == HirKind::CALL || kind == HirKind::METHOD_CALL || kind == HirKind::VARARG;
+    }
+
+}
+
+const char *aux::semantic::getTypeName(ValueType type) {
+    switch (type) {
+        case ValueType::NONE:
+            return "none";
+        case ValueType::NIL:
+            return "nil";
+        case ValueType::BOOLEAN:
+            return "boolean";
+        case ValueType::INTEGER:
+            return "int";
+        case ValueType::FLOAT:
+            return "float";
+        case ValueType::NUMBER:
+            return "number";
+        case ValueType::STRING:
+            return "string";
+        case ValueType::TABLE:
+            return "table";
+        case ValueType::FUNCTION:
+            return "function";
+        default:
+            return "unknown";
+    }
+}
+
+TypeInference TypeInferrer::infer(const HirModule &module, const ScopeResolution &resolution) {
+    _module = &module;
+    _resolution = &resolution;
+    _result = TypeInference{};
+    _result.types.assign(module.nodes.size(), ValueType::NONE);
+    _assigned.assign(module.nodes.size(), false);
+    _assignedInClosure.assign(module.nodes.size(), false);
+    _queued.assign(module.nodes.size(), false);
+    // Errors of invalid jumps are reported by other passes, here such gotos have no labels
+    JumpResolver jumpResolver;
+    _jumps = jumpResolver.resolve(module);
+    _hasBackwardGotos.assign(module.nodes.size(), false);
+
+    for (NodeId node = 0; node < module.nodes.size(); ++node) {
+        const auto &hirNode = module[node];
+        if (hirNode.kind == HirKind::GOTO) {
+            // Ids of leaves grow in the order of the source, so backward gotos have greater ids than their labels
+            auto label = _jumps.getTarget(node).target;
+            if (label != NO_NODE && label < node) {
+                _hasBackwardGotos[label] = true;
+            }
+        }
+        if (hirNode.kind != HirKind::ASSIGN) {
+            continue;
+        }
+        for (size_t i = 0; i < hirNode.split; ++i) {
+            auto target = module.getChild(node, i);
+            const auto &name = resolution.names[target];
+            if (module[target].kind != HirKind::NAME || name.kind == VariableKind::GLOBAL
+                || name.declaration == NO_NODE) {
+                continue;
+            }
+            _assigned[name.declaration] = true;
+            if (name.kind == VariableKind::UPVALUE) {
+                _assignedInClosure[name.declaration] = true;
+            }
+        }
+    }
+
+    if (module.root != NO_NODE) {
+        _pending.push_back(module.root);
+        _queued[module.root] = true;
+    }
+    while (!_pending.empty()) {
+        auto function = _pending.back();
+        _pending.pop_back();
+        inferFunction(function);
+    }
+    return std::move(_result);
+}
+
+void TypeInferrer::join(Environment &into, const Environment &from) {
+    if (!from.isReachable) {
+        return;
+    }
+    if (!into.isReachable) {
+        into = from;
+        return;
+    }
+    for (size_t i = 0; i < into.slots.size(); ++i) {
+        into.slots[i] = into.slots[i] | from.slots[i];
+    }
+}
+
+void TypeInferrer::inferFunction(NodeId function) {
+    const auto &hirNode = (*_module)[function];
+    _environment = {vector<ValueType>(_resolution->getFunction(function).slotsCount, ValueType::NONE), true};
+    _breaks.clear();
+    _gotos.clear();
+    for (size_t i = 0; i < hirNode.split; ++i) {
+        declare(_module->getChild(function, i), ValueType::UNKNOWN);
+    }
+    inferBlock(_module->getFunctionBody(function));
+}
+
+void TypeInferrer::inferStatement(NodeId statement) {
+    const auto &hirNode = (*_module)[statement];
+    if (!_environment.isReachable && hirNode.kind != HirKind::LABEL) {
+        return;
+    }
+    switch (hirNode.kind) {
+        case HirKind::BLOCK:
+            inferBlock(statement);
+            return;
+        case HirKind::LOCAL_DECL:
+            inferLocalDeclaration(statement);
+            return;
+        case HirKind::LOCAL_FUNCTION:
+            declare(_module->getChild(statement, 0), ValueType::FUNCTION);
+            inferExpression(_module->getChild(statement, 1));
+            return;
+        case HirKind::ASSIGN:
+            inferAssignment(statement);
+            return;
+        case HirKind::RETURN:
+            for (auto value: _module->getChildren(statement)) {
+                inferExpression(value);
+            }
+            _environment.isReachable = false;
+            return;
+        case HirKind::IF:
+            inferIf(statement);
+            return;
+        case HirKind::WHILE:
+        case HirKind::REPEAT:
+        case HirKind::NUMERIC_FOR:
+        case HirKind::GENERIC_FOR:
+            inferLoop(statement);
+            return;
+        case HirKind::BREAK:
+            // Breaks outside of loops are errors reported by other passes
+            if (!_breaks.empty()) {
+                join(_breaks.back(), _environment);
+            }
+            _environment.isReachable = false;
+            return;
+        case HirKind::GOTO:
+            // Environments of labels start unreachable, so that the first goto is joined by copying
+            if (auto label = _jumps.getTarget(statement).target; label != NO_NODE && label > statement) {
+                join(_gotos.try_emplace(label, Environment{{}, false}).first->second, _environment);
+            }
+            _environment.isReachable = false;
+            return;
+        case HirKind::LABEL:
+            inferLabel(statement);
+            return;
+        default:
+            inferExpression(statement);
+            return;
+    }
+}
+
+void TypeInferrer::inferBlock(NodeId block) {
+    for (auto statement: _module->getChildren(block)) {
+        inferStatement(statement);
+    }
+}
+
+void TypeInferrer::inferLocalDeclaration(NodeId declaration) {
+    const auto &hirNode = (*_module)[declaration];
+    auto types = inferExpressions(declaration, hirNode.split, hirNode.count, hirNode.split);
+    for (size_t i = 0; i < hirNode.split; ++i) {
+        declare(_module->getChild(declaration, i), types[i]);
+    }
+}
+
+void TypeInferrer::inferAssignment(NodeId assignment) {
+    const auto &hirNode = (*_module)[assignment];
+    for (size_t i = 0; i < hirNode.split; ++i) {
+        auto target = _module->getChild(assignment, i);
+        if ((*_module)[target].kind != HirKind::NAME) {
+            inferExpression(target);
+        }
+    }
+
+    auto types = inferExpressions(assignment, hirNode.split, hirNode.count, hirNode.split);
+    for (size_t i = 0; i < hirNode.split; ++i) {
+        auto target = _module->getChild(assignment, i);
+        if ((*_module)[target].kind != HirKind::NAME) {
+            continue;
+        }
+        _result.types[target] = _result.types[target] | types[i];
+        const auto &name = _resolution->names[target];
+        if (name.kind == VariableKind::LOCAL) {
+            _environment.slots[name.index] = types[i];
+        }
+    }
+}
+
+void TypeInferrer::inferIf(NodeId statement) {
+    const auto &hirNode = (*_module)[statement];
+    Environment result{{}, false};
+    size_t i = 0;
+    for (; i + 1 < hirNode.count; i += 2) {
+        inferExpression(_module->getChild(statement, i));
+        auto otherwise = _environment;
+        inferBlock(_module->getChild(statement, i + 1));
+        join(result, _environment);
+        _environment = std::move(otherwise);
+    }
+    if (i < hirNode.count) {
+        inferBlock(_module->getChild(statement, i));
+    }
+    join(result, _environment);
+    _environment = std::move(result);
+}
+
+void TypeInferrer::inferLoop(NodeId loop) {
+    const auto &hirNode = (*_module)[loop];
+    auto variableType = ValueType::UNKNOWN;
+    if (hirNode.kind == HirKind::NUMERIC_FOR) {
+        // The loop counts in integers if both start and step are integers, otherwise in floats
+        auto start = inferExpression(_module->getChild(loop, 1));
+        inferExpression(_module->getChild(loop, 2));
+        auto step = inferExpression(_module->getChild(loop, 3));
+        if (isSubtype(start, ValueType::INTEGER) && isSubtype(step, ValueType::INTEGER)) {
+            variableType = ValueType::INTEGER;
+        } else if (isSubtype(start, ValueType::FLOAT) || isSubtype(step, ValueType::FLOAT)) {
+            variableType = ValueType::FLOAT;
+        } else {
+            variableType = ValueType::NUMBER;
+        }
+    } else if (hirNode.kind == HirKind::GENERIC_FOR) {
+        for (size_t i = hirNode.split; i + 1 < hirNode.count; ++i) {
+            inferExpression(_module->getChild(loop, i));
+        }
+    }
+
+    _breaks.emplace_back();
+    Environment head;
+    while (true) {
+        head = _environment;
+        _breaks.back() = Environment{{}, false};
+        switch (hirNode.kind) {
+            case HirKind::WHILE:
+                inferExpression(_module->getChild(loop, 0));
+                inferBlock(_module->getChild(loop, 1));
+                break;
+            case HirKind::REPEAT:
+                inferBlock(_module->getChild(loop, 0));
+                if (_environment.isReachable) {
+                    inferExpression(_module->getChild(loop, 1));
+                }
+                break;
+            case HirKind::NUMERIC_FOR:
+                declare(_module->getChild(loop, 0), variableType);
+                inferBlock(_module->getChild(loop, 4));
+                break;
+            default:
+                for (size_t i = 0; i < hirNode.split; ++i) {
+                    declare(_module->getChild(loop, i), ValueType::UNKNOWN);
+                }
+                inferBlock(_module->getChild(loop, hirNode.count - 1));
+                break;
+        }
+
+        auto next = head;
+        join(next, _environment);
+        if (next == head) {
+            break;
+        }
+        _environment = std::move(next);
+    }
+
+    // Repeat exits after its condition, other loops exit at their heads
+    auto exit = hirNode.kind == HirKind::REPEAT ? std::move(_environment) : std::move(head);
+    join(exit, _breaks.back());
+    _breaks.pop_back();
+    _environment = std::move(exit);
+}
+
+void TypeInferrer::inferLabel(NodeId label) {
+    if (_hasBackwardGotos[label]) {
+        // Types at a backward goto depend on the types after the label
+        auto slotsCount = _resolution->getFunction(_resolution->owners[label]).slotsCount;
+        _environment = {vector<ValueType>(slotsCount, ValueType::UNKNOWN), true};
+        return;
+    }
+    auto gotos = _gotos.find(label);
+    if (gotos != _gotos.end()) {
+        join(_environment, gotos->second);
+        _gotos.erase(gotos);
+    }
+}
+
+ValueType TypeInferrer::inferExpression(NodeId expression) {
+    const auto &hirNode = (*_module)[expression];
+    auto type = ValueType::UNKNOWN;
+    switch (hirNode.kind) {
+        case HirKind::NIL:
+            type = ValueType::NIL;
+            break;
+        case HirKind::TRUE:
+        case HirKind::FALSE:
+            type = ValueType::BOOLEAN;
+            break;
+        case HirKind::INTEGER:
+            type = ValueType::INTEGER;
+            break;
+        case HirKind::FLOAT:
+            type = ValueType::FLOAT;
+            break;
+        case HirKind::STRING:
+            type = ValueType::STRING;
+            break;
+        case HirKind::NAME:
+            type = inferName(expression);
+            break;
+        case HirKind::FUNCTION:
+            if (!_queued[expression]) {
+                _queued[expression] = true;
+                _pending.push_back(expression);
+            }
+            type = ValueType::FUNCTION;
+            break;
+        case HirKind::TABLE:
+        case HirKind::TABLE_FIELD:
+            for (auto child: _module->getChildren(expression)) {
+                inferExpression(child);
+            }
+            type = hirNode.kind == HirKind::TABLE ? ValueType::TABLE : ValueType::NONE;
+            break;
+        case HirKind::BINARY: {
+            auto left = inferExpression(_module->getChild(expression, 0));
+            auto right = inferExpression(_module->getChild(expression, 1));
+            type = inferBinary(static_cast<BinaryOp>(hirNode.op), left, right);
+            break;
+        }
+        case HirKind::UNARY:
+            type = inferUnary(static_cast<UnaryOp>(hirNode.op), inferExpression(_module->getChild(expression, 0)));
+            break;
+        case HirKind::PAREN:
+            type = inferExpression(_module->getChild(expression, 0));
+            break;
+        default:
+            // Varargs, indexing and calls
+            for (auto child: _module->getChildren(expression)) {
+                inferExpression(child);
+            }
+            break;
+    }
+    _result.types[expression] = _result.types[expression] | type;
+    return type;
+}
+
+vector<ValueType> TypeInferrer::inferExpressions(NodeId node, size_t begin, size_t end, size_t count) {
+    vector<ValueType> types;
+    types.reserve(max(count, end - begin));
+    for (auto i = begin; i < end; ++i) {
+        types.push_back(inferExpression(_module->getChild(node, i)));
+    }
+
+    auto isMultiple = end > begin && isMultipleValues((*_module)[_module->getChild(node, end - 1)].kind);
+    types.resize(max(count, types.size()), isMultiple ? ValueType::UNKNOWN : ValueType::NIL);
+    return types;
+}
+
+ValueType TypeInferrer::inferName(NodeId name) {
+    const auto &resolution = _resolution->names[name];
+    switch (resolution.kind) {
+        case VariableKind::LOCAL:
+            if (_assignedInClosure[resolution.declaration]) {
+                return ValueType::UNKNOWN;
+            }
+            return _environment.slots[resolution.index];
+        case VariableKind::UPVALUE:
+            // Declarations of enclosing functions are walked, so their types are complete here
+            if (resolution.declaration == NO_NODE || _assigned[resolution.declaration]) {
+                return ValueType::UNKNOWN;
+            }
+            return _result.types[resolution.declaration];
+        default:
+            return ValueType::UNKNOWN;
+    }
+}
+
+ValueType TypeInferrer::inferBinary(BinaryOp op, ValueType left, ValueType right) {
+    auto isNumeric = isSubtype(left, ValueType::NUMBER) && isSubtype(right, ValueType::NUMBER);
+    switch (op) {
+        case BinaryOp::ADD:
+        case BinaryOp::SUB:
+        case BinaryOp::MUL:
+        case BinaryOp::MOD:
+        case BinaryOp::FLOOR_DIV:
+            // Strings are converted to numbers by metamethods, which may be replaced
+            if (!isNumeric) {
+                return ValueType::UNKNOWN;
+            }
+            if (isSubtype(left, ValueType::INTEGER) && isSubtype(right, ValueType::INTEGER)) {
+                return ValueType::INTEGER;
+            }
+            if (isSubtype(left, ValueType::FLOAT) || isSubtype(right, ValueType::FLOAT)) {
+                return ValueType::FLOAT;
+            }
+            return ValueType::NUMBER;
+        case BinaryOp::DIV:
+        case BinaryOp::POW:
+            return isNumeric ? ValueType::FLOAT : ValueType::UNKNOWN;
+        case BinaryOp::BAND:
+        case BinaryOp::BOR:
+        case BinaryOp::BXOR:
+        case BinaryOp::SHL:
+        case BinaryOp::SHR:
+            return isNumeric ? ValueType::INTEGER : ValueType::UNKNOWN;
+        case BinaryOp::CONCAT:
+            if (isSubtype(left, ValueType::STRING | ValueType::NUMBER)
+                && isSubtype(right, ValueType::STRING | ValueType::NUMBER)) {
+                return ValueType::STRING;
+            }
+            return ValueType::UNKNOWN;
+        case BinaryOp::AND:
+            // The left operand if it is falsy, the right one otherwise
+            return (left & FALSY) | ((left & TRUTHY) != ValueType::NONE ? right : ValueType::NONE);
+        case BinaryOp::OR:
+            return (left & TRUTHY) | ((left & FALSY) != ValueType::NONE ? right : ValueType::NONE);
+        default:
+            // Comparisons convert results of metamethods to booleans
+            return ValueType::BOOLEAN;
+    }
+}
+
+ValueType TypeInferrer::inferUnary(UnaryOp op, ValueType operand) {
+    switch (op) {
+        case UnaryOp::NEG:
+            return isSubtype(operand, ValueType::NUMBER) ? operand : ValueType::UNKNOWN;
+        case UnaryOp::NOT:
+            return ValueType::BOOLEAN;
+        case UnaryOp::LEN:
+            // Length of a table may be changed by __len
+            return isSubtype(operand, ValueType::STRING) ? ValueType::INTEGER : ValueType::UNKNOWN;
+        case UnaryOp::BNOT:
+            return isSubtype(operand, ValueType::NUMBER) ? ValueType::INTEGER : ValueType::UNKNOWN;
+    }
+    return ValueType::UNKNOWN;
+}
+
+void TypeInferrer::declare(NodeId declaration, ValueType type) {
+    _environment.slots[_resolution->slots[declaration]] = type;
+    _result.types[declaration] = _result.types[declaration] | type;
+}
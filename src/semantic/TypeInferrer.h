@@ -0,0 +1,153 @@
+//
+// Created by miserable on 19.10.2026.
+//
+
+#ifndef AUX_TYPEINFERRER_H
+#define AUX_TYPEINFERRER_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "JumpResolver.h"
+#include "ScopeResolver.h"
+
+namespace aux::semantic {
+
+    /**
+     * Set of Lua types a value may have, values of several types are unions of their flags
+     */
+    enum class ValueType : uint8_t {
+        NONE = 0,
+        NIL = 1 << 0,
+        BOOLEAN = 1 << 1,
+        INTEGER = 1 << 2,
+        FLOAT = 1 << 3,
+        NUMBER = INTEGER | FLOAT,
+        STRING = 1 << 4,
+        TABLE = 1 << 5,
+        FUNCTION = 1 << 6,
+        OTHER = 1 << 7, // Userdata and threads
+        UNKNOWN = 0xff
+    };
+
+    inline constexpr ValueType operator|(ValueType left, ValueType right) {
+        return static_cast<ValueType>(static_cast<uint8_t>(left) | static_cast<uint8_t>(right));
+    }
+
+    inline constexpr ValueType operator&(ValueType left, ValueType right) {
+        return static_cast<ValueType>(static_cast<uint8_t>(left) & static_cast<uint8_t>(right));
+    }
+
+    /**
+     * @return true if every value of the type is also a value of the other, e.g. Integer is Number.
+     * Types of expressions that are never evaluated are None, which is a subtype of every type
+     */
+    inline constexpr bool isSubtype(ValueType type, ValueType other) {
+        return (type & other) == type;
+    }
+
+    /**
+     * @return "int", "float", "number", "string", "table", "nil", "boolean", "function", "none" or "unknown"
+     */
+    const char *getTypeName(ValueType type);
+
+    /**
+     * Results of @class TypeInferrer, indexed by NodeId of the module
+     */
+    struct TypeInference {
+        // For expressions, DECLARATION nodes get every type the variable is declared with. Expressions that
+        // are never evaluated, e.g. after return, are None
+        std::vector<ValueType> types;
+
+        [[nodiscard]]
+        inline ValueType getType(ir::hir::NodeId node) const {
+            return types[node];
+        }
+    };
+
+    /**
+     * Infers types of expressions of a resolved @class ir::hir::HirModule, so that arithmetic over proven
+     * integers and floats can be emitted unboxed and without type checks.
+     *
+     * Types are flow-sensitive: every function is walked in order with the types of its slots, which are
+     * set by declarations and assignments and joined where branches meet. Loops are walked until the types
+     * at their heads stop growing, a label gets the types of forward gotos to it, or unknown types if it is
+     * the target of a backward goto.
+     *
+     * Nested functions are walked after their enclosing functions, when every type their upvalues are
+     * declared with is known. Locals that are assigned in nested functions, and upvalues that are assigned
+     * anywhere, are unknown since a call may change them
+     */
+    struct TypeInferrer {
+        TypeInference infer(const ir::hir::HirModule &module, const ScopeResolution &resolution);
+
+    private:
+        struct Environment {
+            std::vector<ValueType> slots;
+            bool isReachable{true};
+
+            bool operator==(const Environment &other) const = default;
+        };
+
+        const ir::hir::HirModule *_module{nullptr};
+        const ScopeResolution *_resolution{nullptr};
+        TypeInference _result;
+
+        // Indexed by NodeId of DECLARATION nodes
+        std::vector<bool> _assigned;
+        std::vector<bool> _assignedInClosure;
+
+        // Functions waiting for their enclosing functions to be walked
+        std::vector<ir::hir::NodeId> _pending;
+        std::vector<bool> _queued;
+
+        // Gotos and their labels, resolved by JumpResolver
+        JumpResolution _jumps;
+        // Indexed by NodeId of LABEL nodes
+        std::vector<bool> _hasBackwardGotos;
+
+        Environment _environment;
+        std::vector<Environment> _breaks;
+        // Types at forward gotos of the current function, keyed by NodeId of their labels
+        std::unordered_map<ir::hir::NodeId, Environment> _gotos;
+
+        static void join(Environment &into, const Environment &from);
+
+        void inferFunction(ir::hir::NodeId function);
+
+        void inferStatement(ir::hir::NodeId statement);
+
+        void inferBlock(ir::hir::NodeId block);
+
+        void inferLocalDeclaration(ir::hir::NodeId declaration);
+
+        void inferAssignment(ir::hir::NodeId assignment);
+
+        void inferIf(ir::hir::NodeId statement);
+
+        void inferLoop(ir::hir::NodeId loop);
+
+        void inferLabel(ir::hir::NodeId label);
+
+        ValueType inferExpression(ir::hir::NodeId expression);
+
+        /**
+         * @return types of the values of an expression list adjusted to the count, the last expression
+         * gives unknown values if it is a call or a vararg, missing values are nil
+         */
+        std::vector<ValueType> inferExpressions(ir::hir::NodeId node, size_t begin, size_t end, size_t count);
+
+        ValueType inferName(ir::hir::NodeId name);
+
+        ValueType inferBinary(ir::hir::BinaryOp op, ValueType left, ValueType right);
+
+        ValueType inferUnary(ir::hir::UnaryOp op, ValueType operand);
+
+        void declare(ir::hir::NodeId declaration, ValueType type);
+
+    };
+
+}
+
+#endif //AUX_TYPEINFERRER_H
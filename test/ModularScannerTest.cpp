@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "../src/scanner/ModularScanner.h"
+#include "../src/scanner/TokenCursor.h"
 #include "../src/scanner/input_stream/PreprocessedFileInputStream.h"
 #include "glog/logging.h"
 
@@ -97,4 +98,35 @@ TEST(ModularScannerTest, TestPositiveInputCases){
         }
 
     }
-}
\ No newline at end of file
+}
+
+TEST(ModularScannerTest, TokenCursorLooksAheadAndResetsToMark) {
+    PreprocessedFileInputStream fis{make_unique<istringstream>("local x = {a, b = 1}")};
+    TokenCursor cursor{make_shared<ModularScanner>(fis)};
+
+    EXPECT_EQ(cursor.peek(3)->getRawValue(), "{");
+    EXPECT_EQ(cursor.next()->getRawValue(), "local");
+
+    auto mark = cursor.mark();
+    vector<string> values;
+    while (cursor.peek()->getType() != TokenType::EOF_OR_UNDEFINED) {
+        values.push_back(cursor.next()->getRawValue());
+    }
+    EXPECT_EQ(values, (vector<string>{"x", "=", "{", "a", ",", "b", "=", "1", "}"}));
+
+    cursor.reset(mark);
+    EXPECT_EQ(cursor.getPosition(), 1);
+    EXPECT_EQ(cursor.peek(1)->getRawValue(), "=");
+    EXPECT_EQ(cursor.next()->getRawValue(), "x");
+
+    // Nested marks, the inner one is released without moving back
+    auto outer = cursor.mark();
+    cursor.next();
+    auto inner = cursor.mark();
+    EXPECT_EQ(cursor.next()->getRawValue(), "{");
+    cursor.release(inner);
+    EXPECT_EQ(cursor.getPosition(), 4);
+    cursor.reset(outer);
+    EXPECT_EQ(cursor.next()->getRawValue(), "=");
+    EXPECT_EQ(cursor.peek(100)->getType(), TokenType::EOF_OR_UNDEFINED);
+}
@@ -6,11 +6,34 @@
 
 #include <string>
 #include <list>
+#include <sstream>
+#include <fstream>
+#include <thread>
+#include <functional>
 
 #include "glog/logging.h"
 #include "../src/scanner/ModularScanner.h"
+#include "../src/scanner/TokenBufferScanner.h"
 #include "../src/scanner/input_stream/PreprocessedFileInputStream.h"
 #include "../src/parser/Parser.h"
+#include "../src/parser/IncrementalParser.h"
+#include "../src/parser/ParallelParser.h"
+#include "../src/parser/TableDrivenParser.h"
+#include "../src/parser/grammar/GrammarCompiler.h"
+#include "../src/intermediate_representation/AstArena.h"
+#include "../src/intermediate_representation/TreeVisitor.h"
+#include "../src/intermediate_representation/AstSerialization.h"
+#include "../src/intermediate_representation/AstStatistics.h"
+#include "../src/intermediate_representation/AstExporter.h"
+#include "../src/intermediate_representation/StructuralHashing.h"
+#include "../src/intermediate_representation/FrozenTree.h"
+#include "../src/intermediate_representation/HirLowering.h"
+#include "../src/semantic/ScopeResolver.h"
+#include "../src/semantic/TypeInferrer.h"
+#include "../src/semantic/CaptureAnalyzer.h"
+#include "../src/semantic/JumpResolver.h"
+#include "../src/optimizer/ConstantFolder.h"
+#include "../src/optimizer/DeadCodeEliminator.h"
 
 #include <ogdf/basic/GraphAttributes.h>
 #include <ogdf/fileformats/GraphIO.h>
@@ -24,6 +47,7 @@ using namespace ogdf;
 using namespace aux::scanner;
 using namespace aux::scanner::input_stream;
 using namespace aux::parser;
+using namespace aux::parser::grammar;
 using namespace aux::ir::tokens;
 using namespace aux::ir::ast;
 
@@ -90,27 +114,31 @@ private:
     string currRow;
 };
 
-void makeGraph(Graph &G, GraphAttributes &GA, node currNode, shared_ptr<BaseTree> tree){
-    GA.label(currNode) = tree->getPrintValue();
+void makeGraph(Graph &G, GraphAttributes &GA, node currNode, BaseTree &tree){
+    GA.label(currNode) = tree.getPrintValue();
     GA.shape(currNode) = ogdf::Shape::Ellipse;
     GA.width(currNode) = 150;
     GA.height(currNode) = 150;
 
-    if (tree->getLeft()) {
-        node left = G.newNode();
-        edge toLeft = G.newEdge(currNode, left);
-        GA.strokeColor(toLeft) = COLOR_LEMON;
-        GA.strokeWidth(toLeft) = 5.f;
-        makeGraph(G, GA, left, tree->getLeft());
-    }
+    tree.forEachChild([&, first = true](const TreeChild &child) mutable {
+        if (!child) {
+            return;
+        }
+        node childNode = G.newNode();
+        edge toChild = G.newEdge(currNode, childNode);
+        GA.strokeColor(toChild) = first ? Color COLOR_LEMON : Color COLOR_RED;
+        GA.strokeWidth(toChild) = 5.f;
+        first = false;
 
-    if (tree->getRight()) {
-        node right = G.newNode();
-        edge toRight = G.newEdge(currNode, right);
-        GA.strokeColor(toRight) = COLOR_RED;
-        GA.strokeWidth(toRight) = 5.f;
-        makeGraph(G, GA, right, tree->getRight());
-    }
+        if (child.tree) {
+            makeGraph(G, GA, childNode, *child.tree);
+        } else {
+            GA.label(childNode) = *child.token->getType() + " : " + child.token->getRawValue();
+            GA.shape(childNode) = ogdf::Shape::Ellipse;
+            GA.width(childNode) = 150;
+            GA.height(childNode) = 150;
+        }
+    });
 }
 
 void drawGraph(const shared_ptr<BaseTree> &tree){
@@ -121,7 +149,7 @@ void drawGraph(const shared_ptr<BaseTree> &tree){
                | GraphAttributes::edgeStyle
     );
 
-    makeGraph(G, GA, G.newNode(), tree);
+    makeGraph(G, GA, G.newNode(), *tree);
 
     SugiyamaLayout SL;
     SL.setRanking(new OptimalRanking);
@@ -171,4 +199,1401 @@ TEST(ParserTest, ForFile){
     drawGraph(tree);
 }
 
+TEST(ParserTest, RecoversFromSyntaxErrors) {
+    PreprocessedFileInputStream fis{"../test/resources/test_cases/SyntaxErrorsProgram.lua"};
+    std::shared_ptr<ModularScanner> scanner = make_shared<ModularScanner>(fis);
+    Parser parser{scanner};
+
+    auto tree = dynamic_pointer_cast<ListTree>(parser.parse());
+    ASSERT_TRUE(tree);
+
+    const auto &errors = parser.getErrors();
+    ASSERT_EQ(errors.size(), 3);
+    EXPECT_EQ(errors[0].getRow(), 5);
+    EXPECT_EQ(errors[1].getRow(), 8);
+    EXPECT_EQ(errors[2].getRow(), 20);
+
+    size_t errorNodes = 0;
+    bool hasFunctionDefinition = false;
+    for (const auto &statement: tree->trees) {
+        if (dynamic_pointer_cast<ErrorTree>(statement)) {
+            ++errorNodes;
+        }
+        auto binTree = dynamic_pointer_cast<BinTree>(statement);
+        hasFunctionDefinition |= binTree && binTree->type == BinTree::Type::FUNCTION_DEFINITION;
+    }
+    EXPECT_EQ(errorNodes, errors.size());
+    EXPECT_TRUE(hasFunctionDefinition);
+}
+
+TEST(ParserTest, ValidFileHasNoErrors) {
+    PreprocessedFileInputStream fis{"../test/resources/test_cases/BigLuaProgram.lua"};
+    std::shared_ptr<ModularScanner> scanner = make_shared<ModularScanner>(fis);
+    Parser parser{scanner};
+
+    parser.parse();
+    EXPECT_TRUE(parser.getErrors().empty());
+}
+
+TEST(ParserTest, ValidateReportsSameErrorsAsParse) {
+    PreprocessedFileInputStream fis{"../test/resources/test_cases/SyntaxErrorsProgram.lua"};
+    auto tokens = TokenBufferScanner::scanAll(ModularScanner{fis});
+
+    Parser treeParser{make_shared<TokenBufferScanner>(tokens)};
+    treeParser.parse();
+
+    Parser syntaxParser{make_shared<TokenBufferScanner>(tokens)};
+    const auto &errors = syntaxParser.validate();
+
+    ASSERT_EQ(errors.size(), treeParser.getErrors().size());
+    for (size_t i = 0; i < errors.size(); ++i) {
+        EXPECT_EQ(errors[i].getRow(), treeParser.getErrors()[i].getRow());
+        EXPECT_EQ(errors[i].getColumn(), treeParser.getErrors()[i].getColumn());
+    }
+}
+
+struct RecordingListener : ParseListener {
+    vector<string> functions;
+    vector<string> calls;
+    vector<string> modules;
+    vector<vector<string>> assignments;
+    vector<vector<string>> locals;
+    vector<size_t> tables;
+    int depth = 0;
+    bool stopAtFirstCall = false;
+
+    void enterFunction(const FunctionEvent &event) override {
+        functions.push_back(event.name);
+        ++depth;
+    }
+
+    void exitFunction(const Span &/* end */) override {
+        --depth;
+    }
+
+    void call(const CallEvent &event) override {
+        calls.push_back(event.callee);
+        if (event.callee == "require" && event.literalArgument) {
+            modules.push_back(*event.literalArgument);
+        }
+        if (stopAtFirstCall) {
+            stop();
+        }
+    }
+
+    void tableConstructor(const TableConstructorEvent &event) override {
+        tables.push_back(event.fieldsCount);
+    }
+
+    void assignment(const AssignmentEvent &event) override {
+        assignments.push_back(event.targets);
+    }
+
+    void localDeclaration(const LocalDeclarationEvent &event) override {
+        locals.push_back(event.names);
+    }
+};
+
+TEST(ParserTest, ListenerReceivesEventsInSourceOrder) {
+    for (bool explicitStack: {false, true}) {
+        PreprocessedFileInputStream fis{"../test/resources/test_cases/ModuleProgram.lua"};
+        Parser parser{make_shared<ModularScanner>(fis)};
+        if (explicitStack) {
+            parser.useExplicitStack();
+        }
+
+        RecordingListener listener;
+        EXPECT_TRUE(parser.parse(listener).empty());
+
+        EXPECT_EQ(listener.functions, (vector<string>{"M.load", "M:save", "helper", ""}));
+        EXPECT_EQ(listener.depth, 0);
+        EXPECT_EQ(listener.calls, (vector<string>{"require", "require", "io.open", "file:read", "json.decode"}));
+        EXPECT_EQ(listener.modules, (vector<string>{"json", "utils"}));
+        EXPECT_EQ(listener.tables, (vector<size_t>{2, 2, 0}));
+        EXPECT_EQ(listener.assignments, (vector<vector<string>>{{"M"}, {""}, {"M.count", "debug"}}));
+        EXPECT_EQ(listener.locals, (vector<vector<string>>{{"json"}, {"utils"}, {"config", "debug"}, {"file"}}));
+    }
+}
+
+TEST(ParserTest, ListenerStopsParsingEarly) {
+    PreprocessedFileInputStream fis{"../test/resources/test_cases/ModuleProgram.lua"};
+    Parser parser{make_shared<ModularScanner>(fis)};
+
+    RecordingListener listener;
+    listener.stopAtFirstCall = true;
+    parser.parse(listener);
+
+    EXPECT_EQ(listener.calls.size(), 1);
+    EXPECT_TRUE(listener.locals.empty());
+}
+
+void dumpTree(const BaseTree &tree, string &out) {
+    out += "(" + tree.getPrintValue() + " ";
+    tree.forEachChild([&](const TreeChild &child) {
+        if (child.tree) {
+            dumpTree(*child.tree, out);
+        } else if (child.token) {
+            out += "[" + child.token->getRawValue() + "] ";
+        } else {
+            out += "null ";
+        }
+    });
+    out += ") ";
+}
+
+void dumpTree(const shared_ptr<BaseTree> &tree, string &out) {
+    if (tree) {
+        dumpTree(*tree, out);
+    } else {
+        out += "null ";
+    }
+}
+
+string parseToString(const string &source, bool explicitStack) {
+    PreprocessedFileInputStream stream{make_unique<istringstream>(source)};
+    Parser parser{make_shared<ModularScanner>(stream)};
+    if (explicitStack) {
+        parser.useExplicitStack();
+    }
+
+    string result;
+    dumpTree(parser.parse(), result);
+    for (const auto &error: parser.getErrors()) {
+        result += error.what();
+    }
+    return result;
+}
+
+TEST(ParserTest, ExplicitStackBuildsSameTrees) {
+    vector<string> sources = {
+            "x = -a ^ b ^ c * 2 + f(1, {y = 2, [3] = 4, 5;}, 'a')[i].z:m 's' .. #t or not u and v <= w ~ 1 & 2 << 3 | 4",
+            "local t = {{}, {{1}, function(a) return a end}, ...} return (t)[1], 2 ^ (3)",
+            "x = a +\ny = * 3\nz = 2 ^\nw = f(a,)\nv = {[1] = }\nu = - + 1",
+            "t = {x, y = x, x == y; f(x)}"
+    };
+    for (const auto &file: {"BigLuaProgram.lua", "ModuleProgram.lua", "SyntaxErrorsProgram.lua", "Factorial.lua"}) {
+        ifstream input{string("../test/resources/test_cases/") + file};
+        stringstream content;
+        content << input.rdbuf();
+        sources.push_back(content.str());
+    }
+
+    for (const auto &source: sources) {
+        EXPECT_EQ(parseToString(source, true), parseToString(source, false)) << source;
+    }
+}
+
+TEST(ParserTest, ExplicitStackParsesDeeplyNestedSources) {
+    const size_t depth = 20000;
+    string source = "x = " + string(depth, '{') + string(depth, '}')
+                    + "\ny = " + string(depth, '(') + "1" + string(depth, ')')
+                    + "\nz = 1";
+    for (size_t i = 0; i < depth; ++i) {
+        source += " .. 1 + 1";
+    }
+
+    PreprocessedFileInputStream stream{make_unique<istringstream>(source)};
+    Parser parser{make_shared<ModularScanner>(stream)};
+    // The block of the chunk is one more level
+    parser.useExplicitStack(depth + 1);
+    auto tree = parser.parse();
+    EXPECT_TRUE(parser.getErrors().empty());
+    ASSERT_TRUE(tree);
+
+    // Released without recursion over the depth of the tree
+    tree.reset();
+}
+
+vector<aux::exception::ParsingException> parseWithExplicitStack(const string &source, size_t maxNestingDepth) {
+    PreprocessedFileInputStream stream{make_unique<istringstream>(source)};
+    Parser parser{make_shared<ModularScanner>(stream)};
+    parser.useExplicitStack(maxNestingDepth);
+    parser.parse();
+    return parser.getErrors();
+}
+
+TEST(ParserTest, ExplicitStackReportsNestingDepthLimit) {
+    string source = "x = " + string(200, '{') + string(200, '}') + "\nlocal y = 1";
+
+    PreprocessedFileInputStream stream{make_unique<istringstream>(source)};
+    Parser parser{make_shared<ModularScanner>(stream)};
+    parser.useExplicitStack(100);
+
+    auto tree = dynamic_pointer_cast<ListTree>(parser.parse());
+    ASSERT_EQ(parser.getErrors().size(), 1);
+    EXPECT_NE(string(parser.getErrors()[0].what()).find("Nesting depth of at most 100"), string::npos);
+    ASSERT_TRUE(tree);
+    EXPECT_EQ(tree->trees.size(), 2);
+
+    // Every parenthesis is one level of source nesting, the block of the chunk is another one
+    EXPECT_TRUE(parseWithExplicitStack("x = " + string(99, '(') + "1" + string(99, ')'), 100).empty());
+    auto errors = parseWithExplicitStack("x = " + string(100, '(') + "1" + string(100, ')'), 100);
+    ASSERT_FALSE(errors.empty());
+    EXPECT_NE(string(errors[0].what()).find("Nesting depth of at most 100"), string::npos);
+
+    // Function bodies are parsed recursively and stop at the limit of blocks, far below the nesting limit
+    string functions = "x = ";
+    for (size_t i = 0; i < 2000; ++i) {
+        functions += "function() return ";
+    }
+    functions += "1";
+    for (size_t i = 0; i < 2000; ++i) {
+        functions += " end";
+    }
+    errors = parseWithExplicitStack(functions, Parser::DEFAULT_MAX_NESTING_DEPTH);
+    ASSERT_FALSE(errors.empty());
+    EXPECT_NE(string(errors[0].what()).find("Block nesting depth of at most 200"), string::npos);
+}
+
+string readFile(const string &path) {
+    ifstream file{path};
+    return {istreambuf_iterator<char>(file), istreambuf_iterator<char>()};
+}
+
+struct TokenCollector : TreeVisitor<TokenCollector> {
+    vector<const Token *> &out;
+
+    void visitTree(BaseTree &tree) {
+        tree.forEachChild([&](const TreeChild &child) {
+            if (child.tree) {
+                visit(*child.tree);
+            } else if (child.token) {
+                out.push_back(child.token);
+            }
+        });
+    }
+
+    void visitToken(TokenTree &tree) {
+        out.push_back(tree.token.get());
+    }
+
+    void visitTerm(TermTree &tree) {
+        if (tree.token) {
+            out.push_back(tree.token.get());
+        }
+        visitTree(tree);
+    }
+
+    void visitBin(BinTree &tree) {
+        if (tree.op) {
+            out.push_back(tree.op.get());
+        }
+        visitTree(tree);
+    }
+
+    void visitForLoop(ForLoopTree &tree) {
+        out.push_back(tree.op.get());
+        visitTree(tree);
+    }
+};
+
+void collectTokens(BaseTree &tree, vector<const Token *> &out) {
+    TokenCollector{{}, out}.visit(tree);
+}
+
+TEST(ParserTest, NodesHaveSourceRanges) {
+    auto source = "local x = 1\n"
+                  "while x < 10 do\n"
+                  "  x = x + 1\n"
+                  "end\n"
+                  "return x\n";
+    PreprocessedFileInputStream stream{make_unique<istringstream>(source)};
+    Parser parser{make_shared<ModularScanner>(stream)};
+    auto tree = treeCast<ListTree>(parser.parse());
+    ASSERT_TRUE(tree);
+    ASSERT_EQ(tree->trees.size(), 3);
+
+    auto expectRange = [](const BaseTree &node, uint16_t startRow, uint16_t startColumn,
+                          uint16_t endRow, uint16_t endColumn) {
+        EXPECT_EQ(pair(node.range.startRow, node.range.startColumn), pair(startRow, startColumn));
+        EXPECT_EQ(pair(node.range.endRow, node.range.endColumn), pair(endRow, endColumn));
+    };
+    auto whileLoop = treeCast<BinTree>(tree->trees[1]);
+    expectRange(*tree, 1, 1, 5, 8);
+    expectRange(*tree->trees[0], 1, 1, 1, 11);
+    expectRange(*whileLoop, 2, 1, 4, 1);
+    expectRange(*whileLoop->left, 2, 7, 2, 11);
+    expectRange(*tree->trees[2], 5, 1, 5, 8);
+
+    // Every node covers the tokens of its subtree
+    function<void(BaseTree &)> check = [&](BaseTree &node) {
+        ASSERT_TRUE(node.range);
+        vector<const Token *> tokens;
+        collectTokens(node, tokens);
+        for (auto token: tokens) {
+            auto span = token->getSpan();
+            EXPECT_FALSE(SourceRange::of(*token).startsBefore(node.range)) << token->getRawValue();
+            EXPECT_LE(pair(span.row, span.column), pair(node.range.endRow, node.range.endColumn));
+        }
+        node.forEachChild([&](const TreeChild &child) {
+            if (child.tree) {
+                check(*child.tree);
+            }
+        });
+    };
+    check(*tree);
+}
+
+TEST(IncrementalParserTest, EditsProduceSameTreesAndSpansAsFullParse) {
+    IncrementalParser parser{readFile("../test/resources/test_cases/ModuleProgram.lua")};
+
+    auto replace = [&](const string &what, const string &with) {
+        parser.edit(parser.getSource().find(what), what.size(), with);
+    };
+
+    replace("= data", "= data + 1\n    print(path)");
+    EXPECT_TRUE(parser.isLastEditIncremental());
+    replace("function(y)", "function(y, z)\n        z = y * 2\n");
+    EXPECT_TRUE(parser.isLastEditIncremental());
+    replace("(file:read(\"a\"))", "(file:read(\"a\"), {[path] = 1})");
+    EXPECT_TRUE(parser.isLastEditIncremental());
+    replace("M = {}", "M = {count = 0}");
+    EXPECT_FALSE(parser.isLastEditIncremental());
+    replace("return x + y end", "return x + y");
+    EXPECT_FALSE(parser.isLastEditIncremental());
+    EXPECT_FALSE(parser.getErrors().empty());
+    replace("return x + y", "return x + y end");
+    EXPECT_FALSE(parser.isLastEditIncremental());
+    replace("local file", "local file, err");
+    EXPECT_TRUE(parser.isLastEditIncremental());
+
+    string incremental;
+    dumpTree(parser.getTree(), incremental);
+    EXPECT_EQ(incremental, parseToString(parser.getSource(), false));
+
+    PreprocessedFileInputStream stream{make_unique<istringstream>(parser.getSource())};
+    Parser fullParser{make_shared<ModularScanner>(stream)};
+    auto fullTree = fullParser.parse();
+    vector<const Token *> expected, actual;
+    collectTokens(*fullTree, expected);
+    collectTokens(*parser.getTree(), actual);
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_EQ(parser.getSpan(*actual[i]).row, expected[i]->getSpan().row) << expected[i]->getRawValue();
+        EXPECT_EQ(parser.getSpan(*actual[i]).column, expected[i]->getSpan().column) << expected[i]->getRawValue();
+    }
+
+    function<void(const BaseTree &, const BaseTree &)> compareRanges = [&](const BaseTree &full, const BaseTree &edited) {
+        auto range = parser.getRange(edited);
+        EXPECT_EQ(pair(range.startRow, range.startColumn), pair(full.range.startRow, full.range.startColumn));
+        EXPECT_EQ(pair(range.endRow, range.endColumn), pair(full.range.endRow, full.range.endColumn));
+        ASSERT_EQ(full.getChildrenCount(), edited.getChildrenCount());
+        for (size_t i = 0; i < full.getChildrenCount(); ++i) {
+            if (full.getChild(i).tree) {
+                compareRanges(*full.getChild(i).tree, *edited.getChild(i).tree);
+            }
+        }
+    };
+    compareRanges(*fullTree, *parser.getTree());
+}
+
+shared_ptr<const TokenBuffer> scanSource(const string &source) {
+    PreprocessedFileInputStream stream{make_unique<istringstream>(source)};
+    ModularScanner scanner{stream};
+    return TokenBufferScanner::scanAll(scanner);
+}
+
+TEST(ParallelParserTest, SplitsAtTopLevelFunctionDefinitions) {
+    auto tokens = scanSource("local x = function() end\n"
+                             "function f(a) if a then return {function() end} end end\n"
+                             "x = 1 local function g() end\n"
+                             "return g\n"
+                             "function h() end");
+
+    auto ranges = ParallelParser::splitTopLevelStatements(*tokens);
+    ASSERT_EQ(ranges.size(), 3);
+    EXPECT_EQ((*tokens)[ranges[1].first]->getRawValue(), "function");
+    EXPECT_EQ((*tokens)[ranges[1].first + 1]->getRawValue(), "f");
+    EXPECT_EQ((*tokens)[ranges[2].first + 2]->getRawValue(), "g");
+    EXPECT_EQ(ranges[2].second, tokens->size() - 1);
+}
+
+TEST(ParallelParserTest, BuildsSameTreesAndErrorsAsParser) {
+    string generated;
+    for (size_t i = 0; i < 200; ++i) {
+        generated += "local function f" + to_string(i) + "(a) return {a, function(b) return a .. b end} end\n"
+                     "function M.g" + to_string(i) + "(a) while a do a = a - 1 end end\n";
+    }
+
+    vector<string> sources = {
+            generated,
+            readFile("../test/resources/test_cases/BigLuaProgram.lua"),
+            readFile("../test/resources/test_cases/SyntaxErrorsProgram.lua")
+    };
+
+    for (const auto &source: sources) {
+        ParallelParser parser{scanSource(source), 4};
+        string result;
+        dumpTree(parser.parse(), result);
+        for (const auto &error: parser.getErrors()) {
+            result += error.what();
+        }
+        EXPECT_EQ(result, parseToString(source, false));
+    }
+}
+
+TEST(TableDrivenParserTest, GeneratedTablesMatchGrammar) {
+    ifstream grammar{"../resources/syntax.ebnf"};
+    GrammarCompiler compiler{grammar};
+
+    auto tables = compiler.compile();
+    EXPECT_TRUE(tables == aux::parser::generated::luaParseTables())
+                        << "Parse tables are out of date, rebuild parse_tables target";
+    EXPECT_EQ(compiler.getConflicts(), vector<string>{"prefixexp.2 on '('"});
+
+    auto indexOf = [](const vector<string> &symbols, const string &symbol) {
+        auto found = find(symbols.begin(), symbols.end(), symbol);
+        EXPECT_NE(found, symbols.end()) << symbol;
+        return static_cast<uint16_t>(found - symbols.begin());
+    };
+    auto terminal = [&](const string &symbol) {
+        return indexOf(tables.terminals, symbol);
+    };
+    // Right side of the production chosen for the two terminals, "error" if there is none
+    auto expand = [&](const string &nonTerminal, const string &first, const string &second = "$") {
+        auto production = tables.productionFor(indexOf(tables.nonTerminals, nonTerminal), terminal(first), [&]() {
+            return terminal(second);
+        });
+        if (production < 0) {
+            return string("error");
+        }
+        string result;
+        for (auto i = tables.productionOffsets[production]; i < tables.productionOffsets[production + 1]; ++i) {
+            auto symbol = tables.productionSymbols[i];
+            result += (result.empty() ? "" : " ") + (symbol < tables.terminals.size()
+                                                     ? tables.terminals[symbol]
+                                                     : tables.nonTerminals[symbol - tables.terminals.size()]);
+        }
+        return result;
+    };
+
+    EXPECT_EQ(tables.terminals[0], "$");
+    EXPECT_EQ(tables.nonTerminals[0], "chunk");
+    EXPECT_EQ(expand("stat", "WHILE"), "whileLoop");
+    EXPECT_EQ(expand("stat", "REPEAT"), "whileLoop");
+    EXPECT_EQ(expand("stat", "Identifier"), "assignmentOrFuncCall");
+    EXPECT_EQ(expand("stat", "ELSE"), "error");
+    EXPECT_EQ(expand("exp", "'...'"), "'...'");
+    EXPECT_EQ(expand("exp", "FUNCTION"), "FUNCTION funcbody");
+    // Statements of a block end at tokens of FOLLOW(block)
+    EXPECT_EQ(expand("block.1", "END"), "");
+    EXPECT_EQ(expand("block.1", "$"), "");
+    EXPECT_EQ(expand("block.1", "UNTIL"), "");
+    EXPECT_EQ(expand("block.1", "')'"), "error");
+    // Named fields are told from expressions by the second token
+    EXPECT_EQ(expand("field", "Identifier", "'='"), "Identifier '=' exp");
+    EXPECT_EQ(expand("field", "Identifier", "'=='"), "exp");
+    EXPECT_EQ(expand("field", "'['"), "'[' exp ']' '=' exp");
+}
+
+TEST(TableDrivenParserTest, AcceptsSameSourcesAsParser) {
+    vector<string> sources = {
+            readFile("../test/resources/test_cases/BigLuaProgram.lua"),
+            readFile("../test/resources/test_cases/ModuleProgram.lua"),
+            readFile("../test/resources/test_cases/SyntaxErrorsProgram.lua"),
+            "local t = {{}, {{1}, function(a) return a end}, ...; 5,} return (t)[1], 2 ^ (3)",
+            "for i, v in pairs(t) do goto continue ::continue:: end repeat x = x - 1 until x < 0",
+            "t = {x}",
+            "function f(a, ...) end",
+            "x = 1 + "
+    };
+
+    // Named fields and variadic parameters after names are decided by the second token
+    for (const auto &source: {"t = {x, y = x, x == y, [x] = y}", "function f(a, b, ...) end"}) {
+        Parser parser{make_shared<TokenBufferScanner>(scanSource(source))};
+        EXPECT_TRUE(parser.validate().empty()) << source;
+    }
+
+    for (const auto &source: sources) {
+        auto tokens = scanSource(source);
+        Parser parser{make_shared<TokenBufferScanner>(tokens)};
+        TableDrivenParser tableDrivenParser{make_shared<TokenBufferScanner>(tokens)};
+
+        const auto &errors = parser.validate();
+        const auto &tableDrivenErrors = tableDrivenParser.validate();
+        ASSERT_EQ(tableDrivenErrors.empty(), errors.empty()) << source;
+        if (!errors.empty()) {
+            EXPECT_EQ(tableDrivenErrors.size(), 1);
+            EXPECT_EQ(tableDrivenErrors[0].getRow(), errors[0].getRow()) << source;
+        }
+    }
+}
+
+TEST(AstArenaTest, StoresSameTreesAsParser) {
+    for (const auto &file: {"BigLuaProgram.lua", "ModuleProgram.lua", "SyntaxErrorsProgram.lua", "Factorial.lua"}) {
+        auto tokens = scanSource(readFile(string("../test/resources/test_cases/") + file));
+        Parser parser{make_shared<TokenBufferScanner>(tokens)};
+        auto tree = parser.parse();
+
+        AstArena arena;
+        auto root = arena.add(tree);
+        ASSERT_TRUE(root) << file;
+        EXPECT_EQ(root.getPool(), NodeRef::Pool::LIST);
+
+        string expected, actual;
+        dumpTree(tree, expected);
+        dumpTree(arena.toTree(root), actual);
+        EXPECT_EQ(actual, expected) << file;
+        EXPECT_LE(arena.tokens.size(), tokens->size()) << file;
+
+        arena.clear();
+        EXPECT_EQ(arena.getNodesCount(), 0);
+    }
+}
+
+TEST(AstSerializationTest, MappedFileRoundTripsTestCases) {
+    // Other test cases have lexical errors, on which the scanner exits
+    for (const auto &file: {"BigLuaProgram.lua", "ModuleProgram.lua", "SyntaxErrorsProgram.lua", "Factorial.lua"}) {
+        auto tokens = scanSource(readFile(string("../test/resources/test_cases/") + file));
+        Parser parser{make_shared<TokenBufferScanner>(tokens)};
+        auto tree = parser.parse();
+
+        AstArena arena;
+        auto root = arena.add(tree);
+        auto path = testing::TempDir() + file + ".ast";
+        {
+            ofstream out{path, ios::binary};
+            AstWriter::write(out, arena, root);
+        }
+
+        MappedAstFile mapped{path};
+        const auto &view = mapped.getView();
+        EXPECT_EQ(view.root, root) << file;
+        ASSERT_EQ(view.tokens.size(), arena.tokens.size()) << file;
+        for (TokenRef token = 0; token < view.tokens.size(); ++token) {
+            EXPECT_EQ(view.getRawValue(token), arena.getRawValue(token)) << file;
+        }
+
+        string expected, actual;
+        dumpTree(tree, expected);
+        dumpTree(view.toArena().toTree(view.root), actual);
+        EXPECT_EQ(actual, expected) << file;
+        remove(path.c_str());
+    }
+
+    string garbage(sizeof(AstFileHeader), 'x');
+    vector<uint64_t> buffer((garbage.size() + 7) / 8);
+    memcpy(buffer.data(), garbage.data(), garbage.size());
+    EXPECT_THROW(AstView{as_bytes(span{buffer})}, invalid_argument);
+}
+
+TEST(AstSerializationTest, RejectsCorruptedBuffers) {
+    Parser parser{make_shared<TokenBufferScanner>(scanSource("local x = f(y, 'a')\n"))};
+    AstArena arena;
+    auto root = arena.add(parser.parse());
+    ostringstream out;
+    AstWriter::write(out, arena, root);
+    auto serialized = out.str();
+
+    auto view = [&](const function<void(string &)> &corrupt) {
+        auto bytes = serialized;
+        corrupt(bytes);
+        vector<uint64_t> buffer((bytes.size() + 7) / 8);
+        memcpy(buffer.data(), bytes.data(), bytes.size());
+        return AstView{as_bytes(span{buffer}).first(bytes.size())};
+    };
+    auto header = [](string &bytes) {
+        return reinterpret_cast<AstFileHeader *>(bytes.data());
+    };
+    auto section = [&](string &bytes, AstFileHeader::Section section) {
+        return bytes.data() + header(bytes)->sections[static_cast<size_t>(section)].offset;
+    };
+
+    EXPECT_NO_THROW(view([](string &) {}));
+    EXPECT_THROW(view([](string &bytes) { bytes.resize(bytes.size() - 8); }), invalid_argument);
+    EXPECT_THROW(view([&](string &bytes) {
+        header(bytes)->root = NodeRef{NodeKind::BIN, 1000};
+    }), invalid_argument);
+    EXPECT_THROW(view([&](string &bytes) {
+        reinterpret_cast<NodeRef *>(section(bytes, AstFileHeader::Section::LIST_CHILDREN))->value = 0xEFFFFFFF;
+    }), invalid_argument);
+    EXPECT_THROW(view([&](string &bytes) {
+        reinterpret_cast<ListNode *>(section(bytes, AstFileHeader::Section::LIST_NODES))->childrenCount = 1000;
+    }), invalid_argument);
+    EXPECT_THROW(view([&](string &bytes) {
+        reinterpret_cast<TokenRecord *>(section(bytes, AstFileHeader::Section::TOKENS))->value = 1000;
+    }), invalid_argument);
+    EXPECT_THROW(view([&](string &bytes) {
+        reinterpret_cast<uint32_t *>(section(bytes, AstFileHeader::Section::STRING_OFFSETS))[1] = 1000;
+    }), invalid_argument);
+    EXPECT_THROW(view([&](string &bytes) {
+        auto args = reinterpret_cast<ArgsNode *>(section(bytes, AstFileHeader::Section::ARGS_NODES));
+        args->list = NodeRef{NodeKind::TOKEN, 0};
+    }), invalid_argument);
+}
+
+TEST(TreeVisitorTest, DispatchesByNodeKind) {
+    struct CallsCounter : TreeVisitor<CallsCounter> {
+        size_t calls{0}, nodes{0};
+
+        void visitTree(BaseTree &tree) {
+            ++nodes;
+            visitChildren(tree);
+        }
+
+        void visitFunctionCallSuffix(FunctionCallSuffixTree &tree) {
+            ++calls;
+            visitTree(tree);
+        }
+    };
+
+    auto tokens = scanSource(readFile("../test/resources/test_cases/ModuleProgram.lua"));
+    Parser parser{make_shared<TokenBufferScanner>(tokens)};
+    auto tree = parser.parse();
+
+    size_t expectedCalls = 0, expectedNodes = 0;
+    function<void(BaseTree *)> walk = [&](BaseTree *node) {
+        ++expectedNodes;
+        auto call = dynamic_cast<FunctionCallSuffixTree *>(node);
+        expectedCalls += call != nullptr;
+        EXPECT_EQ(node->as<FunctionCallSuffixTree>(), call);
+        node->forEachChild([&](const TreeChild &child) {
+            if (child.tree) {
+                walk(child.tree);
+            }
+        });
+    };
+    walk(tree.get());
+
+    CallsCounter counter;
+    counter.visit(*tree);
+    EXPECT_GT(counter.calls, 0);
+    EXPECT_EQ(counter.calls, expectedCalls);
+    EXPECT_EQ(counter.nodes, expectedNodes);
+    EXPECT_EQ(treeCast<ListTree>(tree), dynamic_pointer_cast<ListTree>(tree));
+    EXPECT_EQ(treeCast<BinTree>(tree), nullptr);
+}
+
+TEST(AstStatisticsTest, CountsNodesAndShapeOfTree) {
+    auto tokens = scanSource(readFile("../test/resources/test_cases/BigLuaProgram.lua"));
+    Parser parser{make_shared<TokenBufferScanner>(tokens)};
+    auto tree = parser.parse();
+
+    AstArena arena;
+    arena.add(tree);
+    auto statistics = AstStatistics::collect(*tree);
+    EXPECT_EQ(statistics.getNodesCount(), arena.getNodesCount());
+    EXPECT_EQ(statistics.kinds[static_cast<size_t>(NodeKind::BIN)].count, arena.binNodes.size());
+    EXPECT_EQ(statistics.kinds[static_cast<size_t>(NodeKind::LIST)].count, arena.listNodes.size());
+    EXPECT_EQ(statistics.tokens.count, arena.tokens.size());
+    EXPECT_GT(statistics.getBytes(), statistics.getNodesCount() * sizeof(BinTree));
+    EXPECT_GT(statistics.maxDepth, 5);
+    EXPECT_GT(statistics.getAverageFanOut(), 1.0);
+
+    auto single = make_shared<TokenTree>(make_shared<TokenIdentifier>(string(64, 'x'), Span{1, 1}));
+    auto singleStatistics = AstStatistics::collect(*single);
+    EXPECT_EQ(singleStatistics.getNodesCount(), 1);
+    EXPECT_EQ(singleStatistics.maxDepth, 1);
+    EXPECT_EQ(singleStatistics.getAverageFanOut(), 0.0);
+    EXPECT_GT(singleStatistics.tokens.bytes, sizeof(TokenIdentifier) + 64);
+
+    stringstream json;
+    singleStatistics.writeJson(json);
+    EXPECT_NE(json.str().find("\"Token\": {\"count\": 1, "), string::npos) << json.str();
+}
+
+TEST(AstExporterTest, WritesEveryNodeOnce) {
+    auto tokens = scanSource(readFile("../test/resources/test_cases/ModuleProgram.lua"));
+    Parser parser{make_shared<TokenBufferScanner>(tokens)};
+    auto tree = parser.parse();
+
+    size_t nodes = 0, children = 0;
+    function<void(const BaseTree &)> walk = [&](const BaseTree &node) {
+        ++nodes;
+        node.forEachChild([&](const TreeChild &child) {
+            children += static_cast<bool>(child);
+            if (child.tree) {
+                walk(*child.tree);
+            }
+        });
+    };
+    walk(*tree);
+
+    auto count = [](const string &text, const string &pattern) {
+        size_t result = 0;
+        for (auto position = text.find(pattern); position != string::npos; position = text.find(pattern, position + 1)) {
+            ++result;
+        }
+        return result;
+    };
+
+    stringstream json;
+    AstExporter::writeJson(json, *tree);
+    EXPECT_EQ(count(json.str(), "{\"kind\":"), nodes);
+    EXPECT_EQ(count(json.str(), "{\"kind\":") + count(json.str(), "{\"token\":"), children + 1);
+    EXPECT_EQ(count(json.str(), "["), count(json.str(), "]"));
+    EXPECT_EQ(json.str().rfind("{\"kind\":\"List\",\"label\":\"Statements List\"", 0), 0);
+
+    stringstream dot;
+    AstExporter::write(dot, *tree, *AstExporter::parseFormat("ast-dot"));
+    EXPECT_EQ(count(dot.str(), " [label="), children + 1);
+    EXPECT_EQ(count(dot.str(), " -> "), children);
+    EXPECT_FALSE(AstExporter::parseFormat("ast-xml"));
+
+    stringstream escaped;
+    AstExporter::writeJson(escaped, TokenTree{make_shared<TokenStringLiteral>("caf\xC3\xA9\x01\"", Span{1, 1})});
+    EXPECT_NE(escaped.str().find("caf\\u00c3\\u00a9\\u0001\\\""), string::npos) << escaped.str();
+}
+
+TEST(HashConsingTest, SharesImmutableSubtreesOnly) {
+    auto source = "a = 60 * 60 * 24\n"
+                  "b = 60 * 60 * 24\n"
+                  "c = 60 * 60 * 25\n"
+                  "t = {1, x = \"s\", {}}\n"
+                  "u = {1, x = \"s\", {}}\n"
+                  "v = x + 1\n"
+                  "w = x + 1\n";
+    Parser parser{make_shared<TokenBufferScanner>(scanSource(source))};
+    auto tree = treeCast<ListTree>(parser.parse());
+    ASSERT_TRUE(tree);
+    ASSERT_EQ(tree->trees.size(), 7);
+    auto value = [&](size_t statement) {
+        auto assignment = treeCast<BinTree>(tree->trees[statement]);
+        return treeCast<ListTree>(assignment->right)->trees[0];
+    };
+
+    StructuralHasher hasher;
+    hasher.hash(*tree);
+    EXPECT_EQ(hasher.hash(*value(0)), hasher.hash(*value(1)));
+    EXPECT_NE(hasher.hash(*value(0)), hasher.hash(*value(2)));
+    EXPECT_EQ(hasher.hash(*value(3)), hasher.hash(*value(4)));
+    EXPECT_TRUE(StructuralHasher::equal(value(3).get(), value(4).get()));
+    EXPECT_FALSE(StructuralHasher::equal(value(0).get(), value(2).get()));
+
+    string expected;
+    dumpTree(tree, expected);
+    auto nodesBefore = AstStatistics::collect(*tree).getNodesCount();
+
+    // Subtrees at other places keep their own ranges
+    HashConser rangesConser;
+    EXPECT_EQ(rangesConser.share(tree), tree);
+    EXPECT_EQ(rangesConser.getSharedCount(), 0);
+    EXPECT_NE(value(0), value(1));
+    EXPECT_EQ(value(1)->range.startRow, 2);
+
+    HashConser conser{true};
+    EXPECT_EQ(conser.share(tree), tree);
+    EXPECT_EQ(value(0), value(1));
+    EXPECT_EQ(value(1)->range.startRow, 1);
+    EXPECT_NE(value(0), value(2));
+    EXPECT_EQ(value(3), value(4));
+    // Names may refer to different variables
+    EXPECT_NE(value(5), value(6));
+    EXPECT_GT(conser.getSharedCount(), 0);
+    EXPECT_LT(AstStatistics::collect(*tree).getNodesCount(), nodesBefore);
+
+    string actual;
+    dumpTree(tree, actual);
+    EXPECT_EQ(actual, expected);
+
+    // Trees without ranges are shared by default
+    AstArena arena;
+    auto copy = treeCast<ListTree>(arena.toTree(arena.add(tree)));
+    HashConser copyConser;
+    copyConser.share(copy);
+    EXPECT_EQ(copyConser.getSharedCount(), conser.getSharedCount());
+}
+
+TEST(FrozenTreeTest, ConcurrentPassesReadSameTree) {
+    struct NodesCounter : ConstTreeVisitor<NodesCounter> {
+        size_t nodes{0};
+
+        void visitTree(const BaseTree &tree) {
+            ++nodes;
+            visitChildren(tree);
+        }
+    };
+
+    auto tokens = scanSource(readFile("../test/resources/test_cases/BigLuaProgram.lua"));
+    Parser parser{make_shared<TokenBufferScanner>(tokens)};
+    auto tree = parser.parse();
+    EXPECT_THROW(FrozenTree{tree}, invalid_argument);
+    FrozenTree frozen{std::move(tree)};
+    const auto &root = frozen.getRoot();
+    EXPECT_EQ(frozen.getNodes().front(), &root);
+
+    string expectedDump, expectedJson;
+    dumpTree(root, expectedDump);
+    stringstream json;
+    AstExporter::writeJson(json, root);
+    expectedJson = json.str();
+    auto expectedNodes = AstStatistics::collect(root).getNodesCount();
+    auto expectedHash = StructuralHasher{}.hash(root);
+
+    // Run under ThreadSanitizer (AUX_THREAD_SANITIZER) to check that reads do not race
+    constexpr size_t threadsCount = 4;
+    vector<string> dumps(threadsCount), jsons(threadsCount);
+    vector<size_t> nodes(threadsCount), visited(threadsCount);
+    vector<uint64_t> hashes(threadsCount);
+    vector<thread> threads;
+    for (size_t i = 0; i < threadsCount; ++i) {
+        threads.emplace_back([&, i] {
+            dumpTree(root, dumps[i]);
+            stringstream out;
+            AstExporter::writeJson(out, root);
+            jsons[i] = out.str();
+            nodes[i] = AstStatistics::collect(root).getNodesCount();
+            hashes[i] = StructuralHasher{}.hash(root);
+            NodesCounter counter;
+            counter.visit(root);
+            visited[i] = counter.nodes;
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < threadsCount; ++i) {
+        EXPECT_EQ(dumps[i], expectedDump);
+        EXPECT_EQ(jsons[i], expectedJson);
+        EXPECT_EQ(nodes[i], expectedNodes);
+        EXPECT_EQ(hashes[i], expectedHash);
+        EXPECT_EQ(visited[i], frozen.getNodes().size());
+    }
+}
+
+TEST(HirLoweringTest, LowersStatementsToDistinctKinds) {
+    auto source = "local x <const>, y = 1, 2.5\n"
+                  "a.b, c[1] = f(x), ...\n"
+                  "function t.m:go(p, ...) return self, p end\n"
+                  "local function g() end\n"
+                  "for i = 1, 10 do break end\n"
+                  "for k, v in pairs(t) do obj:send \"s\" end\n"
+                  "if x then goto done elseif y then do end else ; end\n"
+                  "while (f()) and (x) do end\n"
+                  "repeat until not x\n"
+                  "::done::\n"
+                  "return {1, n = -x, [y] = \"z\" .. 'w', }, 2 ^ 3\n";
+    Parser parser{make_shared<TokenBufferScanner>(scanSource(source))};
+    auto tree = parser.parse();
+    ASSERT_TRUE(parser.getErrors().empty());
+
+    aux::ir::hir::HirLowering lowering;
+    auto module = lowering.lower(*tree);
+    EXPECT_TRUE(lowering.getErrors().empty());
+
+    stringstream out;
+    module.write(out);
+    EXPECT_EQ(out.str(), "(Function ... (Block"
+                         " (LocalDecl (Declaration x<const>) (Declaration y) (Integer 1) (Float 2.5))"
+                         " (Assign (Index (Name a) (String \"b\")) (Index (Name c) (Integer 1))"
+                         " = (Call (Name f) (Name x)) (Vararg))"
+                         " (Assign (Index (Index (Name t) (String \"m\")) (String \"go\")) ="
+                         " (Function ... (Declaration self) (Declaration p) (Block (Return (Name self) (Name p)))))"
+                         " (LocalFunction (Declaration g) (Function (Block)))"
+                         " (NumericFor (Declaration i) (Integer 1) (Integer 10) (Integer 1) (Block (Break)))"
+                         " (GenericFor (Declaration k) (Declaration v) (Call (Name pairs) (Name t))"
+                         " (Block (MethodCall :send (Name obj) (String \"s\"))))"
+                         " (If (Name x) (Block (Goto done)) (Name y) (Block (Block)) (Block))"
+                         " (While (Binary and (Paren (Call (Name f))) (Name x)) (Block))"
+                         " (Repeat (Block) (Unary not (Name x)))"
+                         " (Label done)"
+                         " (Return (Table (Integer 1) (TableField (String \"n\") (Unary - (Name x)))"
+                         " (TableField (Name y) (Binary .. (String \"z\") (String \"w\"))))"
+                         " (Binary ^ (Integer 2) (Integer 3)))))");
+
+    // Children are stored before their parents, next to each other
+    for (aux::ir::hir::NodeId node = 0; node < module.nodes.size(); ++node) {
+        for (auto child: module.getChildren(node)) {
+            EXPECT_LT(child, node);
+        }
+    }
+    EXPECT_EQ(module.root, module.nodes.size() - 1);
+    EXPECT_EQ(module.symbols.intern("x"), module[module.getChild(module.getChild(module.getFunctionBody(module.root), 0), 0)].value);
+
+    Parser invalidParser{make_shared<TokenBufferScanner>(scanSource("local a <static>, b <close>, c <close> = 1"))};
+    lowering.lower(*invalidParser.parse());
+    ASSERT_EQ(lowering.getErrors().size(), 2);
+    EXPECT_NE(string(lowering.getErrors()[0].what()).find("unknown attribute 'static'"), string::npos);
+
+    // Numbers of targets are stored in 16 bits
+    string targets = "x";
+    for (size_t i = 0; i < 65535; ++i) {
+        targets += ", x";
+    }
+    Parser tooManyTargetsParser{make_shared<TokenBufferScanner>(scanSource(targets + " = 1"))};
+    auto tooManyTargets = lowering.lower(*tooManyTargetsParser.parse());
+    ASSERT_EQ(lowering.getErrors().size(), 1);
+    EXPECT_NE(string(lowering.getErrors()[0].what()).find("too many assignment targets (limit is 65535)"),
+              string::npos);
+    auto assignment = tooManyTargets[tooManyTargets.getChild(tooManyTargets.getFunctionBody(tooManyTargets.root), 0)];
+    EXPECT_EQ(assignment.kind, aux::ir::hir::HirKind::ASSIGN);
+    EXPECT_EQ(assignment.split, 65535);
+}
+
+aux::ir::hir::HirModule lowerSource(const string &source) {
+    Parser parser{make_shared<TokenBufferScanner>(scanSource(source))};
+    auto tree = parser.parse();
+    EXPECT_TRUE(parser.getErrors().empty());
+    aux::ir::hir::HirLowering lowering;
+    return lowering.lower(*tree);
+}
+
+/**
+ * @return nodes of the kind in the order they are stored, with the given symbol if it is not empty
+ */
+vector<aux::ir::hir::NodeId> findNodes(
+        const aux::ir::hir::HirModule &module, aux::ir::hir::HirKind kind, const string &symbol = ""
+) {
+    vector<aux::ir::hir::NodeId> result;
+    for (aux::ir::hir::NodeId node = 0; node < module.nodes.size(); ++node) {
+        if (module[node].kind == kind && (symbol.empty() || module.symbols.getName(module[node].value) == symbol)) {
+            result.push_back(node);
+        }
+    }
+    return result;
+}
+
+TEST(ScopeResolverTest, ResolvesLocalsUpvaluesAndGlobals) {
+    using namespace aux::ir::hir;
+    using namespace aux::semantic;
+    auto module = lowerSource("local a, b = 1, a\n"
+                              "local function f(x)\n"
+                              "    local y = x + a\n"
+                              "    return function() return y + a + b + print end\n"
+                              "end\n"
+                              "for i = 1, 2 do local z = i end\n"
+                              "repeat local r = 1 until r\n"
+                              "local c <const> = 1\n"
+                              "c = 2\n");
+    ScopeResolver resolver;
+    auto resolution = resolver.resolve(module);
+    auto name = [&](const string &symbol, size_t index = 0) {
+        return resolution.names[findNodes(module, HirKind::NAME, symbol)[index]];
+    };
+
+    // Values are evaluated before the names are declared
+    EXPECT_EQ(name("a").kind, VariableKind::GLOBAL);
+    EXPECT_EQ(name("x").kind, VariableKind::LOCAL);
+    EXPECT_EQ(name("x").index, 0);
+    EXPECT_EQ(name("a", 1).kind, VariableKind::UPVALUE);
+    EXPECT_EQ(name("y").kind, VariableKind::UPVALUE);
+    EXPECT_EQ(name("y").declaration, findNodes(module, HirKind::DECLARATION, "y")[0]);
+
+    auto functions = findNodes(module, HirKind::FUNCTION);
+    ASSERT_EQ(functions.size(), 3);
+    const auto &inner = resolution.getFunction(functions[0]);
+    const auto &outer = resolution.getFunction(functions[1]);
+    EXPECT_EQ(inner.parent, functions[1]);
+    EXPECT_EQ(resolution.owners[findNodes(module, HirKind::NAME, "y")[0]], functions[0]);
+    // y, a, b and _ENV, which is the upvalue 0 of the chunk
+    ASSERT_EQ(inner.upvalues.size(), 4);
+    EXPECT_TRUE(inner.upvalues[0].isParentLocal);
+    EXPECT_EQ(inner.upvalues[0].index, 1);
+    EXPECT_FALSE(inner.upvalues[1].isParentLocal);
+    EXPECT_EQ(inner.upvalues[1].index, 0);
+    ASSERT_EQ(outer.upvalues.size(), 3);
+    EXPECT_EQ(outer.upvalues[2].declaration, NO_NODE);
+    EXPECT_EQ(name("print").kind, VariableKind::GLOBAL);
+    EXPECT_EQ(name("print").environmentKind, VariableKind::UPVALUE);
+    EXPECT_EQ(name("print").environment, 3);
+
+    // a, b and f, then the hidden state of the loop
+    EXPECT_EQ(resolution.slots[findNodes(module, HirKind::DECLARATION, "i")[0]], 6);
+    EXPECT_EQ(resolution.slots[findNodes(module, HirKind::DECLARATION, "z")[0]], 7);
+    EXPECT_EQ(name("r").kind, VariableKind::LOCAL);
+    EXPECT_EQ(name("r").index, 3);
+    EXPECT_EQ(resolution.slots[findNodes(module, HirKind::DECLARATION, "c")[0]], 3);
+    EXPECT_EQ(resolution.functions[0].slotsCount, 8);
+
+    ASSERT_EQ(resolver.getErrors().size(), 1);
+    EXPECT_NE(string(resolver.getErrors()[0].what()).find("attempt to assign to const variable 'c'"), string::npos);
+
+    // The _ENV of the chunk is an upvalue without a declaration
+    auto environment = lowerSource("_ENV = {}\n");
+    resolution = resolver.resolve(environment);
+    EXPECT_EQ(resolution.names[findNodes(environment, HirKind::NAME, "_ENV")[0]].kind, VariableKind::UPVALUE);
+    EXPECT_TRUE(resolver.getErrors().empty());
+}
+
+TEST(ConstantFolderTest, FoldsWithLuaSemanticsAndPropagatesLocals) {
+    using namespace aux::ir::hir;
+    using namespace aux::optimizer;
+    auto module = lowerSource("_ENV = {}\n"
+                              "local n = 7\n"
+                              "local m = 1\n"
+                              "m = 2\n"
+                              "return n // -2, -n % 3, 7.5 // 2, 1 / 2, 9223372036854775807 + 1, 10 .. 2.0 .. n,\n"
+                              "    not true, 3 & 2.0, 1 << 64, 1 == 1.0, 'a' < 'b', true and f(), nil or x,\n"
+                              "    1 // 0, '1' + 1, m, #'abc', 2^2, function() return n * 2 end\n");
+    aux::semantic::ScopeResolver resolver;
+    auto resolution = resolver.resolve(module);
+    ConstantFolder folder;
+    auto folded = folder.fold(module, &resolution);
+
+    ostringstream out;
+    folded.write(out, findNodes(folded, HirKind::RETURN)[1]);
+    EXPECT_EQ(out.str(), "(Return (Integer -4) (Integer 2) (Float 3.0) (Float 0.5) (Integer -9223372036854775808) "
+                         "(String \"102.07\") (False) (Integer 2) (Integer 0) (True) (True) "
+                         "(Binary and (True) (Call (Name f))) (Name x) (Binary // (Integer 1) (Integer 0)) "
+                         "(Binary + (String \"1\") (Integer 1)) (Name m) (Integer 3) (Float 4.0) "
+                         "(Function (Block (Return (Integer 14)))))");
+    EXPECT_EQ(folder.getPropagatedCount(), 4);
+    EXPECT_EQ(folder.getFoldedCount(), 18);
+
+    // Operands of folded expressions are not copied
+    EXPECT_LT(folded.nodes.size(), module.nodes.size());
+    EXPECT_EQ(folded.children.size() + 1, folded.nodes.size());
+}
+
+TEST(TypeInferrerTest, InfersNumericTypesAlongControlFlow) {
+    using namespace aux::ir::hir;
+    using namespace aux::semantic;
+    auto module = lowerSource("local s = 0\n"
+                              "for i = 1, 10 do s = s + i * 2 end\n"
+                              "local f = 0.5\n"
+                              "local c\n"
+                              "if g then c = s else c = f end\n"
+                              "local v = 1\n"
+                              "v = 'a' .. v\n"
+                              "while g do\n"
+                              "    local w = v\n"
+                              "    v = #w\n"
+                              "end\n"
+                              "local function h() return f, s end\n"
+                              "return s // 2, s / 2, f % 2, 7.5 & 3, c, s + f, g + 1, v, g and 1 or 2.0\n");
+    ScopeResolver resolver;
+    auto resolution = resolver.resolve(module);
+    TypeInferrer inferrer;
+    auto inference = inferrer.infer(module, resolution);
+    auto type = [&](NodeId node) {
+        return string(getTypeName(inference.getType(node)));
+    };
+
+    EXPECT_EQ(type(findNodes(module, HirKind::NAME, "i")[0]), "int");
+    EXPECT_EQ(type(findNodes(module, HirKind::NAME, "s")[0]), "int");
+
+    // v is a string before the loop and an integer after its first iteration
+    EXPECT_EQ(type(findNodes(module, HirKind::NAME, "w")[0]), "unknown");
+    EXPECT_EQ(type(findNodes(module, HirKind::DECLARATION, "w")[0]), "unknown");
+
+    // f is never assigned, s is assigned, so a call may change it
+    EXPECT_EQ(type(findNodes(module, HirKind::NAME, "f")[1]), "float");
+    EXPECT_EQ(type(findNodes(module, HirKind::NAME, "s")[3]), "unknown");
+
+    auto values = module.getChildren(findNodes(module, HirKind::RETURN)[1]);
+    vector<string> types;
+    for (auto value: values) {
+        types.push_back(type(value));
+    }
+    EXPECT_EQ(types, (vector<string>{"int", "float", "float", "int", "number", "float", "unknown", "unknown",
+                                     "unknown"}));
+}
+
+TEST(TypeInferrerTest, JoinsTypesAtLabels) {
+    using namespace aux::ir::hir;
+    using namespace aux::semantic;
+    // Type of the last reference to the name
+    auto infer = [](const string &source, const string &name) {
+        auto module = lowerSource(source);
+        ScopeResolver resolver;
+        auto resolution = resolver.resolve(module);
+        TypeInferrer inferrer;
+        auto inference = inferrer.infer(module, resolution);
+        return string(getTypeName(inference.getType(findNodes(module, HirKind::NAME, name).back())));
+    };
+
+    EXPECT_EQ(infer("local x = 1 ::l:: local y = x + 1 return y\n", "y"), "int");
+    EXPECT_EQ(infer("local x = 1\n"
+                    "if g then goto done end\n"
+                    "x = 's'\n"
+                    "::done::\n"
+                    "return x\n", "x"), "unknown");
+    EXPECT_EQ(infer("local x = 1\n"
+                    "if g then goto done end\n"
+                    "x = 2\n"
+                    "::done::\n"
+                    "return x\n", "x"), "int");
+    // Only reached by the goto
+    EXPECT_EQ(infer("local x = 1\n"
+                    "do goto done end\n"
+                    "x = 's'\n"
+                    "::done::\n"
+                    "return x\n", "x"), "int");
+    // Types after a backward goto are not known at the label
+    EXPECT_EQ(infer("local x = 1\n"
+                    "::top::\n"
+                    "local y = x\n"
+                    "x = 's'\n"
+                    "if g then goto top end\n"
+                    "return y\n", "y"), "unknown");
+    // Labels of the same name in sibling blocks are different labels
+    EXPECT_EQ(infer("local x = 1\n"
+                    "for i = 1, 2 do\n"
+                    "    if g then goto continue end\n"
+                    "    x = 's'\n"
+                    "    ::continue::\n"
+                    "end\n"
+                    "local y = 1\n"
+                    "for i = 1, 2 do\n"
+                    "    if g then goto continue end\n"
+                    "    y = 2\n"
+                    "    ::continue::\n"
+                    "    local z = y\n"
+                    "end\n", "y"), "int");
+}
+
+TEST(CaptureAnalyzerTest, FindsCaptureModesAndEscapingClosures) {
+    using namespace aux::ir::hir;
+    using namespace aux::semantic;
+    auto module = lowerSource("local a, b, c, d, u = 1, 2, 3, 4, 5\n"
+                              "local function helper(x) return x + a end\n"
+                              "helper(1)\n"
+                              "local e = function() b = b + 1 end\n"
+                              "local function counter() return c end\n"
+                              "counter()\n"
+                              "c = 5\n"
+                              "for i = 1, 3 do\n"
+                              "    d = i\n"
+                              "    print(function() return d end)\n"
+                              "    local h = function() return i end\n"
+                              "    h()\n"
+                              "end\n"
+                              "return e\n");
+    ScopeResolver resolver;
+    auto resolution = resolver.resolve(module);
+    CaptureAnalyzer analyzer;
+    auto analysis = analyzer.analyze(module, resolution);
+    auto mode = [&](const string &name) {
+        return analysis.getMode(findNodes(module, HirKind::DECLARATION, name)[0]);
+    };
+
+    EXPECT_EQ(mode("a"), CaptureMode::VALUE);
+    EXPECT_EQ(mode("b"), CaptureMode::BOX);
+    EXPECT_EQ(mode("c"), CaptureMode::FRAME);
+    // Assigned before the closure is created, but on every iteration of the loop
+    EXPECT_EQ(mode("d"), CaptureMode::BOX);
+    EXPECT_EQ(mode("i"), CaptureMode::VALUE);
+    EXPECT_EQ(mode("u"), CaptureMode::NONE);
+    EXPECT_EQ(mode("x"), CaptureMode::NONE);
+
+    auto functions = findNodes(module, HirKind::FUNCTION);
+    ASSERT_EQ(functions.size(), 6);
+    vector<bool> escapes;
+    for (auto function: functions) {
+        escapes.push_back(analysis.isEscaping(function));
+    }
+    // helper, e, counter, the closure passed to print, h and the chunk
+    EXPECT_EQ(escapes, (vector<bool>{false, true, false, true, false, true}));
+}
+
+TEST(CaptureAnalyzerTest, BoxesLocalsAssignedByTheStatementCreatingTheClosure) {
+    using namespace aux::ir::hir;
+    using namespace aux::semantic;
+    auto module = lowerSource("local f\n"
+                              "f = function(n) if n > 0 then return f(n - 1) end end\n"
+                              "local a, b\n"
+                              "a, b = 1, function() return a end\n"
+                              "local c = 1\n"
+                              "local g = function() return c end\n"
+                              "return f, b, g\n");
+    ScopeResolver resolver;
+    auto resolution = resolver.resolve(module);
+    CaptureAnalyzer analyzer;
+    auto analysis = analyzer.analyze(module, resolution);
+    auto mode = [&](const string &name) {
+        return analysis.getMode(findNodes(module, HirKind::DECLARATION, name)[0]);
+    };
+
+    // Values are stored after the closures of the same assignment are created
+    EXPECT_EQ(mode("f"), CaptureMode::BOX);
+    EXPECT_EQ(mode("a"), CaptureMode::BOX);
+    EXPECT_EQ(mode("c"), CaptureMode::VALUE);
+}
+
+TEST(CaptureAnalyzerTest, TailCallsLetClosuresEscape) {
+    using namespace aux::ir::hir;
+    using namespace aux::semantic;
+    // c is assigned after g captures it, so it is boxed if g escapes and stays in the frame otherwise
+    auto mode = [](const string &returnStatement) {
+        auto module = lowerSource("local c = 1\n"
+                                  "local function g() return c end\n"
+                                  "c = 2\n" + returnStatement);
+        ScopeResolver resolver;
+        auto resolution = resolver.resolve(module);
+        CaptureAnalyzer analyzer;
+        auto analysis = analyzer.analyze(module, resolution);
+        EXPECT_EQ(analysis.isEscaping(findNodes(module, HirKind::FUNCTION)[0]),
+                  analysis.getMode(findNodes(module, HirKind::DECLARATION, "c")[0]) == CaptureMode::BOX);
+        return analysis.getMode(findNodes(module, HirKind::DECLARATION, "c")[0]);
+    };
+
+    // A tail call runs the closure after the frame of the caller is gone
+    EXPECT_EQ(mode("return g()\n"), CaptureMode::BOX);
+    EXPECT_EQ(mode("return (g())\n"), CaptureMode::FRAME);
+    EXPECT_EQ(mode("return g(), 1\n"), CaptureMode::FRAME);
+    EXPECT_EQ(mode("g()\n"), CaptureMode::FRAME);
+}
+
+TEST(JumpResolverTest, ResolvesJumpsAndReportsInvalidOnes) {
+    using namespace aux::ir::hir;
+    using namespace aux::semantic;
+    auto module = lowerSource("for i = 1, 3 do\n"
+                              "    for j = 1, 3 do\n"
+                              "        if j == 2 then goto continue end\n"
+                              "        local x = j\n"
+                              "        if x then break end\n"
+                              "        ::continue::\n"
+                              "    end\n"
+                              "end\n"
+                              "do\n"
+                              "    goto skip\n"
+                              "    local y = 1\n"
+                              "    ::skip::\n"
+                              "    print(y)\n"
+                              "end\n"
+                              "goto missing\n"
+                              "::top::\n"
+                              "::top::\n"
+                              "repeat local z = 1 goto done local w = 2 ::done:: until z\n"
+                              "break\n"
+                              "goto top\n");
+    JumpResolver resolver;
+    auto resolution = resolver.resolve(module);
+
+    auto loops = findNodes(module, HirKind::NUMERIC_FOR);
+    auto innerBody = module.getFunctionBody(loops[0]);
+    const auto &toContinue = resolution.getTarget(findNodes(module, HirKind::GOTO, "continue")[0]);
+    EXPECT_EQ(toContinue.block, innerBody);
+    EXPECT_EQ(toContinue.index, module[innerBody].count);
+    EXPECT_EQ(toContinue.closed, NO_NODE);
+
+    const auto &toBreak = resolution.getTarget(findNodes(module, HirKind::BREAK)[0]);
+    EXPECT_EQ(toBreak.target, loops[0]);
+    EXPECT_EQ(toBreak.block, module.getFunctionBody(loops[1]));
+    EXPECT_EQ(toBreak.index, 1);
+    EXPECT_EQ(toBreak.closed, findNodes(module, HirKind::DECLARATION, "j")[0]);
+
+    const auto &toTop = resolution.getTarget(findNodes(module, HirKind::GOTO, "top")[0]);
+    EXPECT_EQ(toTop.target, findNodes(module, HirKind::LABEL, "top")[0]);
+    EXPECT_EQ(toTop.index, 4);
+
+    vector<string> errors;
+    for (const auto &error: resolver.getErrors()) {
+        errors.emplace_back(error.what());
+    }
+    EXPECT_EQ(errors, (vector<string>{
+            "Semantic error at (10:5) goto 'skip' jumps into the scope of local 'y'",
+            "Semantic error at (17:1) label 'top' already defined on line 16",
+            "Semantic error at (18:20) goto 'done' jumps into the scope of local 'w'",
+            "Semantic error at (19:1) break outside a loop",
+            "Semantic error at (15:1) no visible label 'missing' for goto"
+    }));
+}
+
+TEST(DeadCodeEliminatorTest, RemovesUnreachableCodeAndUnreadLocals) {
+    using namespace aux::ir::hir;
+    using namespace aux::optimizer;
+    auto module = lowerSource("local DEBUG = false\n"
+                              "local unused = compute()\n"
+                              "local a = 1\n"
+                              "local b = a\n"
+                              "if DEBUG then print('debug') elseif true then print('always') else print('never') end\n"
+                              "while false do print(1) end\n"
+                              "local function helper() end\n"
+                              "local t = {}\n"
+                              "t.x = 1\n"
+                              "do end\n"
+                              "for i = 1, 2 do\n"
+                              "    break\n"
+                              "    print(i)\n"
+                              "end\n"
+                              "local c <close> = nil\n"
+                              "goto done\n"
+                              "print('skipped')\n"
+                              "::done::\n"
+                              "return t\n");
+    aux::semantic::ScopeResolver resolver;
+    auto resolution = resolver.resolve(module);
+    ConstantFolder folder;
+    auto folded = folder.fold(module, &resolution);
+    DeadCodeEliminator eliminator;
+    auto eliminated = eliminator.eliminate(folded);
+
+    ostringstream out;
+    eliminated.write(out);
+    EXPECT_EQ(out.str(), "(Function ... (Block (Call (Name compute)) (Block (Call (Name print) (String \"always\"))) "
+                         "(LocalDecl (Declaration t) (Table)) (Assign (Index (Name t) (String \"x\")) = (Integer 1)) "
+                         "(NumericFor (Declaration i) (Integer 1) (Integer 2) (Integer 1) (Block (Break))) "
+                         "(LocalDecl (Declaration c<close>) (Nil)) (Goto done) (Label done) (Return (Name t))))");
+    EXPECT_EQ(eliminator.getRemovedNodesCount(), folded.nodes.size() - eliminated.nodes.size());
+    EXPECT_EQ(eliminator.getRemovedBytes(), eliminator.getRemovedNodesCount() * sizeof(HirNode)
+                                            + (folded.children.size() - eliminated.children.size()) * sizeof(NodeId)
+                                            + (folded.integers.size() - eliminated.integers.size()) * sizeof(int64_t));
+    EXPECT_GT(eliminator.getRemovedNodesCount(), 30);
+}
+
+TEST(DeadCodeEliminatorTest, KeepsDeclarationsOfKeptStores) {
+    using namespace aux::ir::hir;
+    using namespace aux::optimizer;
+    auto eliminate = [](const string &source) {
+        DeadCodeEliminator eliminator;
+        ostringstream out;
+        eliminator.eliminate(lowerSource(source)).write(out);
+        return out.str();
+    };
+
+    // Removing the declarations would rebind the assignments to a global and to the outer local
+    EXPECT_EQ(eliminate("local a\n"
+                        "a, b = 1, 2\n"),
+              "(Function ... (Block (LocalDecl (Declaration a)) (Assign (Name a) (Name b) = (Integer 1) (Integer 2))))");
+    EXPECT_EQ(eliminate("local x = 1\n"
+                        "do local x = 2; x = f() + 1 end\n"),
+              "(Function ... (Block (Block (LocalDecl (Declaration x) (Integer 2)) "
+              "(Assign (Name x) = (Binary + (Call (Name f)) (Integer 1))))))");
+    // Indexing a table with nil fails
+    EXPECT_EQ(eliminate("local y = 1\n"
+                        "y = f()\n"
+                        "local t = {[1] = y}\n"
+                        "local k\n"
+                        "local u = {[k] = 1}\n"
+                        "local v = {[nil] = 1}\n"),
+              "(Function ... (Block (Call (Name f)) (LocalDecl (Declaration k)) "
+              "(LocalDecl (Declaration u) (Table (TableField (Name k) (Integer 1)))) "
+              "(LocalDecl (Declaration v) (Table (TableField (Nil) (Integer 1))))))");
+}
+
+TEST(ParseTraceTest, RingBufferKeepsLatestEvents) {
+    ParseTrace trace{4};
+    trace.enter("Untraced", 0);
+    trace.exit("Untraced", 0);
+    EXPECT_TRUE(trace.getEvents().empty());
+
+    trace.enable();
+    trace.enter("Block", 0);
+    trace.enter("Statement", 1);
+    trace.exit("Statement", 2);
+    trace.enter("Statement", 2);
+    trace.exit("Statement", 3);
+    trace.exit("Block", 3);
+
+    auto events = trace.getEvents();
+    ASSERT_EQ(events.size(), 4);
+    EXPECT_EQ(trace.getRecordedCount(), 6);
+    EXPECT_EQ(events[0].type, ParseTraceEvent::Type::EXIT);
+    EXPECT_EQ(events[0].tokenIndex, 2);
+    EXPECT_EQ(events[3].type, ParseTraceEvent::Type::EXIT);
+    EXPECT_EQ(string(events[3].production), "Block");
+    EXPECT_EQ(events[3].depth, 0);
+    EXPECT_EQ(events[2].depth, 1);
+}
+
+#ifdef AUX_PARSER_TRACE
+TEST(ParseTraceTest, ParserRecordsBalancedProductions) {
+    PreprocessedFileInputStream fis{"../test/resources/test_cases/Factorial.lua"};
+    std::shared_ptr<ModularScanner> scanner = make_shared<ModularScanner>(fis);
+    Parser parser{scanner};
+    parser.getTrace().enable();
+
+    parser.parse();
+
+    auto events = parser.getTrace().getEvents();
+    ASSERT_FALSE(events.empty());
+    EXPECT_EQ(events.back().type, ParseTraceEvent::Type::EXIT);
+    EXPECT_EQ(string(events.back().production), "Block");
+    EXPECT_EQ(events.back().depth, 0);
+}
+#endif
+
 #pragma clang diagnostic pop
\ No newline at end of file
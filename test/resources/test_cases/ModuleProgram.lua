@@ -0,0 +1,21 @@
+local json = require("json")
+local utils = require "utils"
+local config, debug = {name = "module", version = {1, 2}}, false
+
+M = {}
+
+function M.load(path)
+    local file = io.open(path)
+    return json.decode(file:read("a"))
+end
+
+function M:save(path, data)
+    self.cache[path] = data
+    M.count, debug = M.count + 1, true
+end
+
+local function helper(x)
+    return function(y) return x + y end
+end
+
+return M
@@ -0,0 +1,20 @@
+---
+--- Parser is expected to report every syntax error below in a single run
+---
+
+local = 5
+print("swallowed by recovery")
+
+if a > then
+    b = 1
+end
+
+function fact (n)
+    if n == 0 then
+        return 1
+    end
+    return n * fact(n-1)
+end
+
+c = (1 + 2
+print(fact(5))